@@ -0,0 +1,318 @@
+#ifndef arena_hxx
+#define arena_hxx
+
+/**
+ *  \file
+ *  \brief  Huge page backed memory arena
+ *
+ *  \date   2026/10/19
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <mutex>
+#include <new>
+#include <cstdint>
+#include <cstddef>
+
+extern "C" {
+#include <sys/mman.h>
+}
+
+
+namespace container {
+
+namespace impl {
+
+/** Arena chunk size (2 MiB huge page) */
+static const size_t arena_chunk_size = (size_t)2 << 20;
+
+/** Arena slot alignment */
+static const size_t arena_align = 16;
+
+/** Arena statistics */
+struct arena_stats {
+    size_t chunks;   /**< Chunks allocated                          */
+    size_t hugetlb;  /**< Chunks backed by (reserved) huge pages    */
+    size_t thp;      /**< Chunks advised to use transparent huge p. */
+};  // end of struct arena_stats
+
+/** Arena chunks (process-wide, never released) */
+class arena_chunks {
+    private:
+
+    /** Statistics */
+    static arena_stats & stats_ref() {
+        static arena_stats stats = { 0, 0, 0 };
+        return stats;
+    }
+
+    /** Statistics lock */
+    static std::mutex & mutex() {
+        static std::mutex * mutex = new std::mutex();
+        return *mutex;
+    }
+
+    public:
+
+    /**
+     *  \brief  Allocate chunk
+     *
+     *  Reserved huge pages (\c MAP_HUGETLB) are tried, first.
+     *  If there are none, chunk aligned to huge page size is mapped
+     *  and advised to be backed by transparent huge page.
+     *  Should that fail, the chunk is still usable (with normal pages).
+     *
+     *  \return Chunk of \ref arena_chunk_size bytes
+     */
+    static void * allocate() {
+        const size_t size = arena_chunk_size;
+        void * chunk = MAP_FAILED;
+        bool hugetlb = false, thp = false;
+
+#ifdef MAP_HUGETLB
+        chunk = ::mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        hugetlb = MAP_FAILED != chunk;
+#endif
+
+        if (MAP_FAILED == chunk) {
+            // Over-allocate so that the chunk may be aligned
+            void * area = ::mmap(NULL, size << 1, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (MAP_FAILED == area) throw std::bad_alloc();
+
+            const uintptr_t begin   = (uintptr_t)area;
+            const uintptr_t aligned = (begin + size - 1) & ~(size - 1);
+
+            if (aligned > begin) ::munmap(area, aligned - begin);
+            ::munmap((void *)(aligned + size), begin + size - aligned);
+
+            chunk = (void *)aligned;
+
+#ifdef MADV_HUGEPAGE
+            thp = 0 == ::madvise(chunk, size, MADV_HUGEPAGE);
+#endif
+        }
+
+        std::lock_guard<std::mutex> lock(mutex());
+        arena_stats & stats = stats_ref();
+        ++stats.chunks;
+        stats.hugetlb += hugetlb;
+        stats.thp     += thp;
+
+        return chunk;
+    }
+
+    /** Statistics getter */
+    static arena_stats stats() {
+        std::lock_guard<std::mutex> lock(mutex());
+        return stats_ref();
+    }
+
+};  // end of class arena_chunks
+
+/**
+ *  \brief  Arena pool of fixed size slots
+ *
+ *  Slots are carved from arena chunks sequentially (so that objects
+ *  allocated together lie together); released slots are kept on a free
+ *  list for reuse.
+ *
+ *  \tparam  Size  Slot size
+ */
+template <size_t Size>
+class arena_pool {
+    private:
+
+    /** Slot size (aligned) */
+    static const size_t slot_size =
+        ((Size < sizeof(void *) ? sizeof(void *) : Size)
+        + arena_align - 1) & ~(arena_align - 1);
+
+    /** Pool state */
+    struct state {
+        std::mutex mutex;  /**< Pool lock                  */
+        void *     free;   /**< Free list                  */
+        char *     next;   /**< Next unused slot in chunk  */
+        char *     end;    /**< Chunk end                  */
+
+        state(): free(NULL), next(NULL), end(NULL) {}
+    };  // end of struct state
+
+    /** Pool state (never destroyed; nodes may outlive static objects) */
+    static state & get() {
+        static state * pool = new state();
+        return *pool;
+    }
+
+    public:
+
+    /** Allocate slot */
+    static void * allocate() {
+        state & pool = get();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        if (NULL != pool.free) {
+            void * slot = pool.free;
+            pool.free = *(void **)slot;
+            return slot;
+        }
+
+        if (pool.next + slot_size > pool.end) {
+            pool.next = (char *)arena_chunks::allocate();
+            pool.end  = pool.next + arena_chunk_size;
+        }
+
+        void * slot = pool.next;
+        pool.next += slot_size;
+        return slot;
+    }
+
+    /** Release slot */
+    static void deallocate(void * slot) {
+        state & pool = get();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        *(void **)slot = pool.free;
+        pool.free = slot;
+    }
+
+};  // end of template class arena_pool
+
+/** Node allocated by global \c new (arena disabled) */
+template <class Node, bool Enabled>
+class arena_allocated {};
+
+/** Node allocated from arena */
+template <class Node>
+class arena_allocated<Node, true> {
+    public:
+
+    /** Allocation */
+    static void * operator new(size_t size) {
+        static_assert(alignof(Node) <= arena_align,
+            "libtrie++: node alignment exceeds arena alignment");
+
+        return sizeof(Node) == size
+            ? arena_pool<sizeof(Node)>::allocate()
+            : ::operator new(size);
+    }
+
+    /** Deallocation */
+    static void operator delete(void * ptr, size_t size) {
+        if (sizeof(Node) == size)
+            arena_pool<sizeof(Node)>::deallocate(ptr);
+        else
+            ::operator delete(ptr);
+    }
+
+};  // end of template class arena_allocated
+
+/**
+ *  \brief  Arena allocator (for item lists)
+ *
+ *  Single objects are allocated from arena pools; arrays by global \c new.
+ *
+ *  \tparam  T  Value type
+ */
+template <typename T>
+class arena_allocator {
+    public:
+
+    typedef T value_type;  /**< Value type */
+
+    /** Constructor */
+    arena_allocator() {}
+
+    /** Rebinding constructor */
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &) {}
+
+    /**
+     *  \brief  Allocate objects
+     *
+     *  \param  n  Number of objects
+     *
+     *  \return Uninitialised memory
+     */
+    T * allocate(size_t n) {
+        static_assert(alignof(T) <= arena_align,
+            "libtrie++: type alignment exceeds arena alignment");
+
+        return 1 == n
+            ? (T *)arena_pool<sizeof(T)>::allocate()
+            : (T *)::operator new(n * sizeof(T));
+    }
+
+    /**
+     *  \brief  Release objects
+     *
+     *  \param  ptr  Memory
+     *  \param  n    Number of objects
+     */
+    void deallocate(T * ptr, size_t n) {
+        if (1 == n)
+            arena_pool<sizeof(T)>::deallocate(ptr);
+        else
+            ::operator delete(ptr);
+    }
+
+};  // end of template class arena_allocator
+
+/** Arena allocators are interchangeable */
+template <typename T, typename U>
+inline bool operator == (const arena_allocator<T> &, const arena_allocator<U> &)
+{
+    return true;
+}
+
+/** Arena allocators are interchangeable */
+template <typename T, typename U>
+inline bool operator != (const arena_allocator<T> &, const arena_allocator<U> &)
+{
+    return false;
+}
+
+}  // end of namespace impl
+
+/** Huge page arena statistics */
+typedef impl::arena_stats arena_stats_t;
+
+/** Huge page arena statistics getter (see \c TRIE_HUGE_PAGES) */
+inline arena_stats_t arena_stats() { return impl::arena_chunks::stats(); }
+
+}  // end of namespace container
+
+#endif  // end of #ifndef arena_hxx
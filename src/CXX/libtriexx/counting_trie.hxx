@@ -0,0 +1,474 @@
+#ifndef counting_trie_hxx
+#define counting_trie_hxx
+
+/**
+ *  \file
+ *  \brief  Concurrent counting TRIE (atomic per-key counters)
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "trie.hxx"
+
+#include <vector>
+#include <tuple>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdexcept>
+#include <system_error>
+#include <cstdint>
+
+extern "C" {
+#include <pthread.h>
+}
+
+
+namespace container {
+
+namespace impl {
+
+/**
+ *  \brief  Read/write lock
+ *
+ *  C++11 has no shared mutex; this one wraps POSIX rwlock.
+ *  Exclusive locking satisfies \c Lockable (so \c std::lock_guard
+ *  may be used); see \ref shared_lock_guard for shared locking.
+ */
+class rw_lock {
+    private:
+
+    pthread_rwlock_t m_impl;  /**< POSIX rwlock */
+
+    /** Throw system error (if any) */
+    static void check(int rc, const char * what) {
+        if (0 != rc)
+            throw std::system_error(rc, std::system_category(),
+                std::string("libtrie++: ") + what);
+    }
+
+    public:
+
+    /** Constructor */
+    rw_lock() { check(::pthread_rwlock_init(&m_impl, NULL), "rwlock init"); }
+
+    rw_lock(const rw_lock & orig) = delete;
+    rw_lock & operator = (const rw_lock & orig) = delete;
+
+    /** Lock exclusively */
+    void lock() { check(::pthread_rwlock_wrlock(&m_impl), "rwlock wrlock"); }
+
+    /** Unlock (exclusive) */
+    void unlock() { ::pthread_rwlock_unlock(&m_impl); }
+
+    /** Lock shared */
+    void lock_shared() {
+        check(::pthread_rwlock_rdlock(&m_impl), "rwlock rdlock");
+    }
+
+    /** Unlock (shared) */
+    void unlock_shared() { ::pthread_rwlock_unlock(&m_impl); }
+
+    /** Destructor */
+    ~rw_lock() { ::pthread_rwlock_destroy(&m_impl); }
+
+};  // end of class rw_lock
+
+/** Shared lock guard (see \ref rw_lock) */
+class shared_lock_guard {
+    private:
+
+    rw_lock & m_lock;  /**< Lock */
+
+    public:
+
+    /** Constructor (locks shared) */
+    explicit shared_lock_guard(rw_lock & lock): m_lock(lock) {
+        m_lock.lock_shared();
+    }
+
+    shared_lock_guard(const shared_lock_guard & orig) = delete;
+    shared_lock_guard & operator = (const shared_lock_guard & orig) = delete;
+
+    /** Destructor (unlocks) */
+    ~shared_lock_guard() { m_lock.unlock_shared(); }
+
+};  // end of class shared_lock_guard
+
+}  // end of namespace impl
+
+/**
+ *  \brief  Concurrent counting TRIE
+ *
+ *  Maps keys to atomic counters; \ref increment may be called
+ *  from any number of threads.
+ *  Keys are distributed to shards by key hash; each shard is a TRIE
+ *  guarded by a read/write lock.
+ *  Existing keys are looked up under the shared lock, so increments
+ *  of known keys don't exclude each other; the exclusive lock is only
+ *  taken to insert a key on first sight.
+ *  The counter itself is incremented by relaxed atomic add outside
+ *  of the critical section (counters never move in memory and are
+ *  never removed).
+ *
+ *  Threads hammering the same (hot) keys should rather count locally
+ *  using \ref local, which aggregates deltas in a private TRIE and
+ *  flushes them to the shared one periodically.
+ *
+ *  Since the shards are keyed by hash, iteration by \ref for_each
+ *  isn't in key order; ordered counts are obtained by \ref collect.
+ *
+ *  \tparam  Counter  Counter type (integer)
+ */
+template <typename Counter = uint64_t>
+class counting_trie {
+    public:
+
+    typedef Counter counter_t;  /**< Counter type */
+
+    /** Ordered counts (see \ref collect) */
+    typedef string_trie<counter_t> counts_t;
+
+    private:
+
+    /** Counted key */
+    struct item_t {
+        std::string                    key;    /**< Key     */
+        mutable std::atomic<counter_t> count;  /**< Counter */
+
+        item_t(const std::string & _key, counter_t _count):
+            key(_key), count(_count)
+        {}
+
+        item_t(const item_t & orig):
+            key(orig.key),
+            count(orig.count.load(std::memory_order_relaxed))
+        {}
+
+    };  // end of struct item_t
+
+    /** Item key getter */
+    struct key_fn {
+        inline const unsigned char * operator () (const item_t & item) const {
+            return (const unsigned char *)item.key.data();
+        }
+    };  // end of struct key_fn
+
+    /** Item key length getter */
+    struct key_len_fn {
+        inline size_t operator () (const item_t & item) const {
+            return item.key.size();
+        }
+    };  // end of struct key_len_fn
+
+    /**
+     *  \brief  Shard TRIE
+     *
+     *  No features (sampling, access counts) are enabled, so lookups
+     *  don't modify the TRIE and may run concurrently.
+     */
+    typedef container::trie<item_t, key_fn, key_len_fn> trie_t;
+
+    /** Shard */
+    struct shard {
+        mutable impl::rw_lock lock;  /**< Shard lock */
+        trie_t                trie;  /**< Counters   */
+    };  // end of struct shard
+
+    std::vector<std::unique_ptr<shard> > m_shards;  /**< Shards */
+
+    /**
+     *  \brief  Key shard
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *
+     *  \return Shard
+     */
+    inline shard & shard_of(const unsigned char * key, size_t len) const {
+        const uint64_t hash = impl::hash_mix(0, impl::hash64(key, len));
+        return *m_shards[hash & (m_shards.size() - 1)];
+    }
+
+    public:
+
+    /**
+     *  \brief  Constructor
+     *
+     *  \param  shards  Number of shards (rounded up to power of 2)
+     */
+    counting_trie(size_t shards = 64) {
+        if (0 == shards)
+            throw std::logic_error(
+                "libtrie++: counting TRIE needs at least 1 shard");
+
+        size_t n = 1;
+        while (n < shards) n <<= 1;
+
+        m_shards.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            m_shards.push_back(std::unique_ptr<shard>(new shard()));
+    }
+
+    /** Number of shards */
+    inline size_t shards() const { return m_shards.size(); }
+
+    /**
+     *  \brief  Increment key counter (insert key on first sight)
+     *
+     *  \param  key    Key
+     *  \param  len    Key length
+     *  \param  delta  Increment
+     *
+     *  \return Counter value after the increment
+     */
+    counter_t increment(
+        const unsigned char * key,
+        size_t                len,
+        counter_t             delta = 1)
+    {
+        shard & sh = shard_of(key, len);
+        const item_t * item = NULL;
+
+        // Known key (concurrent lookups don't modify the TRIE)
+        {
+            impl::shared_lock_guard lock(sh.lock);
+
+            auto iter = sh.trie.find(key, len);
+            if (sh.trie.end() != iter) item = &std::get<2>(*iter);
+        }
+
+        // First sight (unless another thread inserted the key meanwhile)
+        if (NULL == item) {
+            std::lock_guard<impl::rw_lock> lock(sh.lock);
+
+            auto iter = sh.trie.find(key, len);
+            item = sh.trie.end() != iter
+                ? &std::get<2>(*iter)
+                : &std::get<2>(*sh.trie.insert(
+                    item_t(std::string((const char *)key, len), 0)));
+        }
+
+        return delta + item->count.fetch_add(
+            delta, std::memory_order_relaxed);
+    }
+
+    /**
+     *  \brief  Increment key counter (insert key on first sight)
+     *
+     *  \param  key    Key
+     *  \param  delta  Increment
+     *
+     *  \return Counter value after the increment
+     */
+    inline counter_t increment(const std::string & key, counter_t delta = 1) {
+        return increment(
+            (const unsigned char *)key.data(), key.size(), delta);
+    }
+
+    /**
+     *  \brief  Get key count
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *
+     *  \return Key count (0 if not present)
+     */
+    counter_t count(const unsigned char * key, size_t len) const {
+        const shard & sh = shard_of(key, len);
+        impl::shared_lock_guard lock(sh.lock);
+
+        auto iter = sh.trie.find(key, len);
+        return sh.trie.end() == iter
+            ? 0 : std::get<2>(*iter).count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     *  \brief  Get key count
+     *
+     *  \param  key  Key
+     *
+     *  \return Key count (0 if not present)
+     */
+    inline counter_t count(const std::string & key) const {
+        return count((const unsigned char *)key.data(), key.size());
+    }
+
+    /** Number of keys */
+    size_t size() const {
+        size_t size = 0;
+        for (const auto & sh: m_shards) {
+            impl::shared_lock_guard lock(sh->lock);
+            size += sh->trie.size();
+        }
+
+        return size;
+    }
+
+    /**
+     *  \brief  Visit all counters (shard by shard, not in key order)
+     *
+     *  Shards are locked one at a time while visited.
+     *
+     *  \param  fn  Visitor (called with key and count)
+     */
+    template <class Fn>
+    void for_each(Fn fn) const {
+        for (const auto & sh: m_shards) {
+            impl::shared_lock_guard lock(sh->lock);
+
+            for (auto iter = sh->trie.begin(); sh->trie.end() != iter; ++iter)
+            {
+                const item_t & item = std::get<2>(*iter);
+                fn(item.key, item.count.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    /**
+     *  \brief  Collect counts (in key order)
+     *
+     *  Counts are added to those already in \c counts.
+     *
+     *  \param  counts  Key counts
+     */
+    void collect(counts_t & counts) const {
+        for_each([&counts](const std::string & key, counter_t count) {
+            auto iter = counts.insert(std::make_tuple(key, (counter_t)0));
+            std::get<1>(std::get<2>(*iter)) += count;
+        });
+    }
+
+    /**
+     *  \brief  Thread-local counting
+     *
+     *  Deltas are aggregated in a private TRIE and added to the shared
+     *  counting TRIE every \c flush_period increments and on destruction.
+     *  Hot keys are therefore only locked once per flush.
+     *  Shared counts lag behind by up to \c flush_period increments
+     *  per local counter.
+     *  Flushing may throw (e.g. \c std::bad_alloc); the destructor
+     *  swallows such errors (losing the deltas), so call \ref flush
+     *  explicitly before destruction to have them reported.
+     */
+    class local {
+        private:
+
+        counting_trie &           m_counts;        /**< Shared counters  */
+        std::unique_ptr<counts_t> m_deltas;        /**< Local deltas     */
+        size_t                    m_flush_period;  /**< Flush period     */
+        size_t                    m_flush_cnt;     /**< Incr. to flush   */
+
+        public:
+
+        /**
+         *  \brief  Constructor
+         *
+         *  \param  counts        Shared counting TRIE
+         *  \param  flush_period  Flush period (increments)
+         */
+        local(counting_trie & counts, size_t flush_period = 1024):
+            m_counts(counts),
+            m_deltas(new counts_t()),
+            m_flush_period(flush_period),
+            m_flush_cnt(flush_period)
+        {}
+
+        /**
+         *  \brief  Increment key counter
+         *
+         *  \param  key    Key
+         *  \param  len    Key length
+         *  \param  delta  Increment
+         */
+        void increment(
+            const unsigned char * key,
+            size_t                len,
+            counter_t             delta = 1)
+        {
+            typename counts_t::iterator iter = m_deltas->find(key, len);
+            if (m_deltas->end() == iter)
+                m_deltas->insert(std::make_tuple(
+                    std::string((const char *)key, len), delta));
+            else
+                std::get<1>(std::get<2>(*iter)) += delta;
+
+            if (0 == m_flush_cnt || 0 == --m_flush_cnt) flush();
+        }
+
+        /**
+         *  \brief  Increment key counter
+         *
+         *  \param  key    Key
+         *  \param  delta  Increment
+         */
+        inline void increment(const std::string & key, counter_t delta = 1) {
+            increment((const unsigned char *)key.data(), key.size(), delta);
+        }
+
+        /**
+         *  \brief  Add local deltas to the shared counters
+         *
+         *  Flushed deltas are zeroed one by one, so that flush may be
+         *  retried after failure without counting anything twice.
+         */
+        void flush() {
+            for (auto iter = m_deltas->begin(); m_deltas->end() != iter; ++iter)
+            {
+                auto & item = std::get<2>(*iter);
+                if (0 == std::get<1>(item)) continue;
+
+                m_counts.increment(std::get<0>(item), std::get<1>(item));
+                std::get<1>(item) = 0;
+            }
+
+            m_deltas.reset(new counts_t());
+            m_flush_cnt = m_flush_period;
+        }
+
+        /** Destructor (flushes the deltas, never throws) */
+        ~local() {
+            try { flush(); } catch (...) {}
+        }
+
+    };  // end of class local
+
+};  // end of template class counting_trie
+
+}  // end of namespace container
+
+#endif  // end of #ifndef counting_trie_hxx
@@ -0,0 +1,1108 @@
+#ifndef disk_trie_hxx
+#define disk_trie_hxx
+
+/**
+ *  \file
+ *  \brief  Paged on-disk TRIE with asynchronous (io_uring) lookups
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+}
+
+
+namespace container {
+
+namespace impl {
+
+/** Disk TRIE file header (at offset 0, padded to page) */
+struct disk_header {
+    char     magic[8];   /**< \c libtrie and version digit */
+    uint32_t page_size;  /**< Page size                    */
+    uint32_t root_size;  /**< Root node record size        */
+    uint64_t root_off;   /**< Root node record offset      */
+    uint64_t top_end;    /**< End of top (BFS) region      */
+    uint64_t items;      /**< Number of items              */
+};  // end of struct disk_header
+
+/** Disk TRIE node record header */
+struct disk_node {
+    uint32_t qlen;       /**< Key quad-bit length            */
+    uint32_t label_len;  /**< Label length (bytes)           */
+    uint16_t branches;   /**< Branch bitmap                  */
+    uint8_t  has_value;  /**< Value flag                     */
+    uint8_t  reserved1;  /**< Reserved                       */
+    uint32_t reserved2;  /**< Reserved                       */
+    uint64_t value;      /**< Value                          */
+};  // end of struct disk_node
+
+/** Disk TRIE node reference (branch) */
+struct disk_ref {
+    uint64_t off;        /**< Node record offset */
+    uint32_t size;       /**< Node record size   */
+    uint32_t reserved;   /**< Reserved           */
+};  // end of struct disk_ref
+
+/**
+ *  \brief  Key quad-bit
+ *
+ *  \param  key   Key
+ *  \param  qpos  Quad-bit position
+ *
+ *  \return Quad-bit value
+ */
+inline unsigned disk_qbit(const unsigned char * key, size_t qpos) {
+    const unsigned char byte = key[qpos / 2];
+    return qpos % 2 ? byte & 0x0f : byte >> 4;
+}
+
+/** Number of set bits in 16 bit word */
+inline unsigned disk_popcount(uint16_t bits) {
+    return __builtin_popcount(bits);
+}
+
+
+/**
+ *  \brief  Minimal io_uring (raw system calls)
+ *
+ *  Only reads are submitted; completions are identified by user data.
+ *  \c IORING_OP_READ is used if the kernel supports it (5.6+, checked
+ *  by \c IORING_REGISTER_PROBE); \c IORING_OP_READV (5.1+) otherwise.
+ */
+class uring {
+    private:
+
+    int                   m_fd;         /**< Ring descriptor        */
+    unsigned              m_entries;    /**< SQ entries             */
+    unsigned              m_submit;     /**< SQEs not submitted yet */
+    bool                  m_readv;      /**< Use \c IORING_OP_READV */
+
+    void *                m_sq_ptr;     /**< SQ ring mapping        */
+    size_t                m_sq_size;    /**< SQ ring mapping size   */
+    void *                m_cq_ptr;     /**< CQ ring mapping        */
+    size_t                m_cq_size;    /**< CQ ring mapping size   */
+    struct io_uring_sqe * m_sqes;       /**< SQE array              */
+    size_t                m_sqes_size;  /**< SQE array size         */
+
+    unsigned *            m_sq_head;    /**< SQ head                */
+    unsigned *            m_sq_tail;    /**< SQ tail                */
+    unsigned *            m_sq_mask;    /**< SQ mask                */
+    unsigned *            m_sq_array;   /**< SQ index array         */
+    unsigned *            m_cq_head;    /**< CQ head                */
+    unsigned *            m_cq_tail;    /**< CQ tail                */
+    unsigned *            m_cq_mask;    /**< CQ mask                */
+    struct io_uring_cqe * m_cqes;       /**< CQE array              */
+
+    /** Throw system error */
+    static void throw_errno(const std::string & what) {
+        throw std::system_error(errno, std::system_category(),
+            "libtrie++: " + what);
+    }
+
+    /** Map ring region */
+    void * map(size_t size, off_t off) {
+        void * ptr = ::mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, m_fd, off);
+
+        if (MAP_FAILED == ptr) throw_errno("io_uring mmap");
+        return ptr;
+    }
+
+    /**
+     *  \brief  Check that operation is supported
+     *
+     *  \param  op  Operation
+     *
+     *  \return \c true iff the kernel supports probing and \c op
+     */
+    bool probe(unsigned op) const {
+        const unsigned ops = 256;
+        std::vector<char> buf(sizeof(struct io_uring_probe) +
+            ops * sizeof(struct io_uring_probe_op), 0);
+
+        struct io_uring_probe * pr = (struct io_uring_probe *)buf.data();
+        if (-1 == ::syscall(__NR_io_uring_register, m_fd,
+            IORING_REGISTER_PROBE, pr, ops))
+        {
+            return false;  // no probing, no IORING_OP_READ (pre 5.6)
+        }
+
+        return op <= pr->last_op &&
+            (pr->ops[op].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    /** Release resources */
+    void release() {
+        if (NULL != m_sqes) ::munmap(m_sqes, m_sqes_size);
+        if (NULL != m_cq_ptr && m_cq_ptr != m_sq_ptr)
+            ::munmap(m_cq_ptr, m_cq_size);
+        if (NULL != m_sq_ptr) ::munmap(m_sq_ptr, m_sq_size);
+        if (-1 != m_fd) ::close(m_fd);
+    }
+
+    public:
+
+    /**
+     *  \brief  Constructor
+     *
+     *  Throws \c std::system_error if io_uring isn't available.
+     *
+     *  \param  entries  Number of entries (queue depth)
+     */
+    uring(unsigned entries):
+        m_fd(-1), m_entries(0), m_submit(0), m_readv(false),
+        m_sq_ptr(NULL), m_sq_size(0), m_cq_ptr(NULL), m_cq_size(0),
+        m_sqes(NULL), m_sqes_size(0)
+    {
+        struct io_uring_params params;
+        ::memset(&params, 0, sizeof(params));
+
+        m_fd = ::syscall(__NR_io_uring_setup, entries, &params);
+        if (-1 == m_fd) throw_errno("io_uring_setup");
+
+        try {
+            m_entries = params.sq_entries;
+            m_sq_size = params.sq_off.array +
+                params.sq_entries * sizeof(unsigned);
+            m_cq_size = params.cq_off.cqes +
+                params.cq_entries * sizeof(struct io_uring_cqe);
+
+            const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single && m_cq_size > m_sq_size) m_sq_size = m_cq_size;
+
+            m_sq_ptr = map(m_sq_size, IORING_OFF_SQ_RING);
+            m_cq_ptr = single ? m_sq_ptr : map(m_cq_size, IORING_OFF_CQ_RING);
+
+            m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+            m_sqes = (struct io_uring_sqe *)map(
+                m_sqes_size, IORING_OFF_SQES);
+
+            m_readv = !probe(IORING_OP_READ);
+        }
+        catch (...) {
+            release();
+            throw;
+        }
+
+        char * sq = (char *)m_sq_ptr;
+        m_sq_head  = (unsigned *)(sq + params.sq_off.head);
+        m_sq_tail  = (unsigned *)(sq + params.sq_off.tail);
+        m_sq_mask  = (unsigned *)(sq + params.sq_off.ring_mask);
+        m_sq_array = (unsigned *)(sq + params.sq_off.array);
+
+        char * cq = (char *)m_cq_ptr;
+        m_cq_head = (unsigned *)(cq + params.cq_off.head);
+        m_cq_tail = (unsigned *)(cq + params.cq_off.tail);
+        m_cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+        m_cqes    = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    }
+
+    uring(const uring & ) = delete;
+    uring & operator = (const uring & ) = delete;
+
+    /** Number of entries */
+    inline unsigned entries() const { return m_entries; }
+
+    /** \c IORING_OP_READV is used (instead of \c IORING_OP_READ) */
+    inline bool readv() const { return m_readv; }
+
+    /**
+     *  \brief  Queue read
+     *
+     *  The I/O vector must be kept (unchanged) until the read completes.
+     *
+     *  \param  fd         File descriptor
+     *  \param  iov        Buffer (I/O vector)
+     *  \param  off        File offset
+     *  \param  user_data  User data
+     *
+     *  \return \c false if SQ is full
+     */
+    bool read(int fd, const struct iovec * iov, uint64_t off,
+        uint64_t user_data)
+    {
+        const unsigned tail = *m_sq_tail;
+        const unsigned head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head >= m_entries) return false;
+
+        const unsigned ix = tail & *m_sq_mask;
+        struct io_uring_sqe * sqe = m_sqes + ix;
+        ::memset(sqe, 0, sizeof(*sqe));
+
+        if (m_readv) {
+            sqe->opcode = IORING_OP_READV;
+            sqe->addr   = (uint64_t)(uintptr_t)iov;
+            sqe->len    = 1;
+        }
+        else {
+            sqe->opcode = IORING_OP_READ;
+            sqe->addr   = (uint64_t)(uintptr_t)iov->iov_base;
+            sqe->len    = iov->iov_len;
+        }
+
+        sqe->fd        = fd;
+        sqe->off       = off;
+        sqe->user_data = user_data;
+
+        m_sq_array[ix] = ix;
+        __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+        ++m_submit;
+
+        return true;
+    }
+
+    /**
+     *  \brief  Submit queued reads (and wait for completions)
+     *
+     *  \param  wait_nr  Number of completions to wait for
+     */
+    void submit(unsigned wait_nr = 0) {
+        for (;;) {
+            const int cnt = ::syscall(__NR_io_uring_enter, m_fd,
+                m_submit, wait_nr, wait_nr ? IORING_ENTER_GETEVENTS : 0,
+                NULL, 0);
+
+            if (-1 == cnt) {
+                if (EINTR == errno) continue;
+                throw_errno("io_uring_enter");
+            }
+
+            m_submit -= cnt;
+            return;
+        }
+    }
+
+    /**
+     *  \brief  Reap completions
+     *
+     *  \param  done  Completions (user data and result; appended)
+     */
+    void reap(std::vector<std::pair<uint64_t, int> > & done) {
+        unsigned head = *m_cq_head;
+        const unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; ++head) {
+            const struct io_uring_cqe & cqe = m_cqes[head & *m_cq_mask];
+            done.push_back(std::make_pair(cqe.user_data, cqe.res));
+        }
+
+        __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    /** Destructor */
+    ~uring() { release(); }
+
+};  // end of class uring
+
+}  // end of namespace impl
+
+
+/**
+ *  \brief  Paged on-disk TRIE
+ *
+ *  Read-only TRIE mapping keys to 64 bit values, stored in a file
+ *  of fixed size pages.
+ *  Each node record holds node key quad-bit length, key label (key bytes
+ *  between the parent branching and the node), value (if any) and
+ *  references (offset and size) of its branches.
+ *  Records don't cross page boundaries unless larger than a page.
+ *
+ *  Top of the TRIE is laid out breadth-first (so that the top levels
+ *  share a few pages, which are kept in memory once the file is open);
+ *  the rest is laid out depth-first (so that sub-trees share pages).
+ *
+ *  Lookups may be synchronous (\ref find, using \c pread) or asynchronous
+ *  (\ref async_find): a lookup is suspended whenever it needs a page
+ *  that's not in memory; the page is read via io_uring and the lookup
+ *  is resumed when the read completes (in \ref poll).
+ *  Up to queue depth lookups are in flight at once; more are queued.
+ *  If io_uring isn't available (or queue depth of 0 is requested),
+ *  asynchronous lookups are done synchronously in \ref poll.
+ *
+ *  File format uses native byte order.
+ */
+class disk_trie {
+    public:
+
+    /** Lookup completion (called with found flag and value) */
+    typedef std::function<void (bool, uint64_t)> completion_t;
+
+    private:
+
+    /** Magic (incl. format version) */
+    static const char * magic() { return "libtrie1"; }
+
+    /** Lookup (state) */
+    struct lookup_t {
+        std::string                key;      /**< Key                     */
+        completion_t               fn;       /**< Completion              */
+        uint64_t                   off;      /**< Node record offset      */
+        uint32_t                   size;     /**< Node record size        */
+        size_t                     qpos;     /**< Label quad-bit position */
+        uint64_t                   buf_off;  /**< Buffer file offset      */
+        std::vector<unsigned char> buf;      /**< Page buffer             */
+        struct iovec               iov;      /**< Read I/O vector         */
+
+        lookup_t(): off(0), size(0), qpos(0), buf_off(0) {
+            iov.iov_base = NULL;
+            iov.iov_len  = 0;
+        }
+
+    };  // end of struct lookup_t
+
+    int                          m_fd;      /**< File descriptor         */
+    impl::disk_header            m_header;  /**< File header             */
+    std::vector<unsigned char>   m_top;     /**< Top pages (from 0)      */
+    std::vector<lookup_t>        m_slots;   /**< In-flight lookups       */
+    std::vector<size_t>          m_free;    /**< Free slots              */
+    std::unique_ptr<impl::uring> m_ring;    /**< io_uring (if available) */
+    std::deque<lookup_t>         m_queue;   /**< Queued lookups          */
+
+    /** Throw system error */
+    static void throw_errno(const std::string & what) {
+        throw std::system_error(errno, std::system_category(),
+            "libtrie++: " + what);
+    }
+
+    /**
+     *  \brief  Match key against node label
+     *
+     *  \param  key    Key
+     *  \param  label  Label (key bytes from \c qpos / 2)
+     *  \param  qpos   Label 1st quad-bit position
+     *  \param  qlen   Node quad-bit length
+     *
+     *  \return \c true iff key quad-bits [\c qpos, \c qlen) match
+     */
+    static bool label_match(
+        const unsigned char * key,
+        const unsigned char * label,
+        size_t                qpos,
+        size_t                qlen)
+    {
+        const size_t base = qpos / 2;
+
+        // Low quad-bit of the 1st byte
+        if (qpos % 2 && qpos < qlen) {
+            if ((key[base] ^ label[0]) & 0x0f) return false;
+            ++qpos;
+        }
+
+        // Whole bytes
+        if (qpos < qlen) {
+            const size_t from = qpos / 2, to = qlen / 2;
+            if (::memcmp(key + from, label + from - base, to - from))
+                return false;
+
+            qpos = to * 2;
+        }
+
+        // High quad-bit of the last byte
+        if (qpos < qlen && ((key[qpos / 2] ^ label[qpos / 2 - base]) >> 4))
+            return false;
+
+        return true;
+    }
+
+    /**
+     *  \brief  Node record (if in memory)
+     *
+     *  \param  lk  Lookup
+     *
+     *  \return Node record or \c NULL if it needs to be read
+     */
+    const unsigned char * record(const lookup_t & lk) const {
+        if (lk.off + lk.size <= m_top.size()) return m_top.data() + lk.off;
+
+        if (lk.buf_off <= lk.off &&
+            lk.off + lk.size <= lk.buf_off + lk.buf.size())
+        {
+            return lk.buf.data() + (lk.off - lk.buf_off);
+        }
+
+        return NULL;
+    }
+
+    /**
+     *  \brief  Advance lookup
+     *
+     *  Walks down the TRIE as far as the node records are in memory.
+     *
+     *  \param  lk     Lookup
+     *  \param  found  Key found (if finished)
+     *  \param  value  Value (if found)
+     *
+     *  \return \c true if finished, \c false if a read is needed
+     *          (see \ref prepare_read)
+     */
+    bool advance(lookup_t & lk, bool & found, uint64_t & value) const {
+        const unsigned char * key  = (const unsigned char *)lk.key.data();
+        const size_t          klen = lk.key.size() << 1;
+
+        found = false;
+        for (;;) {
+            const unsigned char * rec = record(lk);
+            if (NULL == rec) return false;
+
+            impl::disk_node nod;
+            ::memcpy(&nod, rec, sizeof(nod));
+
+            const unsigned char * refs  = rec + sizeof(nod);
+            const unsigned char * label = refs +
+                impl::disk_popcount(nod.branches) * sizeof(impl::disk_ref);
+
+            if (nod.qlen > klen || !label_match(key, label, lk.qpos, nod.qlen))
+                return true;
+
+            if (nod.qlen == klen) {
+                found = nod.has_value;
+                value = nod.value;
+                return true;
+            }
+
+            const unsigned br = impl::disk_qbit(key, nod.qlen);
+            if (!(nod.branches & (1 << br))) return true;
+
+            impl::disk_ref ref;
+            ::memcpy(&ref, refs + sizeof(ref) *
+                impl::disk_popcount(nod.branches & ((1 << br) - 1)),
+                sizeof(ref));
+
+            lk.off  = ref.off;
+            lk.size = ref.size;
+            lk.qpos = nod.qlen + 1;
+        }
+    }
+
+    /**
+     *  \brief  Prepare read of the pages holding the lookup's next node
+     *
+     *  \param  lk  Lookup (buffer is resized, buffer offset set)
+     */
+    void prepare_read(lookup_t & lk) const {
+        const uint64_t page = m_header.page_size;
+        const uint64_t from = lk.off / page * page;
+        const uint64_t to   = (lk.off + lk.size + page - 1) / page * page;
+
+        lk.buf_off = from;
+        lk.buf.resize(to - from);
+    }
+
+    /**
+     *  \brief  Read buffer (synchronously)
+     *
+     *  \param  buf  Buffer
+     *  \param  len  Length
+     *  \param  off  File offset
+     */
+    void pread_all(void * buf, size_t len, uint64_t off) const {
+        for (char * pos = (char *)buf; len; ) {
+            const ssize_t rcnt = ::pread(m_fd, pos, len, off);
+            if (0 == rcnt)
+                throw std::runtime_error("libtrie++: disk TRIE truncated");
+
+            if (-1 == rcnt) {
+                if (EINTR == errno) continue;
+                throw_errno("pread");
+            }
+
+            pos += rcnt; len -= rcnt; off += rcnt;
+        }
+    }
+
+    /**
+     *  \brief  Run lookup synchronously
+     *
+     *  \param  lk     Lookup
+     *  \param  value  Value (if found)
+     *
+     *  \return \c true iff found
+     */
+    bool run(lookup_t & lk, uint64_t & value) const {
+        bool found;
+        while (!advance(lk, found, value)) {
+            prepare_read(lk);
+            pread_all(lk.buf.data(), lk.buf.size(), lk.buf_off);
+        }
+
+        return found;
+    }
+
+    /**
+     *  \brief  Start queued lookups (in free slots)
+     *
+     *  \return Number of lookups finished without I/O
+     */
+    size_t start() {
+        size_t done = 0;
+        while (!m_queue.empty() && !m_free.empty()) {
+            const size_t ix = m_free.back();
+            lookup_t &   lk = m_slots[ix];
+
+            lk.key.swap(m_queue.front().key);
+            lk.fn.swap(m_queue.front().fn);
+            lk.off     = m_queue.front().off;
+            lk.size    = m_queue.front().size;
+            lk.qpos    = 0;
+            lk.buf_off = 0;
+            lk.buf.clear();
+            m_queue.pop_front();
+
+            bool     found;
+            uint64_t value = 0;
+            if (advance(lk, found, value)) {
+                completion_t fn; fn.swap(lk.fn);
+                fn(found, value);
+                ++done;
+                continue;
+            }
+
+            m_free.pop_back();
+            submit(ix);
+        }
+
+        return done;
+    }
+
+    /**
+     *  \brief  Queue read for lookup in slot
+     *
+     *  \param  ix  Slot index
+     */
+    void submit(size_t ix) {
+        lookup_t & lk = m_slots[ix];
+        prepare_read(lk);
+
+        lk.iov.iov_base = lk.buf.data();
+        lk.iov.iov_len  = lk.buf.size();
+
+        // SQ can't be full, there are no more slots than entries
+        if (!m_ring->read(m_fd, &lk.iov, lk.buf_off, ix))
+            throw std::logic_error("libtrie++: io_uring SQ overflow");
+    }
+
+    /**
+     *  \brief  Resume lookup in slot after its read completed
+     *
+     *  Failed reads are retried synchronously; should that fail, too,
+     *  the lookup is abandoned (its completion isn't called).
+     *  The slot is freed unless another read is submitted; completion
+     *  is called after that (so that it may start new lookups).
+     *
+     *  \param  ix   Slot index
+     *  \param  res  Read result (bytes read or negative error code)
+     *
+     *  \return \c true iff the lookup finished
+     */
+    bool resume(size_t ix, int res) {
+        lookup_t & lk = m_slots[ix];
+
+        bool     found;
+        uint64_t value = 0;
+        try {
+            // Failed or short read (finish synchronously)
+            const size_t rcnt = res < 0 ? 0 : res;
+            if (rcnt < lk.buf.size())
+                pread_all(lk.buf.data() + rcnt,
+                    lk.buf.size() - rcnt, lk.buf_off + rcnt);
+
+            if (!advance(lk, found, value)) {
+                submit(ix);
+                return false;
+            }
+        }
+        catch (...) {
+            lk.fn = completion_t();
+            m_free.push_back(ix);
+            throw;
+        }
+
+        completion_t fn; fn.swap(lk.fn);
+        m_free.push_back(ix);
+        fn(found, value);
+        return true;
+    }
+
+    public:
+
+    /**
+     *  \brief  Write disk TRIE
+     *
+     *  Input is in the flat format of \c trie::export_sorted: keys
+     *  (sorted, unique) are concatenated in \c keys, key \c i occupies
+     *  bytes [\c offsets[i], \c offsets[i+1]).
+     *
+     *  \param  path       File path
+     *  \param  keys       Key bytes
+     *  \param  offsets    Key offsets (number of items + 1)
+     *  \param  values     Values
+     *  \param  page_size  Page size
+     *  \param  top_pages  Number of top (breadth-first) pages
+     */
+    static void write(
+        const std::string &                path,
+        const std::vector<unsigned char> & keys,
+        const std::vector<size_t> &        offsets,
+        const std::vector<uint64_t> &      values,
+        size_t                             page_size = 4096,
+        size_t                             top_pages = 64)
+    {
+        if (page_size < sizeof(impl::disk_header))
+            throw std::logic_error("libtrie++: disk TRIE page too small");
+
+        if (offsets.size() != values.size() + 1)
+            throw std::logic_error("libtrie++: disk TRIE input mismatch");
+
+        const size_t n = values.size();
+        auto key = [&](size_t i) { return keys.data() + offsets[i]; };
+        auto len = [&](size_t i) { return offsets[i + 1] - offsets[i]; };
+
+        for (size_t i = 1; i < n; ++i) {
+            const size_t l1 = len(i - 1), l2 = len(i);
+            const int cmp = ::memcmp(key(i - 1), key(i), l1 < l2 ? l1 : l2);
+            if (cmp > 0 || (0 == cmp && l1 >= l2))
+                throw std::logic_error(
+                    "libtrie++: disk TRIE keys not sorted and unique");
+        }
+
+        // Build nodes (children follow their parent, per level)
+        struct build_node {
+            size_t              qlen;       /**< Key quad-bit length */
+            size_t              qpos;       /**< Label position      */
+            size_t              ix;         /**< Key index           */
+            bool                has_value;  /**< Value flag          */
+            uint16_t            branches;   /**< Branch bitmap       */
+            std::vector<size_t> sons;       /**< Branch nodes        */
+            uint64_t            off;        /**< Record offset       */
+            uint32_t            size;       /**< Record size         */
+        };  // end of struct build_node
+
+        std::vector<build_node> nodes;
+
+        std::function<size_t (size_t, size_t, size_t)> build =
+        [&](size_t lo, size_t hi, size_t qpos) -> size_t {
+            build_node nod;
+            nod.qpos      = qpos;
+            nod.ix        = lo;
+            nod.has_value = false;
+            nod.branches  = 0;
+            nod.off       = 0;
+            nod.size      = 0;
+
+            if (lo == hi)  // empty TRIE
+                nod.qlen = 0;
+
+            else if (lo + 1 == hi)
+                nod.qlen = len(lo) << 1;
+
+            else {  // common prefix of the 1st and last key
+                const unsigned char * k1 = key(lo);
+                const unsigned char * k2 = key(hi - 1);
+                const size_t l1  = len(lo), l2 = len(hi - 1);
+                const size_t max = l1 < l2 ? l1 : l2;
+
+                size_t i = 0;
+                while (i < max && k1[i] == k2[i]) ++i;
+
+                nod.qlen = i << 1;
+                if (i < max && !((k1[i] ^ k2[i]) >> 4)) ++nod.qlen;
+            }
+
+            size_t i = lo;
+            if (i < hi && len(i) << 1 == nod.qlen) {
+                nod.has_value = true;
+                ++i;
+            }
+
+            const size_t nix = nodes.size();
+            nodes.push_back(nod);
+
+            std::vector<size_t> sons;
+            while (i < hi) {
+                const unsigned br = impl::disk_qbit(key(i), nod.qlen);
+
+                size_t j = i + 1;
+                while (j < hi && impl::disk_qbit(key(j), nod.qlen) == br) ++j;
+
+                sons.push_back(build(i, j, nod.qlen + 1));
+                nodes[nix].branches |= 1 << br;
+                i = j;
+            }
+
+            nodes[nix].sons.swap(sons);
+
+            const size_t label_len = nod.qlen > qpos
+                ? (nod.qlen + 1) / 2 - qpos / 2 : 0;
+
+            nodes[nix].size = sizeof(impl::disk_node) +
+                nodes[nix].sons.size() * sizeof(impl::disk_ref) + label_len;
+
+            return nix;
+        };
+
+        build(0, n, 0);
+
+        // Lay records out
+        std::vector<size_t> order; order.reserve(nodes.size());
+        uint64_t pos = page_size;
+
+        auto place = [&](size_t nix) {
+            build_node & nod = nodes[nix];
+            if (pos % page_size + nod.size > page_size && nod.size <= page_size)
+                pos = (pos / page_size + 1) * page_size;
+
+            nod.off = pos;
+            pos += nod.size;
+            order.push_back(nix);
+        };
+
+        // Top (breadth-first)
+        const uint64_t top_max = page_size * (1 + top_pages);
+        std::deque<size_t> bfs(1, 0);
+        while (!bfs.empty() && pos + nodes[bfs.front()].size <= top_max) {
+            place(bfs.front());
+            for (size_t son: nodes[bfs.front()].sons) bfs.push_back(son);
+            bfs.pop_front();
+        }
+
+        const uint64_t top_end = pos;
+
+        // The rest (depth-first)
+        std::function<void (size_t)> dfs = [&](size_t nix) {
+            place(nix);
+            for (size_t son: nodes[nix].sons) dfs(son);
+        };
+
+        for (size_t nix: bfs) dfs(nix);
+
+        // Write file
+        std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+        file.exceptions(std::ios::failbit | std::ios::badbit);
+
+        impl::disk_header header;
+        ::memset(&header, 0, sizeof(header));
+        ::memcpy(header.magic, magic(), sizeof(header.magic));
+        header.page_size = page_size;
+        header.root_off  = nodes[0].off;
+        header.root_size = nodes[0].size;
+        header.top_end   = top_end;
+        header.items     = n;
+
+        std::vector<char> zeros(page_size, 0);
+        file.write((const char *)&header, sizeof(header));
+
+        uint64_t at = sizeof(header);
+        for (size_t nix: order) {
+            const build_node & nod = nodes[nix];
+            file.write(zeros.data(), nod.off - at);
+
+            impl::disk_node rec;
+            ::memset(&rec, 0, sizeof(rec));
+            rec.qlen      = nod.qlen;
+            rec.label_len = nod.size - sizeof(rec) -
+                nod.sons.size() * sizeof(impl::disk_ref);
+            rec.branches  = nod.branches;
+            rec.has_value = nod.has_value;
+            rec.value     = nod.has_value ? values[nod.ix] : 0;
+            file.write((const char *)&rec, sizeof(rec));
+
+            for (size_t son: nod.sons) {
+                impl::disk_ref ref;
+                ref.off      = nodes[son].off;
+                ref.size     = nodes[son].size;
+                ref.reserved = 0;
+                file.write((const char *)&ref, sizeof(ref));
+            }
+
+            file.write((const char *)key(nod.ix) + nod.qpos / 2, rec.label_len);
+            at = nod.off + nod.size;
+        }
+
+        file.write(zeros.data(), (page_size - at % page_size) % page_size);
+    }
+
+    /**
+     *  \brief  Write disk TRIE
+     *
+     *  \param  path       File path
+     *  \param  trie       TRIE
+     *  \param  value_fn   Item to value transformation
+     *  \param  page_size  Page size
+     *  \param  top_pages  Number of top (breadth-first) pages
+     */
+    template <class Trie, class ValueFn>
+    static void write(
+        const std::string & path,
+        const Trie &        trie,
+        ValueFn             value_fn,
+        size_t              page_size = 4096,
+        size_t              top_pages = 64)
+    {
+        std::vector<unsigned char> keys;
+        std::vector<size_t>        offsets;
+        std::vector<uint64_t>      values;
+        trie.export_sorted(keys, offsets, values, value_fn);
+
+        write(path, keys, offsets, values, page_size, top_pages);
+    }
+
+    /**
+     *  \brief  Constructor
+     *
+     *  \param  path         File path
+     *  \param  queue_depth  Max. number of lookups in flight
+     *                       (0 means no io_uring)
+     */
+    disk_trie(const std::string & path, size_t queue_depth = 256):
+        m_fd(::open(path.c_str(), O_RDONLY))
+    {
+        if (-1 == m_fd) throw_errno("open " + path);
+
+        try {
+            pread_all(&m_header, sizeof(m_header), 0);
+            if (::memcmp(m_header.magic, magic(), sizeof(m_header.magic)))
+                throw std::runtime_error(
+                    "libtrie++: not a disk TRIE: " + path);
+
+            m_top.resize(m_header.top_end);
+            pread_all(m_top.data(), m_top.size(), 0);
+
+            if (queue_depth) {
+                try {
+                    m_ring.reset(new impl::uring(queue_depth));
+                }
+                catch (const std::system_error & ) {}  // fallback to pread
+            }
+
+            const size_t slots = m_ring ? m_ring->entries() : 0;
+            m_slots.resize(slots);
+            for (size_t i = slots; i; --i) m_free.push_back(i - 1);
+        }
+        catch (...) {
+            ::close(m_fd);
+            throw;
+        }
+    }
+
+    disk_trie(const disk_trie & ) = delete;
+    disk_trie & operator = (const disk_trie & ) = delete;
+
+    /** Number of items */
+    inline size_t size() const { return m_header.items; }
+
+    /** Asynchronous I/O (io_uring) is used */
+    inline bool async() const { return NULL != m_ring.get(); }
+
+    /** Number of lookups in flight or queued */
+    inline size_t in_flight() const {
+        return m_slots.size() - m_free.size() + m_queue.size();
+    }
+
+    /** Drop file pages from the page cache (for benchmarking) */
+    void drop_cache() const {
+        ::fdatasync(m_fd);  // dirty pages aren't dropped
+        ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+
+    /**
+     *  \brief  Find key (synchronously)
+     *
+     *  \param  key    Key
+     *  \param  len    Key length
+     *  \param  value  Value (if found)
+     *
+     *  \return \c true iff found
+     */
+    bool find(const unsigned char * key, size_t len, uint64_t & value) const {
+        lookup_t lk;
+        lk.key.assign((const char *)key, len);
+        lk.off     = m_header.root_off;
+        lk.size    = m_header.root_size;
+        lk.qpos    = 0;
+        lk.buf_off = 0;
+
+        return run(lk, value);
+    }
+
+    /**
+     *  \brief  Find key (synchronously)
+     *
+     *  \param  key    Key
+     *  \param  value  Value (if found)
+     *
+     *  \return \c true iff found
+     */
+    inline bool find(const std::string & key, uint64_t & value) const {
+        return find((const unsigned char *)key.data(), key.size(), value);
+    }
+
+    /**
+     *  \brief  Find key asynchronously
+     *
+     *  The lookup is queued (the key is copied); it's run and its
+     *  completion is called in \ref poll.
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *  \param  fn   Completion
+     */
+    void async_find(const unsigned char * key, size_t len, completion_t fn) {
+        m_queue.push_back(lookup_t());
+        lookup_t & lk = m_queue.back();
+        lk.key.assign((const char *)key, len);
+        lk.fn.swap(fn);
+        lk.off  = m_header.root_off;
+        lk.size = m_header.root_size;
+    }
+
+    /**
+     *  \brief  Find key asynchronously
+     *
+     *  \param  key  Key
+     *  \param  fn   Completion
+     */
+    inline void async_find(const std::string & key, completion_t fn) {
+        async_find((const unsigned char *)key.data(), key.size(), fn);
+    }
+
+    /**
+     *  \brief  Progress lookups
+     *
+     *  Queued lookups are started, submitted reads are reaped and
+     *  the lookups resumed (new reads are submitted as needed).
+     *  Completions are called from here (and may start new lookups).
+     *
+     *  All reaped reads are processed even if some of them fail
+     *  (see \ref resume) or their completions throw; the 1st exception
+     *  is re-thrown afterwards.
+     *
+     *  \param  wait  Wait for at least 1 completion (if any in flight)
+     *
+     *  \return Number of finished lookups
+     */
+    size_t poll(bool wait = true) {
+        size_t done = 0;
+
+        // Synchronous fallback
+        if (!m_ring) {
+            while (!m_queue.empty()) {
+                lookup_t lk; std::swap(lk, m_queue.front());
+                m_queue.pop_front();
+
+                uint64_t   value = 0;
+                const bool found = run(lk, value);
+                lk.fn(found, value);
+                ++done;
+            }
+
+            return done;
+        }
+
+        done += start();
+
+        const bool busy = m_free.size() < m_slots.size();
+        m_ring->submit(wait && busy ? 1 : 0);
+
+        std::vector<std::pair<uint64_t, int> > reaped;
+        m_ring->reap(reaped);
+
+        std::exception_ptr error;
+        for (const auto & cqe: reaped) {
+            try {
+                if (resume(cqe.first, cqe.second)) ++done;
+            }
+            catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+
+        if (error) std::rethrow_exception(error);
+
+        done += start();
+        m_ring->submit();
+
+        return done;
+    }
+
+    /** Finish all lookups */
+    void drain() {
+        while (in_flight()) poll();
+    }
+
+    /** Destructor (waits for reads in flight, lookups are abandoned) */
+    ~disk_trie() {
+        if (m_ring) {
+            try {
+                std::vector<std::pair<uint64_t, int> > reaped;
+                for (size_t busy = m_slots.size() - m_free.size(); busy; ) {
+                    m_ring->submit(1);
+                    m_ring->reap(reaped);
+                    busy -= reaped.size() < busy ? reaped.size() : busy;
+                    reaped.clear();
+                }
+            }
+            catch (...) {}
+        }
+
+        ::close(m_fd);
+    }
+
+};  // end of class disk_trie
+
+}  // end of namespace container
+
+#endif  // end of #ifndef disk_trie_hxx
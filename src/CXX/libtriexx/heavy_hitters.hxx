@@ -0,0 +1,207 @@
+#ifndef heavy_hitters_hxx
+#define heavy_hitters_hxx
+
+/**
+ *  \file
+ *  \brief  Heavy hitters (hot key prefixes) tracking
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace container {
+
+/**
+ *  \brief  Heavy hitters of key prefixes
+ *
+ *  Key prefixes of configured lengths (depths) are counted in
+ *  space-saving sketches (one per depth).
+ *  Each sketch keeps a fixed number of counters; a new prefix replaces
+ *  the least frequent one, inheriting its count as an error bound.
+ *  Any prefix more frequent than 1/capacity of the samples is
+ *  guaranteed to be kept.
+ *
+ *  The object is a TRIE key access sampler (see \ref trie::sampler);
+ *  pass it wrapped by \c std::ref.
+ */
+class heavy_hitters {
+    public:
+
+    /** Heavy hitter report */
+    struct hitter_t {
+        std::string prefix;  /**< Key prefix                          */
+        size_t      count;   /**< Estimated count (upper bound)       */
+        size_t      error;   /**< Max. overestimation of the count    */
+    };  // end of struct hitter_t
+
+    private:
+
+    /** Space-saving sketch */
+    struct sketch_t {
+        size_t                                  depth;     /**< Prefix len. */
+        std::vector<hitter_t>                   counters;  /**< Counters    */
+        std::unordered_map<std::string, size_t> index;     /**< Prefix ix.  */
+
+        sketch_t(size_t _depth): depth(_depth) {}
+
+    };  // end of struct sketch_t
+
+    std::vector<sketch_t> m_sketches;  /**< Sketches (per depth)   */
+    size_t                m_capacity;  /**< Counters per sketch    */
+    size_t                m_samples;   /**< Number of samples      */
+
+    /**
+     *  \brief  Count prefix in sketch
+     *
+     *  \param  sketch  Sketch
+     *  \param  prefix  Key prefix
+     */
+    void count(sketch_t & sketch, const std::string & prefix) {
+        auto found = sketch.index.find(prefix);
+        if (sketch.index.end() != found) {
+            ++sketch.counters[found->second].count;
+            return;
+        }
+
+        // Free counter
+        if (sketch.counters.size() < m_capacity) {
+            sketch.index.emplace(prefix, sketch.counters.size());
+            sketch.counters.push_back(hitter_t());
+
+            hitter_t & hitter = sketch.counters.back();
+            hitter.prefix = prefix;
+            hitter.count  = 1;
+            hitter.error  = 0;
+            return;
+        }
+
+        // Replace the least frequent prefix
+        auto min = std::min_element(
+            sketch.counters.begin(), sketch.counters.end(),
+            [](const hitter_t & h1, const hitter_t & h2) -> bool {
+                return h1.count < h2.count;
+            });
+
+        sketch.index.erase(min->prefix);
+        sketch.index.emplace(prefix, min - sketch.counters.begin());
+
+        min->prefix = prefix;
+        min->error  = min->count;
+        ++min->count;
+    }
+
+    public:
+
+    /**
+     *  \brief  Constructor
+     *
+     *  \param  depths    Tracked prefix lengths
+     *  \param  capacity  Number of counters per prefix length
+     */
+    heavy_hitters(const std::vector<size_t> & depths, size_t capacity = 64):
+        m_capacity(capacity),
+        m_samples(0)
+    {
+        if (0 == capacity)
+            throw std::logic_error(
+                "libtrie++: heavy hitters capacity must be positive");
+
+        for (size_t depth: depths)
+            m_sketches.emplace_back(depth);
+    }
+
+    /** Number of samples */
+    inline size_t samples() const { return m_samples; }
+
+    /**
+     *  \brief  Sample key
+     *
+     *  Prefixes of all the tracked lengths are counted
+     *  (shorter keys are ignored by the longer prefix sketches).
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     */
+    void sample(const unsigned char * key, size_t len) {
+        ++m_samples;
+
+        for (sketch_t & sketch: m_sketches)
+            if (sketch.depth <= len)
+                count(sketch, std::string((const char *)key, sketch.depth));
+    }
+
+    /** Sample key (sampler interface) */
+    inline void operator () (const unsigned char * key, size_t len) {
+        sample(key, len);
+    }
+
+    /**
+     *  \brief  Top heavy hitters
+     *
+     *  \param  depth  Prefix length (must be tracked)
+     *  \param  k      Max. number of prefixes reported
+     *
+     *  \return Most frequent prefixes (by estimated count, descending)
+     */
+    std::vector<hitter_t> top(size_t depth, size_t k) const {
+        for (const sketch_t & sketch: m_sketches) {
+            if (sketch.depth != depth) continue;
+
+            std::vector<hitter_t> hitters(sketch.counters);
+            std::sort(hitters.begin(), hitters.end(),
+            [](const hitter_t & h1, const hitter_t & h2) -> bool {
+                return h1.count > h2.count;
+            });
+
+            if (hitters.size() > k) hitters.resize(k);
+            return hitters;
+        }
+
+        throw std::logic_error(
+            "libtrie++: heavy hitters prefix length not tracked");
+    }
+
+};  // end of class heavy_hitters
+
+}  // end of namespace container
+
+#endif  // end of #ifndef heavy_hitters_hxx
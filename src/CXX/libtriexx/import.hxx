@@ -0,0 +1,503 @@
+#ifndef import_hxx
+#define import_hxx
+
+/**
+ *  \file
+ *  \brief  TRIE bulk import (memory-mapped input, parallel record scanner)
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "trie.hxx"
+#include "trie_sort.hxx"
+#include "parallel.hxx"
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+}
+
+
+namespace container {
+
+/**
+ *  \brief  Import record
+ *
+ *  Record line format is
+ *
+ *      <action> <value> <key>
+ *
+ *  where action is either \c A (add) or \c R (remove), value is
+ *  a decimal number and key is a string of non-blank characters (possibly
+ *  empty).
+ *  Binary keys are written length-prefixed as \c #<length>: followed
+ *  by exactly \c length bytes (of any value, including blanks and
+ *  line ends); text keys starting with \c # must be written that way, too.
+ *  Fields are separated by spaces or tabs, empty lines are ignored
+ *  and CR LF line ends are accepted.
+ *
+ *  The key points into the input buffer (which must outlive the record).
+ */
+struct import_record {
+    char                  action;  /**< Action (\c A or \c R) */
+    uint64_t              value;   /**< Value                 */
+    const unsigned char * key;     /**< Key                   */
+    size_t                len;     /**< Key length            */
+};  // end of struct import_record
+
+
+namespace impl {
+
+/** Import chunk (parsed by one thread) */
+struct import_chunk {
+    const char *               begin;    /**< Chunk begin                */
+    const char *               stop;     /**< Records begin before this  */
+    const char *               end;      /**< Behind last parsed record  */
+    const char *               error;    /**< Syntax error (or NULL)     */
+    std::vector<import_record> records;  /**< Parsed records             */
+    std::exception_ptr         x;        /**< Exception thrown (if any)  */
+};  // end of struct import_chunk
+
+/** Import field separator */
+inline bool import_blank(char c) { return ' ' == c || '\t' == c; }
+
+/** Import line end */
+inline bool import_eol(char c) { return '\n' == c || '\r' == c; }
+
+/**
+ *  \brief  Scan decimal number
+ *
+ *  \param  pos  Position
+ *  \param  end  Input end
+ *  \param  num  Number
+ *
+ *  \return Position behind the number (\c pos if there's none or
+ *          on overflow)
+ */
+inline const char * import_number(
+    const char * pos,
+    const char * end,
+    uint64_t &   num)
+{
+    const char * begin = pos;
+    num = 0;
+
+    for (; pos < end && '0' <= *pos && *pos <= '9'; ++pos) {
+        const uint64_t digit = *pos - '0';
+        if (num > (UINT64_MAX - digit) / 10) return begin;  // overflow
+
+        num = num * 10 + digit;
+    }
+
+    return pos;
+}
+
+/**
+ *  \brief  Scan import chunk
+ *
+ *  Records beginning before \c chunk.stop are parsed; the last one may
+ *  end behind it.
+ *  On syntax error, scanning stops and \c chunk.error is set.
+ *
+ *  \param  chunk  Chunk (\c begin and \c stop set)
+ *  \param  end    Input end
+ */
+inline void import_scan(import_chunk & chunk, const char * end) {
+    const char * pos = chunk.begin;
+    chunk.error = NULL;
+
+    while (pos < chunk.stop) {
+        while (pos < chunk.stop && (import_blank(*pos) || import_eol(*pos)))
+            ++pos;
+
+        if (!(pos < chunk.stop)) break;
+
+        const char * line = pos;
+        import_record rec;
+
+        // Action
+        rec.action = *pos++;
+        if (('A' != rec.action && 'R' != rec.action) ||
+            !(pos < end && import_blank(*pos)))
+        {
+            chunk.error = line;
+            break;
+        }
+
+        // Value
+        while (pos < end && import_blank(*pos)) ++pos;
+        const char * val = pos;
+        pos = import_number(pos, end, rec.value);
+        if (val == pos || (pos < end && !import_blank(*pos) &&
+            !import_eol(*pos)))
+        {
+            chunk.error = line;
+            break;
+        }
+
+        // Key
+        while (pos < end && import_blank(*pos)) ++pos;
+        if (pos < end && '#' == *pos) {  // binary
+            uint64_t len;
+            const char * len_pos = ++pos;
+            pos = import_number(pos, end, len);
+            if (len_pos == pos || !(pos < end && ':' == *pos) ||
+                (uint64_t)(end - ++pos) < len)
+            {
+                chunk.error = line;
+                break;
+            }
+
+            rec.key = (const unsigned char *)pos;
+            rec.len = len;
+            pos += len;
+        }
+        else {  // text
+            rec.key = (const unsigned char *)pos;
+            while (pos < end && !import_blank(*pos) && !import_eol(*pos))
+                ++pos;
+
+            rec.len = pos - (const char *)rec.key;
+        }
+
+        // Line end
+        while (pos < end && import_blank(*pos)) ++pos;
+        if (pos < end && '\r' == *pos) ++pos;
+        if (pos < end && '\n' != *pos++) {
+            chunk.error = line;
+            break;
+        }
+
+        chunk.records.push_back(rec);
+    }
+
+    chunk.end = pos < end ? pos : end;
+}
+
+}  // end of namespace impl
+
+
+/**
+ *  \brief  Parse import records
+ *
+ *  The input is split to chunks (at line ends) which are scanned
+ *  in parallel.
+ *  Since a binary key may contain line ends, a chunk may start amid
+ *  a record; such chunk is detected (it doesn't start where the previous
+ *  one ended) and re-scanned from the right position.
+ *
+ *  Syntax error is reported by \c std::runtime_error exception.
+ *
+ *  \param  data       Input
+ *  \param  size       Input size
+ *  \param  records    Parsed records (appended)
+ *  \param  threads    Number of threads (0 means number of CPUs)
+ *  \param  chunk_min  Minimal chunk size
+ */
+inline void parse_import(
+    const char *                 data,
+    size_t                       size,
+    std::vector<import_record> & records,
+    size_t                       threads   = 0,
+    size_t                       chunk_min = 1 << 20)
+{
+    if (0 == threads) threads = std::thread::hardware_concurrency();
+    if (0 == threads) threads = 1;
+
+    size_t chunk_cnt = chunk_min ? size / chunk_min : threads;
+    if (chunk_cnt > threads) chunk_cnt = threads;
+    if (0 == chunk_cnt) chunk_cnt = 1;
+
+    // Split input at line ends
+    const char * end = data + size;
+    std::vector<impl::import_chunk> chunks(chunk_cnt);
+
+    const char * begin = data;
+    for (size_t i = 0; i < chunk_cnt; ++i) {
+        const char * stop = end;
+        if (i + 1 < chunk_cnt) {
+            stop = data + size * (i + 1) / chunk_cnt;
+            if (stop < begin) stop = begin;
+
+            const char * eol = (const char *)::memchr(stop, '\n', end - stop);
+            stop = NULL == eol ? end : eol + 1;
+        }
+
+        chunks[i].begin = begin;
+        chunks[i].stop  = stop;
+        begin = stop;
+    }
+
+    // Scan chunks in parallel (a chunk may fail only to be re-scanned)
+    auto scan = [&chunks, end](size_t i) {
+        try {
+            impl::import_scan(chunks[i], end);
+        }
+        catch (...) {
+            chunks[i].x = std::current_exception();
+        }
+    };
+
+    impl::parallel(chunk_cnt, chunk_cnt, scan);
+
+    // Join chunks (re-scan those which didn't start at a record)
+    size_t total = 0;
+    for (const auto & chunk: chunks) total += chunk.records.size();
+    records.reserve(records.size() + total);
+
+    const char * pos = data;
+    for (auto & chunk: chunks) {
+        if (chunk.begin != pos) {
+            chunk.records.clear();
+            chunk.x     = std::exception_ptr();
+            chunk.begin = pos;
+            impl::import_scan(chunk, end);
+        }
+
+        if (chunk.x) std::rethrow_exception(chunk.x);
+
+        if (NULL != chunk.error) {
+            const char * eol = (const char *)::memchr(
+                chunk.error, '\n', end - chunk.error);
+
+            throw std::runtime_error(
+                "libtrie++: import syntax error at offset " +
+                std::to_string(chunk.error - data) + ": '" +
+                std::string(chunk.error, NULL == eol ? end : eol) + '\'');
+        }
+
+        records.insert(records.end(),
+            chunk.records.begin(), chunk.records.end());
+
+        pos = chunk.end;
+    }
+}
+
+
+/**
+ *  \brief  Import input
+ *
+ *  Regular files are memory-mapped (read-only), other input (pipes etc)
+ *  is read to a buffer.
+ */
+class import_input {
+    private:
+
+    const char * m_data;    /**< Input data                    */
+    size_t       m_size;    /**< Input size                    */
+    void *       m_map;     /**< Mapping (or \c MAP_FAILED)    */
+    std::string  m_buffer;  /**< Read buffer (unless mapped)   */
+
+    /** Throw system error */
+    static void throw_errno(const std::string & what) {
+        throw std::system_error(errno, std::system_category(),
+            "libtrie++: " + what);
+    }
+
+    /**
+     *  \brief  Map or read input
+     *
+     *  \param  fd  File descriptor
+     */
+    void init(int fd) {
+        struct stat st;
+        if (-1 == ::fstat(fd, &st)) throw_errno("fstat");
+
+        if (S_ISREG(st.st_mode) && 0 < st.st_size) {
+            m_map = ::mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED != m_map) {
+                ::madvise(m_map, st.st_size, MADV_SEQUENTIAL);
+                m_data = (const char *)m_map;
+                m_size = st.st_size;
+                return;
+            }
+        }
+
+        // Read (whole) input
+        char buffer[1 << 16];
+        for (;;) {
+            const ssize_t rcnt = ::read(fd, buffer, sizeof(buffer));
+            if (0 == rcnt) break;
+            if (-1 == rcnt) {
+                if (EINTR == errno) continue;
+                throw_errno("read");
+            }
+
+            m_buffer.append(buffer, rcnt);
+        }
+
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+    }
+
+    public:
+
+    /**
+     *  \brief  Constructor (descriptor)
+     *
+     *  \param  fd  File descriptor (not closed)
+     */
+    import_input(int fd): m_data(NULL), m_size(0), m_map(MAP_FAILED) {
+        init(fd);
+    }
+
+    /**
+     *  \brief  Constructor (file)
+     *
+     *  \param  path  File path
+     */
+    import_input(const std::string & path):
+        m_data(NULL), m_size(0), m_map(MAP_FAILED)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (-1 == fd) throw_errno("open " + path);
+
+        try {
+            init(fd);
+        }
+        catch (...) {
+            ::close(fd);
+            throw;
+        }
+
+        ::close(fd);  // mapping stays valid
+    }
+
+    import_input(const import_input & ) = delete;
+    import_input & operator = (const import_input & ) = delete;
+
+    /** Input data */
+    inline const char * data() const { return m_data; }
+
+    /** Input size */
+    inline size_t size() const { return m_size; }
+
+    /**
+     *  \brief  Parse records
+     *
+     *  See \ref parse_import.
+     *
+     *  \param  records  Parsed records (appended)
+     *  \param  threads  Number of threads (0 means number of CPUs)
+     */
+    inline void parse(
+        std::vector<import_record> & records,
+        size_t                       threads = 0) const
+    {
+        parse_import(m_data, m_size, records, threads);
+    }
+
+    /** Destructor */
+    ~import_input() {
+        if (MAP_FAILED != m_map) ::munmap(m_map, m_size);
+    }
+
+};  // end of class import_input
+
+
+/**
+ *  \brief  Apply import records to TRIE
+ *
+ *  The result is the same as if the records were applied one by one
+ *  (i.e. adding an existing key and removing a missing one is no-op).
+ *  However, runs of additions are inserted in key order (see
+ *  \ref trie_sort), so that consecutive insertions walk warm paths,
+ *  and runs of removals are done by \c erase_many.
+ *  Sorting pays off for TRIEs that don't fit into cache; small imports
+ *  are slightly slower than insertion in input order.
+ *
+ *  \param  trie     TRIE
+ *  \param  records  Import records
+ *  \param  item_fn  Record to TRIE item transformation
+ */
+template <class Trie, class ItemFn>
+void import_apply(
+    Trie &                             trie,
+    const std::vector<import_record> & records,
+    ItemFn                             item_fn)
+{
+    std::vector<import_record>         run;
+    std::vector<const unsigned char *> keys;
+    std::vector<size_t>                lens;
+
+    for (size_t i = 0; i < records.size(); ) {
+        const char action = records[i].action;
+
+        size_t j = i + 1;
+        while (j < records.size() && action == records[j].action) ++j;
+
+        if ('A' == action) {
+            run.assign(records.begin() + i, records.begin() + j);
+            run.erase(trie_sort(run.begin(), run.end(),
+            [](const import_record & rec) -> const unsigned char * {
+                return rec.key;
+            },
+            [](const import_record & rec) -> size_t {
+                return rec.len;
+            }), run.end());
+
+            for (const auto & rec: run) trie.insert(item_fn(rec));
+        }
+        else {
+            keys.clear();
+            lens.clear();
+            for (size_t k = i; k < j; ++k) {
+                keys.push_back(records[k].key);
+                lens.push_back(records[k].len);
+            }
+
+            trie.erase_many(keys.data(), lens.data(), keys.size());
+        }
+
+        i = j;
+    }
+}
+
+}  // end of namespace container
+
+#endif  // end of #ifndef import_hxx
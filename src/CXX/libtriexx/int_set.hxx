@@ -0,0 +1,448 @@
+#ifndef int_set_hxx
+#define int_set_hxx
+
+/**
+ *  \file
+ *  \brief  Integer set (roaring bitmap style)
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "trie.hxx"
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+
+
+namespace container {
+
+/**
+ *  \brief  Integer set
+ *
+ *  Integers are split to high bits and low 16 bits.
+ *  High bits (big-endian) are TRIE keys; TRIE items are chunks
+ *  of the low bits, stored either as a sorted array (sparse chunks)
+ *  or as a bitmap (dense chunks, more than 4096 integers).
+ *  Memory per integer is therefore 2 bytes or less (plus a TRIE leaf
+ *  per chunk) instead of a leaf per integer.
+ *
+ *  Union and intersection of sets walk chunks of both sets in key
+ *  order and combine bitmaps word by word.
+ *  The results are produced to a set passed by reference (as TRIEs
+ *  aren't movable).
+ *
+ *  \tparam  Int  Unsigned integer type (at least 32 bits wide)
+ */
+template <typename Int = uint32_t>
+class int_set {
+    private:
+
+    static const size_t key_len   = sizeof(Int) - 2;  /**< Chunk key len. */
+    static const size_t array_max = 4096;  /**< Max. array chunk size     */
+    static const size_t bm_words  = 1024;  /**< Bitmap size (in words)    */
+
+    /** Chunk of integers with common high bits */
+    struct chunk_t {
+        unsigned char         key[key_len];  /**< High bits (big endian) */
+        size_t                card;          /**< Cardinality            */
+        std::vector<uint16_t> array;         /**< Sorted low bits        */
+        std::vector<uint64_t> bitmap;        /**< Low bits bitmap        */
+
+        /** Constructor (empty array chunk) */
+        chunk_t(const unsigned char * _key): card(0) {
+            ::memcpy(key, _key, key_len);
+        }
+
+        /** Chunk is a bitmap */
+        inline bool is_bitmap() const { return !bitmap.empty(); }
+
+        /** Membership test */
+        bool contains(uint16_t low) const {
+            if (is_bitmap())
+                return (bitmap[low >> 6] >> (low & 0x3f)) & 0x1;
+
+            return std::binary_search(array.begin(), array.end(), low);
+        }
+
+        /** Insert low bits */
+        bool insert(uint16_t low) {
+            if (is_bitmap()) {
+                uint64_t & word = bitmap[low >> 6];
+                const uint64_t bit = (uint64_t)1 << (low & 0x3f);
+                if (word & bit) return false;
+
+                word |= bit;
+                ++card;
+                return true;
+            }
+
+            auto iter = std::lower_bound(array.begin(), array.end(), low);
+            if (array.end() != iter && *iter == low) return false;
+
+            array.insert(iter, low);
+            ++card;
+            if (card > array_max) to_bitmap();
+            return true;
+        }
+
+        /** Convert array to bitmap */
+        void to_bitmap() {
+            bitmap.assign(bm_words, 0);
+            for (uint16_t low: array)
+                bitmap[low >> 6] |= (uint64_t)1 << (low & 0x3f);
+
+            std::vector<uint16_t>().swap(array);
+        }
+
+        /** Convert bitmap to array */
+        void to_array() {
+            array.clear();
+            array.reserve(card);
+            for_each([this](uint16_t low) { array.push_back(low); });
+
+            std::vector<uint64_t>().swap(bitmap);
+        }
+
+        /** Compute bitmap cardinality (and convert if sparse) */
+        void bitmap_fixup() {
+            card = 0;
+            for (uint64_t word: bitmap)
+                card += __builtin_popcountll(word);
+
+            if (card <= array_max) to_array();
+        }
+
+        /** Call \c fn for low bits in ascending order */
+        template <class Fn>
+        void for_each(Fn fn) const {
+            if (!is_bitmap()) {
+                for (uint16_t low: array) fn(low);
+                return;
+            }
+
+            for (size_t i = 0; i < bm_words; ++i)
+                for (uint64_t word = bitmap[i]; word; word &= word - 1)
+                    fn((uint16_t)((i << 6) + __builtin_ctzll(word)));
+        }
+
+    };  // end of struct chunk_t
+
+    /** Chunk key getter */
+    struct key_fn {
+        inline const unsigned char * operator () (const chunk_t & c) const {
+            return c.key;
+        }
+    };  // end of struct key_fn
+
+    /** Chunk key length getter */
+    struct key_len_fn {
+        inline size_t operator () (const chunk_t &) const {
+            return key_len;
+        }
+    };  // end of struct key_len_fn
+
+    typedef container::trie<chunk_t, key_fn, key_len_fn> trie_t;
+
+    trie_t m_trie;  /**< Chunk TRIE         */
+    size_t m_size;  /**< Number of integers */
+
+    /** Chunk key (high bits, big endian) */
+    static void high_key(Int v, unsigned char key[key_len]) {
+        v >>= 16;
+        for (size_t i = key_len; i; --i, v >>= 8)
+            key[i - 1] = (unsigned char)v;
+    }
+
+    /** Chunk key order */
+    static int key_cmp(const chunk_t & c1, const chunk_t & c2) {
+        return ::memcmp(c1.key, c2.key, key_len);
+    }
+
+    /** Integer from chunk key and low bits */
+    static Int make_int(const chunk_t & c, uint16_t low) {
+        Int v = 0;
+        for (size_t i = 0; i < key_len; ++i)
+            v = (v << 8) | c.key[i];
+
+        return (v << 16) | low;
+    }
+
+    /** Throw unless the set is empty */
+    static void check_empty(const int_set & set) {
+        if (!set.empty())
+            throw std::logic_error(
+                "libtrie++: integer set operation result isn't empty");
+    }
+
+    /** Add (non-empty) chunk to the set */
+    void add_chunk(const chunk_t & c) {
+        m_trie.insert(c);
+        m_size += c.card;
+    }
+
+    /** Union of chunks with the same key */
+    static chunk_t chunk_union(const chunk_t & c1, const chunk_t & c2) {
+        chunk_t u(c1.key);
+
+        if (c1.is_bitmap() || c2.is_bitmap()) {
+            u = c1.is_bitmap() ? c1 : c2;
+            const chunk_t & o = c1.is_bitmap() ? c2 : c1;
+
+            if (o.is_bitmap())
+                for (size_t i = 0; i < bm_words; ++i)
+                    u.bitmap[i] |= o.bitmap[i];
+            else
+                for (uint16_t low: o.array)
+                    u.bitmap[low >> 6] |= (uint64_t)1 << (low & 0x3f);
+
+            u.bitmap_fixup();
+            return u;
+        }
+
+        u.array.reserve(c1.card + c2.card);
+        std::set_union(
+            c1.array.begin(), c1.array.end(),
+            c2.array.begin(), c2.array.end(),
+            std::back_inserter(u.array));
+
+        u.card = u.array.size();
+        if (u.card > array_max) u.to_bitmap();
+
+        return u;
+    }
+
+    /** Intersection of chunks with the same key */
+    static chunk_t chunk_intersection(const chunk_t & c1, const chunk_t & c2) {
+        chunk_t i(c1.key);
+
+        if (c1.is_bitmap() && c2.is_bitmap()) {
+            i.bitmap.resize(bm_words);
+            for (size_t w = 0; w < bm_words; ++w)
+                i.bitmap[w] = c1.bitmap[w] & c2.bitmap[w];
+
+            i.bitmap_fixup();
+            return i;
+        }
+
+        if (c1.is_bitmap() || c2.is_bitmap()) {
+            const chunk_t & a = c1.is_bitmap() ? c2 : c1;
+            const chunk_t & b = c1.is_bitmap() ? c1 : c2;
+
+            for (uint16_t low: a.array)
+                if (b.contains(low)) i.array.push_back(low);
+        }
+        else {
+            std::set_intersection(
+                c1.array.begin(), c1.array.end(),
+                c2.array.begin(), c2.array.end(),
+                std::back_inserter(i.array));
+        }
+
+        i.card = i.array.size();
+        return i;
+    }
+
+    public:
+
+    /** Constructor */
+    int_set(): m_size(0) {}
+
+    /** Number of integers */
+    inline size_t size() const { return m_size; }
+
+    /** Set is empty */
+    inline bool empty() const { return 0 == m_size; }
+
+    /** Number of chunks */
+    inline size_t chunks() const { return m_trie.size(); }
+
+    /**
+     *  \brief  Insert integer
+     *
+     *  \param  v  Integer
+     *
+     *  \return \c true iff the integer wasn't in the set
+     */
+    bool insert(Int v) {
+        unsigned char key[key_len];
+        high_key(v, key);
+
+        auto iter = m_trie.insert(chunk_t(key));
+        if (!std::get<2>(*iter).insert((uint16_t)v)) return false;
+
+        ++m_size;
+        return true;
+    }
+
+    /**
+     *  \brief  Membership test
+     *
+     *  \param  v  Integer
+     *
+     *  \return \c true iff the integer is in the set
+     */
+    bool contains(Int v) const {
+        unsigned char key[key_len];
+        high_key(v, key);
+
+        auto iter = m_trie.find(key, key_len);
+        return m_trie.end() != iter && std::get<2>(*iter).contains((uint16_t)v);
+    }
+
+    /**
+     *  \brief  Call \c fn for all integers in ascending order
+     *
+     *  \param  fn  Function (called with \c Int)
+     */
+    template <class Fn>
+    void for_each(Fn fn) const {
+        for (auto iter = m_trie.begin(); m_trie.end() != iter; ++iter) {
+            const chunk_t & c = std::get<2>(*iter);
+            c.for_each([&fn, &c](uint16_t low) { fn(make_int(c, low)); });
+        }
+    }
+
+    /**
+     *  \brief  Set union
+     *
+     *  \param  set1    1st set
+     *  \param  set2    2nd set
+     *  \param  result  Union of the sets (must be empty)
+     */
+    static void set_union(
+        const int_set & set1,
+        const int_set & set2,
+        int_set &       result)
+    {
+        check_empty(result);
+
+        const trie_t & t1 = set1.m_trie;
+        const trie_t & t2 = set2.m_trie;
+
+        auto i1 = t1.begin(), i2 = t2.begin();
+        while (t1.end() != i1 || t2.end() != i2) {
+            if (t2.end() == i2) {
+                result.add_chunk(std::get<2>(*i1)); ++i1;
+                continue;
+            }
+
+            if (t1.end() == i1) {
+                result.add_chunk(std::get<2>(*i2)); ++i2;
+                continue;
+            }
+
+            const chunk_t & c1 = std::get<2>(*i1);
+            const chunk_t & c2 = std::get<2>(*i2);
+
+            const int cmp = key_cmp(c1, c2);
+            if (cmp < 0) {
+                result.add_chunk(c1); ++i1;
+            }
+            else if (cmp > 0) {
+                result.add_chunk(c2); ++i2;
+            }
+            else {
+                result.add_chunk(chunk_union(c1, c2)); ++i1; ++i2;
+            }
+        }
+    }
+
+    /**
+     *  \brief  Set intersection
+     *
+     *  \param  set1    1st set
+     *  \param  set2    2nd set
+     *  \param  result  Intersection of the sets (must be empty)
+     */
+    static void set_intersection(
+        const int_set & set1,
+        const int_set & set2,
+        int_set &       result)
+    {
+        check_empty(result);
+
+        const trie_t & t1 = set1.m_trie;
+        const trie_t & t2 = set2.m_trie;
+
+        auto i1 = t1.begin(), i2 = t2.begin();
+        while (t1.end() != i1 && t2.end() != i2) {
+            const chunk_t & c1 = std::get<2>(*i1);
+            const chunk_t & c2 = std::get<2>(*i2);
+
+            const int cmp = key_cmp(c1, c2);
+            if (cmp < 0) {
+                ++i1;
+            }
+            else if (cmp > 0) {
+                ++i2;
+            }
+            else {
+                const chunk_t c = chunk_intersection(c1, c2);
+                if (c.card) result.add_chunk(c);
+                ++i1; ++i2;
+            }
+        }
+    }
+
+    /**
+     *  \brief  Set union (in place)
+     *
+     *  \param  set  Another set
+     *
+     *  \return \c *this
+     */
+    int_set & operator |= (const int_set & set) {
+        for (auto iter = set.m_trie.begin(); set.m_trie.end() != iter; ++iter) {
+            const chunk_t & c = std::get<2>(*iter);
+            chunk_t & u = std::get<2>(*m_trie.insert(chunk_t(c.key)));
+
+            m_size -= u.card;
+            u = chunk_union(u, c);
+            m_size += u.card;
+        }
+
+        return *this;
+    }
+
+};  // end of template class int_set
+
+}  // end of namespace container
+
+#endif  // end of #ifndef int_set_hxx
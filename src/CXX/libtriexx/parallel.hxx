@@ -0,0 +1,106 @@
+#ifndef parallel_hxx
+#define parallel_hxx
+
+/**
+ *  \file
+ *  \brief  Parallel job execution
+ *
+ *  \date   2026/10/19
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <cstddef>
+
+
+namespace container {
+
+namespace impl {
+
+/**
+ *  \brief  Run jobs in parallel
+ *
+ *  Jobs are taken by the threads in index order as they finish
+ *  the previous ones.
+ *  If a job throws, the jobs not yet taken are skipped and the first
+ *  exception is rethrown once all the threads are joined.
+ *  If a thread can't be created, the jobs are run by those already
+ *  running.
+ *
+ *  \param  threads  Number of threads (incl. the calling one)
+ *  \param  n        Number of jobs
+ *  \param  fn       Job (called with job index)
+ */
+template <class Fn>
+void parallel(size_t threads, size_t n, Fn fn) {
+    std::atomic<size_t> next(0);
+    std::exception_ptr  error;
+    std::mutex          error_mutex;
+
+    auto worker = [&next, n, &fn, &error, &error_mutex]() {
+        for (size_t i; (i = next++) < n; ) {
+            try { fn(i); }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+                next = n;  // skip the rest
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    try {
+        workers.reserve(threads);
+        for (size_t i = 1; i < threads; ++i)
+            workers.emplace_back(worker);
+    }
+    catch (...) {}  // run the jobs with fewer threads
+
+    worker();
+
+    for (auto & thread: workers) thread.join();
+
+    if (error) std::rethrow_exception(error);
+}
+
+}  // end of namespace impl
+
+}  // end of namespace container
+
+#endif  // end of #ifndef parallel_hxx
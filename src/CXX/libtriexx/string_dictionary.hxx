@@ -0,0 +1,299 @@
+#ifndef string_dictionary_hxx
+#define string_dictionary_hxx
+
+/**
+ *  \file
+ *  \brief  String dictionary (string interning with integer IDs)
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "trie.hxx"
+
+#include <vector>
+#include <tuple>
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include <cstring>
+
+
+namespace container {
+
+/**
+ *  \brief  String dictionary
+ *
+ *  Dictionary encoding of strings as dense integer IDs.
+ *  IDs are assigned on insertion in order of first occurrence,
+ *  starting with 0.
+ *  Keys are looked up in the underlying TRIE; IDs are translated
+ *  back to keys using a table of pointers to the TRIE items.
+ *
+ *  After bulk load, IDs may be renumbered so that their order matches
+ *  the key order (see \ref renumber).
+ *  Key ranges and prefixes are then mapped to ID ranges, so encoded
+ *  columns may be filtered on the IDs directly.
+ *  Appending keys in ascending order keeps the dictionary ordered.
+ *
+ *  Keys are traced strictly; slobby tracing could return ID of another
+ *  key.
+ *
+ *  \tparam  Id        ID type (unsigned integer)
+ *  \tparam  Features  TRIE optional features
+ */
+template <
+    typename Id       = uint32_t,
+    int      Features = 0>
+class string_dictionary {
+    public:
+
+    typedef Id id_t;  /**< ID type */
+
+    /** TRIE */
+    typedef string_trie<id_t, TRIE_KEY_TRACING_STRICT, Features> trie_t;
+
+    /** Invalid ID (key not found) */
+    static const id_t npos = (id_t)-1;
+
+    private:
+
+    typedef std::tuple<std::string, id_t> item_t;  /**< TRIE item */
+
+    trie_t                m_trie;     /**< Key -> ID TRIE             */
+    std::vector<item_t *> m_items;    /**< ID -> TRIE item table      */
+    bool                  m_ordered;  /**< IDs are in key order       */
+
+    /**
+     *  \brief  Key order comparison
+     *
+     *  \param  key1  1st key
+     *  \param  len1  1st key length
+     *  \param  key2  2nd key
+     *
+     *  \return \c true iff 1st key is greater than the 2nd one
+     */
+    static bool greater(
+        const unsigned char * key1, size_t len1,
+        const std::string &   key2)
+    {
+        const size_t len2 = key2.size();
+        const int cmp = ::memcmp(
+            key1, key2.data(), len1 < len2 ? len1 : len2);
+        return cmp > 0 || (0 == cmp && len1 > len2);
+    }
+
+    /**
+     *  \brief  ID of the item at iterator (or dictionary size at end)
+     *
+     *  \param  iter  TRIE iterator
+     *
+     *  \return ID
+     */
+    id_t iter2id(const typename trie_t::const_iterator & iter) const {
+        return m_trie.end() == iter
+            ? (id_t)m_items.size()
+            : std::get<1>(std::get<2>(*iter));
+    }
+
+    /** Throw unless IDs are ordered */
+    void check_ordered() const {
+        if (!m_ordered)
+            throw std::logic_error(
+                "libtrie++: string dictionary IDs aren't ordered");
+    }
+
+    public:
+
+    /** Constructor */
+    string_dictionary(): m_ordered(true) {}
+
+    /** Number of keys */
+    inline size_t size() const { return m_items.size(); }
+
+    /** IDs are in key order */
+    inline bool ordered() const { return m_ordered; }
+
+    /** Underlying TRIE getter */
+    inline const trie_t & trie() const { return m_trie; }
+
+    /**
+     *  \brief  Insert key (unless already present)
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *
+     *  \return Key ID
+     */
+    id_t insert(const unsigned char * key, size_t len) {
+        const id_t id = (id_t)m_items.size();
+        if (npos == id)
+            throw std::overflow_error(
+                "libtrie++: string dictionary ID overflow");
+
+        auto iter = m_trie.insert(
+            item_t(std::string((const char *)key, len), id));
+
+        item_t & item = std::get<2>(*iter);
+        if (m_trie.size() == m_items.size()) return std::get<1>(item);
+
+        // New key; IDs remain ordered if appended in order
+        if (m_ordered && !m_items.empty())
+            m_ordered = greater(key, len, std::get<0>(*m_items.back()));
+
+        m_items.push_back(&item);
+        return id;
+    }
+
+    /**
+     *  \brief  Insert key (unless already present)
+     *
+     *  \param  key  Key
+     *
+     *  \return Key ID
+     */
+    inline id_t insert(const std::string & key) {
+        return insert((const unsigned char *)key.data(), key.size());
+    }
+
+    /**
+     *  \brief  Get key ID
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *
+     *  \return Key ID or \ref npos if not found
+     */
+    id_t id_of(const unsigned char * key, size_t len) const {
+        auto iter = m_trie.find(key, len);
+        return m_trie.end() == iter ? npos : std::get<1>(std::get<2>(*iter));
+    }
+
+    /**
+     *  \brief  Get key ID
+     *
+     *  \param  key  Key
+     *
+     *  \return Key ID or \ref npos if not found
+     */
+    inline id_t id_of(const std::string & key) const {
+        return id_of((const unsigned char *)key.data(), key.size());
+    }
+
+    /**
+     *  \brief  Get key by ID
+     *
+     *  \param  id  Key ID (must be less than \ref size)
+     *
+     *  \return Key
+     */
+    inline const std::string & key_of(id_t id) const {
+        return std::get<0>(*m_items[id]);
+    }
+
+    /**
+     *  \brief  Renumber IDs in key order
+     *
+     *  \return Translation table (indexed by old ID, contains new ID)
+     */
+    std::vector<id_t> renumber() {
+        std::vector<id_t> old2new(m_items.size());
+
+        id_t id = 0;
+        for (auto iter = m_trie.begin(); m_trie.end() != iter; ++iter, ++id) {
+            item_t & item = std::get<2>(*iter);
+            old2new[std::get<1>(item)] = id;
+            std::get<1>(item) = id;
+            m_items[id] = &item;
+        }
+
+        m_ordered = true;
+        return old2new;
+    }
+
+    /**
+     *  \brief  ID range of keys in key range
+     *
+     *  The dictionary must be ordered (see \ref renumber).
+     *
+     *  \param  lo      Lower bound key (included)
+     *  \param  lo_len  Lower bound key length
+     *  \param  hi      Upper bound key (excluded)
+     *  \param  hi_len  Upper bound key length
+     *
+     *  \return ID range [first, last)
+     */
+    std::pair<id_t, id_t> id_range(
+        const unsigned char * lo, size_t lo_len,
+        const unsigned char * hi, size_t hi_len)
+    const {
+        check_ordered();
+
+        const id_t first = iter2id(m_trie.seek(lo, lo_len));
+        const id_t last  = iter2id(m_trie.seek(hi, hi_len));
+
+        return std::make_pair(first, last < first ? first : last);
+    }
+
+    /**
+     *  \brief  ID range of keys with a prefix
+     *
+     *  The dictionary must be ordered (see \ref renumber).
+     *
+     *  \param  prefix  Key prefix
+     *  \param  len     Key prefix length
+     *
+     *  \return ID range [first, last)
+     */
+    std::pair<id_t, id_t> prefix_id_range(
+        const unsigned char * prefix, size_t len)
+    const {
+        check_ordered();
+
+        auto range = m_trie.find_prefix(prefix, len);
+        const id_t first = iter2id(range.first);
+        return std::make_pair(first,
+            range.first == range.second ? first : iter2id(range.second));
+    }
+
+};  // end of template class string_dictionary
+
+template <typename Id, int Features>
+const typename string_dictionary<Id, Features>::id_t
+    string_dictionary<Id, Features>::npos;
+
+}  // end of namespace container
+
+#endif  // end of #ifndef string_dictionary_hxx
@@ -0,0 +1,251 @@
+#ifndef suffix_index_hxx
+#define suffix_index_hxx
+
+/**
+ *  \file
+ *  \brief  Generalised suffix index (substring search)
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "trie.hxx"
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+
+namespace container {
+
+/**
+ *  \brief  Generalised suffix index
+ *
+ *  All (non-empty) suffixes of source keys are stored in a TRIE;
+ *  its condensed paths refer to the source keys themselves, so the
+ *  structure is a (quad-bit) suffix tree of the key corpus.
+ *  Suffix items don't copy the keys, they point to the source key
+ *  storage (which never moves).
+ *  Equal suffixes of different sources share the TRIE item; their
+ *  sources are chained.
+ *
+ *  Substring search is a prefix search of the suffixes; its cost is
+ *  O(|s| + total suffix occurrences), i.e. every occurrence of the
+ *  substring in every source is visited (even if the source contains
+ *  it many times and is only reported once).
+ *
+ *  Sources are reported once per query using per-source query stamps
+ *  (so concurrent substring searches on one index aren't safe).
+ *
+ *  Construction inserts every suffix separately, i.e. it is quadratic
+ *  in key length (which is fine for keys, not for long texts).
+ */
+class suffix_index {
+    public:
+
+    typedef size_t id_t;  /**< Source key ID */
+
+    private:
+
+    /** Suffix (TRIE item) */
+    struct suffix_t {
+        const unsigned char * key;  /**< Suffix                        */
+        size_t                len;  /**< Suffix length                 */
+        size_t                occ;  /**< Occurrences chain head (ix.)  */
+
+        suffix_t(const unsigned char * _key, size_t _len, size_t _occ):
+            key(_key), len(_len), occ(_occ)
+        {}
+
+    };  // end of struct suffix_t
+
+    /** Suffix occurrence (chained) */
+    struct occurrence_t {
+        id_t   src;   /**< Source key ID                */
+        size_t next;  /**< Next occurrence (or \c npos) */
+    };  // end of struct occurrence_t
+
+    /** Suffix key getter */
+    struct key_fn {
+        inline const unsigned char * operator () (const suffix_t & s) const {
+            return s.key;
+        }
+    };  // end of struct key_fn
+
+    /** Suffix key length getter */
+    struct key_len_fn {
+        inline size_t operator () (const suffix_t & s) const {
+            return s.len;
+        }
+    };  // end of struct key_len_fn
+
+    typedef container::trie<suffix_t, key_fn, key_len_fn> trie_t;
+
+    static const size_t npos = (size_t)-1;  /**< Chain end */
+
+    std::deque<std::string>       m_sources;  /**< Source keys           */
+    std::vector<occurrence_t>     m_occs;     /**< Occurrences           */
+    trie_t                        m_trie;     /**< Suffix TRIE           */
+    mutable std::vector<uint32_t> m_seen;     /**< Source query stamps   */
+    mutable uint32_t              m_stamp;    /**< Current query stamp   */
+
+    public:
+
+    /** Constructor */
+    suffix_index(): m_stamp(0) {}
+
+    /** Number of source keys */
+    inline size_t size() const { return m_sources.size(); }
+
+    /** Number of distinct suffixes */
+    inline size_t suffixes() const { return m_trie.size(); }
+
+    /**
+     *  \brief  Source key getter
+     *
+     *  \param  id  Source key ID (must be less than \ref size)
+     *
+     *  \return Source key
+     */
+    inline const std::string & key(id_t id) const { return m_sources[id]; }
+
+    /**
+     *  \brief  Add source key
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *
+     *  \return Source key ID
+     */
+    id_t add(const unsigned char * key, size_t len) {
+        const id_t id = m_sources.size();
+        m_sources.emplace_back((const char *)key, len);
+        m_seen.push_back(0);
+
+        const unsigned char * src =
+            (const unsigned char *)m_sources.back().data();
+
+        for (size_t i = 0; i < len; ++i) {
+            const size_t occ = m_occs.size();
+            m_occs.push_back(occurrence_t());
+            m_occs.back().src = id;
+
+            auto iter = m_trie.insert(suffix_t(src + i, len - i, npos));
+            suffix_t & suffix = std::get<2>(*iter);
+
+            // Chain the occurrence (also for a new suffix)
+            m_occs.back().next = suffix.occ;
+            suffix.occ = occ;
+        }
+
+        return id;
+    }
+
+    /**
+     *  \brief  Add source key
+     *
+     *  \param  key  Key
+     *
+     *  \return Source key ID
+     */
+    inline id_t add(const std::string & key) {
+        return add((const unsigned char *)key.data(), key.size());
+    }
+
+    /**
+     *  \brief  Find source keys containing substring
+     *
+     *  Takes O(len + total suffix occurrences) time; the occurrences
+     *  counted are all suffixes prefixed by the substring, not just
+     *  the distinct source keys reported.
+     *
+     *  \param  str  Substring
+     *  \param  len  Substring length
+     *
+     *  \return IDs of source keys containing the substring
+     *          (unordered, each ID reported once)
+     */
+    std::vector<id_t> find_substring(
+        const unsigned char * str, size_t len)
+    const {
+        std::vector<id_t> ids;
+
+        // Empty substring is contained in every key
+        if (0 == len) {
+            for (id_t id = 0; id < m_sources.size(); ++id)
+                ids.push_back(id);
+
+            return ids;
+        }
+
+        // New query stamp (reset stamps on wrap-around)
+        if (0 == ++m_stamp) {
+            std::fill(m_seen.begin(), m_seen.end(), 0);
+            m_stamp = 1;
+        }
+
+        auto range = m_trie.find_prefix(str, len);
+        for (; range.first != range.second; ++range.first) {
+            size_t occ = std::get<2>(*range.first).occ;
+            for (; npos != occ; occ = m_occs[occ].next) {
+                const id_t src = m_occs[occ].src;
+                if (m_stamp == m_seen[src]) continue;
+
+                m_seen[src] = m_stamp;
+                ids.push_back(src);
+            }
+        }
+
+        return ids;
+    }
+
+    /**
+     *  \brief  Find source keys containing substring
+     *
+     *  \param  str  Substring
+     *
+     *  \return IDs of source keys containing the substring
+     */
+    inline std::vector<id_t> find_substring(const std::string & str) const {
+        return find_substring((const unsigned char *)str.data(), str.size());
+    }
+
+};  // end of class suffix_index
+
+}  // end of namespace container
+
+#endif  // end of #ifndef suffix_index_hxx
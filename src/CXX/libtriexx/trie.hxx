@@ -42,14 +42,26 @@
  */
 
 #include <list>
+#include <algorithm>
 #include <tuple>
+#include <utility>
 #include <string>
 #include <sstream>
 #include <memory>
+#include <functional>
+#include <vector>
+#include <queue>
+#include <atomic>
+#include <type_traits>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 
+#include "arena.hxx"
+#include "parallel.hxx"
+
 
 // TODO: This should go to io:: namespace or somewhere...
 /** Tuple serialiser */
@@ -116,6 +128,323 @@ class identity {
 
 };  // end of template class identity
 
+/**
+ *  \brief  Key fingerprint
+ *
+ *  16-bit FNV-1a hash of the key.
+ *
+ *  \param  key  Key
+ *  \param  len  Key length
+ *
+ *  \return Key fingerprint
+ */
+inline uint32_t fingerprint(const unsigned char * key, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= key[i];
+        hash *= 16777619u;
+    }
+
+    return 0xffff & (hash ^ (hash >> 16));
+}
+
+/**
+ *  \brief  Key hash
+ *
+ *  64-bit FNV-1a hash of the key.
+ *
+ *  \param  key  Key
+ *  \param  len  Key length
+ *
+ *  \return Key hash
+ */
+inline uint64_t hash64(const unsigned char * key, size_t len) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= key[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/**
+ *  \brief  Combine hash with a value
+ *
+ *  \param  hash   Hash
+ *  \param  value  Value
+ *
+ *  \return Combined hash
+ */
+inline uint64_t hash_mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 31;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    return hash ^ (hash >> 27);
+}
+
+/**
+ *  \brief  New version stamp
+ *
+ *  Stamps are unique (for all TRIEs in the process).
+ *
+ *  \return Version stamp
+ */
+inline uint64_t version_stamp() {
+    static std::atomic<uint64_t> counter(0);
+    return ++counter;
+}
+
+/** Node version stamp (disabled) */
+template <bool Enabled>
+class version_stamped {
+    public:
+
+    /** Version stamp getter */
+    inline uint64_t stamp() const { return 0; }
+
+    /** Version stamp setter */
+    inline void stamp(uint64_t) {}
+
+};  // end of template class version_stamped
+
+/** Node version stamp */
+template <>
+class version_stamped<true> {
+    private:
+
+    uint64_t m_stamp;  /**< Version stamp */
+
+    public:
+
+    /** Constructor (new stamp) */
+    version_stamped(): m_stamp(version_stamp()) {}
+
+    /** Version stamp getter */
+    inline uint64_t stamp() const { return m_stamp; }
+
+    /** Version stamp setter */
+    inline void stamp(uint64_t stamp) { m_stamp = stamp; }
+
+};  // end of template class version_stamped
+
+/** Node sub-tree hash (disabled) */
+template <bool Enabled>
+class merkle_hashed {
+    public:
+
+    /** Sub-tree hash is valid */
+    inline bool hash_valid() const { return false; }
+
+    /** Invalidate sub-tree hash */
+    inline void hash_invalidate() {}
+
+    /** Sub-tree hash getter */
+    inline uint64_t hash() const { return 0; }
+
+    /** Sub-tree hash setter */
+    inline void hash(uint64_t) const {}
+
+};  // end of template class merkle_hashed
+
+/** Node sub-tree hash (computed lazily) */
+template <>
+class merkle_hashed<true> {
+    private:
+
+    mutable uint64_t m_hash;   /**< Sub-tree hash                */
+    mutable bool     m_valid;  /**< Sub-tree hash is up to date  */
+
+    public:
+
+    /** Constructor (invalid hash) */
+    merkle_hashed(): m_hash(0), m_valid(false) {}
+
+    /** Sub-tree hash is valid */
+    inline bool hash_valid() const { return m_valid; }
+
+    /** Invalidate sub-tree hash */
+    inline void hash_invalidate() { m_valid = false; }
+
+    /** Sub-tree hash getter */
+    inline uint64_t hash() const { return m_hash; }
+
+    /** Sub-tree hash setter (validates the hash) */
+    inline void hash(uint64_t hash) const {
+        m_hash  = hash;
+        m_valid = true;
+    }
+
+};  // end of template class merkle_hashed
+
+/** Node access counter (disabled) */
+template <bool Enabled>
+class access_counted {
+    public:
+
+    /** Access count getter */
+    inline uint32_t hits() const { return 0; }
+
+    /** Access count setter */
+    inline void hits(uint32_t) {}
+
+    /** Count access */
+    inline void hit() const {}
+
+};  // end of template class access_counted
+
+/** Node access counter */
+template <>
+class access_counted<true> {
+    private:
+
+    mutable uint32_t m_hits;  /**< Access count */
+
+    public:
+
+    /** Constructor */
+    access_counted(): m_hits(0) {}
+
+    /** Access count getter */
+    inline uint32_t hits() const { return m_hits; }
+
+    /** Access count setter */
+    inline void hits(uint32_t hits) { m_hits = hits; }
+
+    /** Count access (saturating) */
+    inline void hit() const { m_hits += (uint32_t)~m_hits ? 1 : 0; }
+
+};  // end of template class access_counted
+
+/** Key access sampler (called with key and key length) */
+typedef std::function<void (const unsigned char *, size_t)> sampler_t;
+
+/** Key access sampling (disabled) */
+template <bool Enabled>
+class access_sampling {
+    public:
+
+    /** Sampler setter */
+    inline void sampler(const sampler_t &, size_t) {}
+
+    /** Sample key access */
+    inline void sample(const unsigned char *, size_t) const {}
+
+};  // end of template class access_sampling
+
+/** Key access sampling */
+template <>
+class access_sampling<true> {
+    private:
+
+    sampler_t      m_sampler;        /**< Key access sampler          */
+    size_t         m_sample_period;  /**< Sampling period (0: off)    */
+    mutable size_t m_sample_cnt;     /**< Accesses to the next sample */
+
+    public:
+
+    /** Constructor (sampling off) */
+    access_sampling(): m_sample_period(0), m_sample_cnt(0) {}
+
+    /** Sampler setter (every \c period-th access is sampled) */
+    inline void sampler(const sampler_t & fn, size_t period) {
+        m_sampler       = fn;
+        m_sample_period = fn ? period : 0;
+        m_sample_cnt    = m_sample_period;
+    }
+
+    /** Sample key access */
+    inline void sample(const unsigned char * key, size_t len) const {
+        if (0 == m_sample_period || --m_sample_cnt) return;
+
+        m_sample_cnt = m_sample_period;
+        m_sampler(key, len);
+    }
+
+};  // end of template class access_sampling
+
+/** Item hashing for sub-tree hashes (disabled) */
+template <typename T, bool Enabled>
+class item_hashing {
+    public:
+
+    /** Item hash function setter */
+    template <class Fn>
+    inline void item_hash(const Fn &) {}
+
+    /** Mix item hash to (sub-tree) hash */
+    inline uint64_t hash_item(uint64_t hash, const T &) const {
+        return hash;
+    }
+
+};  // end of template class item_hashing
+
+/** Item hashing for sub-tree hashes */
+template <typename T>
+class item_hashing<T, true> {
+    public:
+
+    /** Item hash function */
+    typedef std::function<uint64_t (const T &)> item_hash_t;
+
+    private:
+
+    item_hash_t m_item_hash;  /**< Item hash function (optional) */
+
+    public:
+
+    /** Item hash function setter */
+    inline void item_hash(const item_hash_t & fn) { m_item_hash = fn; }
+
+    /** Mix item hash to (sub-tree) hash (if set) */
+    inline uint64_t hash_item(uint64_t hash, const T & item) const {
+        return m_item_hash ? hash_mix(hash, m_item_hash(item)) : hash;
+    }
+
+};  // end of template class item_hashing
+
+/** Node access count sampling (disabled) */
+template <bool Enabled>
+class access_count_sampling {
+    public:
+
+    /** Counting period setter */
+    inline void count_period(size_t) {}
+
+    /** Lookup shall be counted */
+    inline bool count_access() const { return false; }
+
+};  // end of template class access_count_sampling
+
+/** Node access count sampling */
+template <>
+class access_count_sampling<true> {
+    private:
+
+    size_t         m_count_period;  /**< Access counting period (0: off) */
+    mutable size_t m_count_cnt;     /**< Lookups to the next counted one */
+
+    public:
+
+    /** Constructor (counting off) */
+    access_count_sampling(): m_count_period(0), m_count_cnt(0) {}
+
+    /** Counting period setter (every \c period-th lookup is counted) */
+    inline void count_period(size_t period) {
+        m_count_period = period;
+        m_count_cnt    = period;
+    }
+
+    /** Lookup shall be counted */
+    inline bool count_access() const {
+        if (0 == m_count_period || --m_count_cnt) return false;
+
+        m_count_cnt = m_count_period;
+        return true;
+    }
+
+};  // end of template class access_count_sampling
+
 /** Size in bytes */
 template <typename T>
 class size_of {
@@ -133,6 +462,20 @@ class size_of {
 enum {
     TRIE_KEY_TRACING_STRICT = 0,  /**< Strict TRIE key tracing */
     TRIE_KEY_TRACING_SLOBBY = 1,  /**< Slobby TRIE key tracing */
+
+    /** Slobby TRIE key tracing with verification threshold */
+    TRIE_KEY_TRACING_SLOBBY_THRESHOLD = 2,
+};  // end of enum
+
+/** TRIE optional features (flags, see \ref trie class documentation) */
+enum {
+    TRIE_FINGERPRINTS    = 0x01,  /**< Key fingerprints in item nodes */
+    TRIE_ACCESS_SAMPLING = 0x02,  /**< Key access sampling hook       */
+    TRIE_VERSION_STAMPS  = 0x04,  /**< Node version stamps (for diff) */
+    TRIE_MERKLE_HASHES   = 0x08,  /**< Sub-tree content hashes        */
+    TRIE_HUGE_PAGES      = 0x10,  /**< Huge page backed arenas        */
+    TRIE_ACCESS_COUNTS   = 0x20,  /**< Node access counts (relayout)  */
+    TRIE_SCAN_PREFETCH   = 0x40,  /**< Iterator prefetches sub-trees  */
 };  // end of enum
 
 
@@ -143,6 +486,7 @@ enum {
  *  \tparam  KeyFn       Key getter type
  *  \tparam  KeyLenFn    Key length getter type
  *  \tparam  KeyTracing  Key tracing mode (see below)
+ *  \tparam  Features    Optional features (see below)
  *
  *  IMPLEMENTATION NOTES:
  *  Note that the \c KeyFn and \c KeyLenFn functors are mutable.
@@ -168,24 +512,133 @@ enum {
  *  the condition possible to evaluate at compile time, reasonable compilers
  *  will omit the code altogether if slobby mode isn't used.
  *  The default is strict key tracing.
+ *
+ *  Slobby mode with verification threshold is a compromise between
+ *  the two; the key tail is skipped only if at least the threshold
+ *  quad-bits of the key were matched (and the leaf key length matches).
+ *  Otherwise, the tail is compared by \c memcmp.
+ *  Higher threshold means less false hits and more item key accesses
+ *  (see \ref slob_threshold).
+ *
+ *  Optional features are enabled by \c Features flags (also evaluated
+ *  at compile time):
+ *
+ *  \c TRIE_FINGERPRINTS: item nodes carry 16-bit fingerprint of the item key
+ *  (in otherwise unused bits of branch attributes, so no extra memory
+ *  is used).
+ *  Strict \ref find then descends by key quad-bits only (skipping
+ *  condensed paths comparison) and compares the fingerprints of the key
+ *  and the item node found before the item key is compared.
+ *  Most misses are therefore detected without touching item keys at all;
+ *  the price is hashing of the searched key.
+ *
+ *  \c TRIE_ACCESS_SAMPLING: every n-th key passed to \ref find or
+ *  \ref insert is passed to a sampler function (see \ref sampler),
+ *  e.g. a heavy hitters sketch.
+ *  Unless sampling is active, the overhead is a single test; sparse
+ *  sampling costs a counter decrement per access.
+ *  Note that the sampling counter is updated by (const) \ref find,
+ *  so concurrent lookups aren't safe while sampling.
+ *
+ *  \c TRIE_VERSION_STAMPS: nodes carry version stamps; modification
+ *  of the TRIE sets a new (process-wide unique) stamp to all nodes
+ *  on the path from the modified node to the root.
+ *  Copies of the TRIE (snapshots) keep the stamps, so \ref diff
+ *  skips sub-trees with equal stamps (they weren't changed since
+ *  the snapshot was made) and its cost is proportional to the changes.
+ *  Note that items modified in place (via iterator) must be marked
+ *  by \ref touch.
+ *
+ *  \c TRIE_MERKLE_HASHES: nodes cache hash of their sub-tree content
+ *  (item keys and item hashes, see \ref merkle_item_hash), i.e. the TRIE
+ *  is a Merkle tree.
+ *  Modification only invalidates the hashes on the path to the root;
+ *  they are re-computed on demand by \ref merkle_hash.
+ *  Replicas may then find their differences by comparing hashes of key
+ *  prefixes top-down, descending only into sub-trees with different
+ *  hashes.
+ *  Without the feature, \ref merkle_hash works, too, but each call
+ *  hashes the whole sub-tree (and item hashes aren't used).
+ *  Note that \ref merkle_hash updates the cached hashes, so it isn't
+ *  safe to call it concurrently.
+ *
+ *  \c TRIE_HUGE_PAGES: nodes and items are allocated from process-wide
+ *  arenas of 2 MiB chunks, backed by huge pages if possible
+ *  (reserved ones using \c MAP_HUGETLB or transparent ones using
+ *  \c madvise; normal pages are the fallback).
+ *  Large TRIEs then cause far less dTLB misses on lookups.
+ *  Arena memory is reused, but never returned to the system;
+ *  see \ref arena_stats.
+ *
+ *  \c TRIE_ACCESS_COUNTS: nodes count lookups that pass through them
+ *  (every n-th lookup is counted, see \ref access_counting).
+ *  \ref relayout then re-allocates the nodes hottest paths first, so that
+ *  the hot working set is packed in contiguous memory (and fits in caches
+ *  better).
+ *  Like access sampling, counting makes (const) lookups unsafe
+ *  to be run concurrently while active.
+ *
+ *  \c TRIE_SCAN_PREFETCH: iterators prefetch the sub-trees to be visited
+ *  next whenever they stop at an item (up to \ref scan_prefetch_subtrees
+ *  sub-tree roots and \ref scan_prefetch_children children of each
+ *  of them, see \c iterator_base::stop_at).
+ *  Ordered scans then don't stall on each child pointer (nodes aren't
+ *  allocated in key order, so they're mostly cache misses in large
+ *  TRIEs); the loads overlap with the processing of the items before.
  */
 template <
     typename T,
     class KeyFn      = impl::identity<T>,
     class KeyLenFn   = impl::size_of<T>,
-    int   KeyTracing = TRIE_KEY_TRACING_STRICT>
-class trie {
+    int   KeyTracing = TRIE_KEY_TRACING_STRICT,
+    int   Features   = 0>
+class trie:
+    private impl::access_sampling<0 != (Features & TRIE_ACCESS_SAMPLING)>,
+    private impl::item_hashing<T, 0 != (Features & TRIE_MERKLE_HASHES)>,
+    private impl::access_count_sampling<0 != (Features & TRIE_ACCESS_COUNTS)>
+{
     private:
 
+    /** Key access sampling */
+    typedef impl::access_sampling<0 != (Features & TRIE_ACCESS_SAMPLING)>
+        access_sampling_t;
+
+    /** Item hashing (for sub-tree hashes) */
+    typedef impl::item_hashing<T, 0 != (Features & TRIE_MERKLE_HASHES)>
+        item_hashing_t;
+
+    /** Node access count sampling */
+    typedef impl::access_count_sampling<0 != (Features & TRIE_ACCESS_COUNTS)>
+        access_count_sampling_t;
+
     mutable KeyFn    m_key_fn;      /**< Key getter        */
     mutable KeyLenFn m_key_len_fn;  /**< Key length getter */
 
-    typedef std::list<T> items_t;  /**< Item list */
+    public:
+
+    /** Number of upcoming sub-trees prefetched by iterators */
+    static const size_t scan_prefetch_subtrees = 2;
+
+    /** Number of children of upcoming interim nodes prefetched */
+    static const size_t scan_prefetch_children = 4;
+
+    private:
+
+    /** Item allocator */
+    typedef typename std::conditional<0 != (Features & TRIE_HUGE_PAGES),
+        impl::arena_allocator<T>, std::allocator<T> >::type item_alloc_t;
+
+    typedef std::list<T, item_alloc_t> items_t;  /**< Item list */
 
     items_t m_items;  /**< Item list */
 
     /** TRIE node */
-    struct node {
+    struct node:
+        impl::version_stamped<0 != (Features & TRIE_VERSION_STAMPS)>,
+        impl::merkle_hashed<0 != (Features & TRIE_MERKLE_HASHES)>,
+        impl::arena_allocated<node, 0 != (Features & TRIE_HUGE_PAGES)>,
+        impl::access_counted<0 != (Features & TRIE_ACCESS_COUNTS)>
+    {
         typename items_t::iterator item;    /**< Item                     */
         const unsigned char *      key;     /**< Item key                 */
         size_t                     qlen;    /**< Key path quad-bit length */
@@ -289,6 +742,15 @@ class trie {
             br_attrs |= (br_attrs_t)ix << 8;
         }
 
+        /** Item key fingerprint getter */
+        inline uint32_t fp() const { return br_attrs >> 16; }
+
+        /** Item key fingerprint setter */
+        inline void fp(uint32_t fprint) {
+            br_attrs &= (br_attrs_t)0xffff;
+            br_attrs |= (br_attrs_t)fprint << 16;
+        }
+
         /** Node is leaf */
         inline bool is_leaf() const { return br_1st() > br_last(); }
 
@@ -299,8 +761,17 @@ class trie {
 
     node m_root;  /**< Root node */
 
+    /** Slobby tracing verification threshold (matching quad-bits) */
+    size_t m_slob_qlen;
+
     public:
 
+    /** Key access sampler (called with key and key length) */
+    typedef impl::sampler_t sampler_t;
+
+    /** Item hash function (see \ref merkle_item_hash) */
+    typedef std::function<uint64_t (const T &)> item_hash_t;
+
     /**
      *  \brief  (Mis)match position specification
      *
@@ -369,6 +840,7 @@ class trie {
     const {
         const node * nod = &m_root;
         size_t qlen = 0;
+        const bool counted = this->count_access();
 
         for (size_t i = 0; i < len; ++i) {
             bool forward_branch = false;
@@ -398,6 +870,14 @@ class trie {
                     return position_t(const_cast<node *>(nod), len << 1, true);
                 }
 
+                if (TRIE_KEY_TRACING_SLOBBY_THRESHOLD == KeyTracing && slob &&
+                    nod->is_leaf())
+                {
+                    return slob_leaf(nod, key, len, i, qlen);
+                }
+
+                if (counted) nod->hit();
+
                 forward_branch = qlen > 0;  // branch 1/2 a byte ahead
                 qlen = nod->qlen - (i << 1);
             }
@@ -426,103 +906,662 @@ class trie {
     }
 
     /**
-     *  \brief  Get 1/2-byte from \c key at position \c qpos
+     *  \brief  Slobby tracing with verification threshold at leaf
      *
+     *  \param  nod   Leaf node
      *  \param  key   Key
-     *  \param  qpos  1/2-byte position
+     *  \param  len   Key length
+     *  \param  i     Current key byte index
+     *  \param  qlen  Branching quad-bit (0 or 1) in current key byte
      *
-     *  \return 1/2 byte at position \c qpos
+     *  \return Leaf position (match) or its parent position (mismatch)
      */
-    inline static size_t get_qpos(const unsigned char * key, size_t qpos) {
-        unsigned char byte = key[qpos / 2];
-        return qpos % 2 ? byte & 0x0f : byte >> 4;
+    position_t slob_leaf(
+        const node *          nod,
+        const unsigned char * key,
+        size_t                len,
+        size_t                i,
+        size_t                qlen)
+    const {
+        const position_t mismatch(
+            const_cast<node *>(nod->parent), (i << 1) + qlen, false);
+
+        if (nod->qlen != len << 1) return mismatch;
+
+        // Enough quad-bits matched (the branching one included)
+        if ((i << 1) + qlen + 1 < m_slob_qlen &&
+            0 != ::memcmp(nod->key + i, key + i, len - i))
+        {
+            return mismatch;
+        }
+
+        return position_t(const_cast<node *>(nod), len << 1, true);
     }
 
     /**
-     *  \brief  Insert node for a key
+     *  \brief  Bitwise nearest (or farthest) key descent
      *
-     *  \param  key   Key
-     *  \param  len   Key length
-     *  \param  nod   Current node
-     *  \param  qlen  Quad-bit position of key mismatch
+     *  At each branching node, the populated branch with the least
+     *  (or greatest) XOR of its quad-bit and the key's one is taken.
+     *  Quad-bits of condensed paths are shared by the whole sub-tree,
+     *  so the choice made at the most significant differing quad-bit
+     *  is final, provided that the branch contains a key of length
+     *  \c len; branches that don't (holding shorter or longer keys
+     *  only) are skipped.
      *
-     *  \return Position of inserted item
+     *  \param  nod  Sub-tree root
+     *  \param  key  Key
+     *  \param  len  Key length
+     *  \param  max  Maximise (or minimise) the XOR
+     *
+     *  \return Node reached (or \c NULL if there are no such keys)
      */
-    position_t insert_node(
+    const node * xor_descent(
+        const node *          nod,
         const unsigned char * key,
         size_t                len,
-        node *                nod,
-        size_t                qlen)
-    {
-        size_t br_ix   = get_qpos(key, nod->qlen);
-        node * br_node = nod->branches[br_ix].get();
-
-        // Create interim branch
-        if (NULL != br_node) {
-            size_t in_br_ix = get_qpos(br_node->key, qlen);
-            node * in_node  = new node(
-                m_items.end(), br_node->key, qlen, nod,
-                br_ix, in_br_ix, in_br_ix);
+        bool                  max)
+    const {
+        // Only longer keys in the sub-tree
+        if (nod->qlen > len << 1) return NULL;
 
-            in_node->branches[in_br_ix] = std::move(nod->branches[br_ix]);
-            in_node->branches[in_br_ix]->br_own(in_br_ix);
-            nod->branches[br_ix].reset(in_node);
-            br_node->parent = in_node;
+        if (nod->qlen == len << 1)
+            return m_items.end() != nod->item ? nod : NULL;
 
-            // Interim node shall carry item
-            if (qlen == (len << 1)) return position_t(in_node, qlen, false);
+        // Branches in order of the quad-bit XOR
+        const size_t qbits = get_qpos(key, nod->qlen);
+        for (size_t x = 0; x < 16; ++x) {
+            const node * br_node =
+                nod->branches[qbits ^ (max ? 15 - x : x)].get();
+            if (NULL == br_node) continue;
 
-            br_ix = get_qpos(key, qlen);
-            nod   = in_node;
+            const node * found = xor_descent(br_node, key, len, max);
+            if (NULL != found) return found;
         }
 
-        // Set 1st & last branch indices correctly (leaf has dummy indices)
-        if (nod->is_leaf())
-            nod->br_set(br_ix, br_ix);
-        else {
-            if (nod->br_1st()  > br_ix) nod->br_1st(br_ix);
-            if (nod->br_last() < br_ix) nod->br_last(br_ix);
-        }
+        return NULL;  // no key of the length in the sub-tree
+    }
 
-        // Create new leaf
-        // Note that the key SHAN'T be set, here.
-        // The reason is that it may not (and probably won't) reside
-        // at the same address after the item is inserted into the item list.
-        qlen = len << 1;
-        br_node = new node(m_items.end(), NULL, qlen, nod, br_ix);
-        nod->branches[br_ix].reset(br_node);
+    /** Export task (sub-tree or single node) */
+    struct export_task_t {
+        const node * nod;    /**< Node                          */
+        bool         whole;  /**< Whole sub-tree (or node only) */
+        size_t       items;  /**< Number of items               */
+        size_t       bytes;  /**< Key bytes                     */
 
-        return position_t(br_node, qlen, false);
-    }
+        export_task_t(const node * _nod, bool _whole):
+            nod(_nod), whole(_whole), items(0), bytes(0)
+        {}
+
+    };  // end of struct export_task_t
 
     /**
-     *  \brief  Insert new item at \c nod position
+     *  \brief  Visit sub-tree items in key order (depth-first)
      *
-     *  Note that the function DOES NOT check if there's already
-     *  an item set in the node.
-     *
-     *  \param  item  Item
-     *  \param  nod   TRIE node
+     *  \param  nod    Sub-tree root
+     *  \param  whole  Visit whole sub-tree (or the node item only)
+     *  \param  fn     Item visitor (called with \c const \c T \c &)
      */
-    void insert_item(const T & item, node * nod) {
-        m_items.push_back(item);
-        nod->key  = key(m_items.back());
-        nod->item = --m_items.end();
+    template <class Fn>
+    void visit(const node * nod, bool whole, Fn & fn) const {
+        if (m_items.end() != nod->item) fn(*nod->item);
+        if (!whole) return;
+
+        const size_t br_last = nod->br_last();
+        for (size_t ix = nod->br_1st(); ix <= br_last; ++ix) {
+            const node * br_node = nod->branches[ix].get();
+            if (NULL != br_node) visit(br_node, true, fn);
+        }
     }
 
     /**
-     *  \brief  Report key search position
-     *
-     *  \param  key   Key
-     *  \param  len   Key length
-     *  \param  nod   Current node
-     *  \param  qlen  Quad-bit position of key (mis)match
+     *  \brief  Export items of a task to flat arrays
      *
-     *  \return Node for the key specified
+     *  \param  task      Export task
+     *  \param  keys      Key bytes (at task's 1st key)
+     *  \param  offsets   Key offsets (at task's 1st item)
+     *  \param  values    Values (at task's 1st item)
+     *  \param  off       Task's 1st key offset
+     *  \param  value_fn  Item to value transformation
      */
-    position_t search_position(
-        const unsigned char * key,
-        size_t                len,
+    template <class Value, class ValueFn>
+    void export_task(
+        const export_task_t & task,
+        unsigned char *       keys,
+        size_t *              offsets,
+        Value *               values,
+        size_t                off,
+        ValueFn &             value_fn)
+    const {
+        auto fill = [&](const T & item) {
+            const size_t len = key_len(item);
+            ::memcpy(keys, key(item), len);
+            keys += len;
+
+            *offsets++ = off;
+            *values++  = value_fn(item);
+            off += len;
+        };
+
+        visit(task.nod, task.whole, fill);
+    }
+
+    /**
+     *  \brief  Mark path from node to root as modified
+     *
+     *  Sets new version stamp and invalidates sub-tree hashes (if enabled).
+     *
+     *  \param  nod  Modified node
+     */
+    inline static void mark_path(node * nod) {
+        if (!(Features & (TRIE_VERSION_STAMPS | TRIE_MERKLE_HASHES))) return;
+
+        // Note that new nodes (without valid hash) may have valid ancestors
+        const uint64_t stamp = version_stamp();
+        for (; NULL != nod; nod = nod->parent)
+            mark_node(nod, stamp);
+    }
+
+    /** New version stamp (if enabled) */
+    inline static uint64_t version_stamp() {
+        return Features & TRIE_VERSION_STAMPS ? impl::version_stamp() : 0;
+    }
+
+    /**
+     *  \brief  Mark node as modified
+     *
+     *  Sets version stamp and invalidates sub-tree hash (if enabled).
+     *
+     *  \param  nod    Modified node
+     *  \param  stamp  Version stamp
+     */
+    inline static void mark_node(node * nod, uint64_t stamp) {
+        nod->stamp(stamp);
+        nod->hash_invalidate();
+    }
+
+    /**
+     *  \brief  Remove (empty) leaf node
+     *
+     *  \param  nod  Leaf node (not root)
+     *
+     *  \return Parent node
+     */
+    static node * remove_leaf(node * nod) {
+        const size_t br_ix  = nod->br_own();
+        node *       parent = nod->parent;
+        parent->branches[br_ix].reset(NULL);
+
+        // Just removed parent's only son
+        if (parent->has_only_son()) parent->br_set(1, 0);
+
+        // There were more than 1 child
+        else {
+            // Removed the 1st son
+            if (parent->br_1st() == br_ix) {
+                size_t ix = br_ix + 1;
+                for (; NULL == parent->branches[ix].get(); ++ix);
+                parent->br_1st(ix);
+            }
+
+            // Removed the last son
+            else if (parent->br_last() == br_ix) {
+                size_t ix = br_ix - 1;
+                for (; NULL == parent->branches[ix].get(); --ix);
+                parent->br_last(ix);
+            }
+        }
+
+        return parent;
+    }
+
+    /**
+     *  \brief  Remove interim node with only son (son takes its place)
+     *
+     *  \param  nod  Interim node without item (not root)
+     *
+     *  \return Parent node
+     */
+    static node * remove_interim(node * nod) {
+        node * parent = nod->parent;
+        size_t br_ix  = nod->br_own();
+        auto & branch = parent->branches[br_ix];
+        branch = std::move(nod->branches[nod->br_1st()]);
+        branch->parent = parent;
+        branch->br_own(br_ix);
+        return parent;
+    }
+
+    /**
+     *  \brief  Invalidate sub-tree hashes
+     *
+     *  \param  nod  Sub-tree root
+     */
+    static void invalidate_subtree(node * nod) {
+        if (!(Features & TRIE_MERKLE_HASHES)) return;
+
+        nod->hash_invalidate();
+
+        const size_t br_last = nod->br_last();
+        for (size_t ix = nod->br_1st(); ix <= br_last; ++ix) {
+            node * br_node = nod->branches[ix].get();
+            if (NULL != br_node) invalidate_subtree(br_node);
+        }
+    }
+
+    /**
+     *  \brief  Sub-tree hash
+     *
+     *  Cached hash is used if valid (and enabled).
+     *
+     *  \param  nod  Sub-tree root
+     *
+     *  \return Sub-tree hash
+     */
+    uint64_t subtree_hash(const node * nod) const {
+        if (nod->hash_valid()) return nod->hash();
+
+        uint64_t hash = 0;
+        if (m_items.end() != nod->item) {
+            hash = impl::hash_mix(hash,
+                impl::hash64(nod->key, nod->qlen >> 1));
+
+            hash = item_hashing_t::hash_item(hash, *nod->item);
+        }
+
+        const size_t br_last = nod->br_last();
+        for (size_t ix = nod->br_1st(); ix <= br_last; ++ix) {
+            const node * br_node = nod->branches[ix].get();
+            if (NULL == br_node) continue;
+
+            hash = impl::hash_mix(hash, ix);
+            hash = impl::hash_mix(hash, subtree_hash(br_node));
+        }
+
+        // Non-empty sub-tree has non-zero hash
+        if (0 == hash) hash = 1;
+
+        nod->hash(hash);
+        return hash;
+    }
+
+    /**
+     *  \brief  Copy sub-tree (copy constructor implementation)
+     *
+     *  Items are copied to the item list in key order.
+     *
+     *  \param  dst   Destination node
+     *  \param  src   Source node
+     *  \param  orig  Source TRIE
+     */
+    void copy_subtree(node * dst, const node * src, const trie & orig) {
+        dst->qlen     = src->qlen;
+        dst->br_attrs = src->br_attrs;
+        dst->stamp(src->stamp());
+        if (src->hash_valid()) dst->hash(src->hash());
+
+        if (orig.m_items.end() != src->item) {
+            m_items.push_back(*src->item);
+            dst->item = --m_items.end();
+            dst->key  = key(*dst->item);
+        }
+
+        const size_t br_last = src->br_last();
+        for (size_t ix = src->br_1st(); ix <= br_last; ++ix) {
+            const node * src_br = src->branches[ix].get();
+            if (NULL == src_br) continue;
+
+            node * dst_br = new node(m_items.end(), NULL, 0, dst, ix);
+            dst->branches[ix].reset(dst_br);
+            copy_subtree(dst_br, src_br, orig);
+        }
+
+        // Interim node uses key of its descendant
+        if (m_items.end() == dst->item && NULL != src->key && !dst->is_leaf())
+            dst->key = dst->branches[dst->br_1st()]->key;
+    }
+
+    /**
+     *  \brief  Diff sub-trees
+     *
+     *  \param  a          Old TRIE
+     *  \param  na         Old sub-tree
+     *  \param  b          New TRIE
+     *  \param  nb         New sub-tree
+     *  \param  qlen       Quad-bits known to be shared by the sub-trees
+     *  \param  on_insert  Insert callback
+     *  \param  on_erase   Erase callback
+     *  \param  on_update  Update callback
+     */
+    template <class InsertFn, class EraseFn, class UpdateFn>
+    static void diff(
+        const trie & a, const node * na,
+        const trie & b, const node * nb,
+        size_t       qlen,
+        InsertFn &   on_insert,
+        EraseFn &    on_erase,
+        UpdateFn &   on_update)
+    {
+        // Shared prefix
+        const size_t qlen_min = na->qlen < nb->qlen ? na->qlen : nb->qlen;
+        for (; qlen < qlen_min; ++qlen)
+            if (get_qpos(na->key, qlen) != get_qpos(nb->key, qlen)) {
+                a.visit(na, true, on_erase);
+                b.visit(nb, true, on_insert);
+                return;
+            }
+
+        // Sub-trees with the same root position
+        if (na->qlen == nb->qlen) {
+            // Sub-tree wasn't changed since copy
+            // Note that node position never changes (sons of removed
+            // interim nodes only change parent), while stamps are shared
+            // by all nodes on modified path; hence the position check.
+            if ((Features & TRIE_VERSION_STAMPS) &&
+                na->stamp() == nb->stamp())
+            {
+                return;
+            }
+
+            const bool a_item = a.m_items.end() != na->item;
+            const bool b_item = b.m_items.end() != nb->item;
+
+            if (a_item && b_item) {
+                if (!(*na->item == *nb->item))
+                    on_update(*na->item, *nb->item);
+            }
+            else if (a_item)
+                on_erase(*na->item);
+            else if (b_item)
+                on_insert(*nb->item);
+
+            for (size_t ix = 0; ix < (1 << 4); ++ix) {
+                const node * a_br = na->branches[ix].get();
+                const node * b_br = nb->branches[ix].get();
+
+                if (NULL != a_br && NULL != b_br)
+                    diff(a, a_br, b, b_br, qlen + 1,
+                        on_insert, on_erase, on_update);
+                else if (NULL != a_br)
+                    a.visit(a_br, true, on_erase);
+                else if (NULL != b_br)
+                    b.visit(b_br, true, on_insert);
+            }
+
+            return;
+        }
+
+        // Old sub-tree root is shallower
+        if (na->qlen < nb->qlen) {
+            if (a.m_items.end() != na->item) on_erase(*na->item);
+
+            const size_t b_ix = get_qpos(nb->key, na->qlen);
+            for (size_t ix = 0; ix < (1 << 4); ++ix) {
+                const node * a_br = na->branches[ix].get();
+                if (NULL == a_br) continue;
+
+                if (ix == b_ix)
+                    diff(a, a_br, b, nb, qlen + 1,
+                        on_insert, on_erase, on_update);
+                else
+                    a.visit(a_br, true, on_erase);
+            }
+
+            if (NULL == na->branches[b_ix].get())
+                b.visit(nb, true, on_insert);
+
+            return;
+        }
+
+        // New sub-tree root is shallower
+        if (b.m_items.end() != nb->item) on_insert(*nb->item);
+
+        const size_t a_ix = get_qpos(na->key, nb->qlen);
+        for (size_t ix = 0; ix < (1 << 4); ++ix) {
+            const node * b_br = nb->branches[ix].get();
+            if (NULL == b_br) continue;
+
+            if (ix == a_ix)
+                diff(a, na, b, b_br, qlen + 1,
+                    on_insert, on_erase, on_update);
+            else
+                b.visit(b_br, true, on_insert);
+        }
+
+        if (NULL == nb->branches[a_ix].get())
+            a.visit(na, true, on_erase);
+    }
+
+    /**
+     *  \brief  Get 1/2-byte from \c key at position \c qpos
+     *
+     *  \param  key   Key
+     *  \param  qpos  1/2-byte position
+     *
+     *  \return 1/2 byte at position \c qpos
+     */
+    inline static size_t get_qpos(const unsigned char * key, size_t qpos) {
+        unsigned char byte = key[qpos / 2];
+        return qpos % 2 ? byte & 0x0f : byte >> 4;
+    }
+
+    /**
+     *  \brief  Compare keys quad-bits in range
+     *
+     *  \param  key1  1st key
+     *  \param  key2  2nd key
+     *  \param  from  1st compared quad-bit position
+     *  \param  to    Quad-bit position after the last compared one
+     *
+     *  \return \c true iff the quad-bits match
+     */
+    static bool qmatch(
+        const unsigned char * key1,
+        const unsigned char * key2,
+        size_t                from,
+        size_t                to)
+    {
+        if (from >= to) return true;
+
+        size_t i = from >> 1;
+        if (from & 1) {  // low 1/2 byte
+            if ((key1[i] ^ key2[i]) & 0x0f) return false;
+            ++i;
+        }
+
+        const size_t end = to >> 1;
+        if (i < end && 0 != ::memcmp(key1 + i, key2 + i, end - i))
+            return false;
+
+        return !(to & 1) || !((key1[end] ^ key2[end]) & 0xf0);
+    }
+
+    /**
+     *  \brief  Common prefix length of keys
+     *
+     *  \param  key1  1st key
+     *  \param  len1  1st key length
+     *  \param  key2  2nd key
+     *  \param  len2  2nd key length
+     *
+     *  \return Common prefix length (in bytes)
+     */
+    inline static size_t common_prefix(
+        const unsigned char * key1, size_t len1,
+        const unsigned char * key2, size_t len2)
+    {
+        const size_t len = len1 < len2 ? len1 : len2;
+        size_t i = 0;
+        while (i < len && key1[i] == key2[i]) ++i;
+        return i;
+    }
+
+    /**
+     *  \brief  Descend to son on key path
+     *
+     *  The son's condensed path is verified.
+     *
+     *  \param  nod   Node on the key path
+     *  \param  key   Key
+     *  \param  qlen  Key quad-bit length
+     *
+     *  \return Son on the key path or \c NULL if there's none
+     */
+    inline static node * path_son(
+        const node * nod, const unsigned char * key, size_t qlen)
+    {
+        node * son = nod->branches[get_qpos(key, nod->qlen)].get();
+
+        if (NULL == son || son->qlen > qlen ||
+            !qmatch(son->key, key, nod->qlen + 1, son->qlen))
+        {
+            return NULL;
+        }
+
+        return son;
+    }
+
+    /**
+     *  \brief  Fix node after batch erase (see \ref erase_many)
+     *
+     *  Sons of the node were already fixed.
+     *  Empty leaf and interim node with only son are removed;
+     *  other interim node gets key of its descendant.
+     *
+     *  \param  nod  Node (not root)
+     */
+    void erase_fixup(node * nod) {
+        if (m_items.end() != nod->item) return;
+
+        if (nod->is_leaf())
+            remove_leaf(nod);
+        else if (nod->has_only_son())
+            remove_interim(nod);
+        else
+            nod->key = nod->branches[nod->br_1st()]->key;
+    }
+
+    /**
+     *  \brief  Insert node for a key
+     *
+     *  \param  key   Key
+     *  \param  len   Key length
+     *  \param  nod   Current node
+     *  \param  qlen  Quad-bit position of key mismatch
+     *
+     *  \return Position of inserted item
+     */
+    position_t insert_node(
+        const unsigned char * key,
+        size_t                len,
+        node *                nod,
+        size_t                qlen)
+    {
+        size_t br_ix   = get_qpos(key, nod->qlen);
+        node * br_node = nod->branches[br_ix].get();
+
+        // Create interim branch
+        if (NULL != br_node) {
+            size_t in_br_ix = get_qpos(br_node->key, qlen);
+            node * in_node  = new node(
+                m_items.end(), br_node->key, qlen, nod,
+                br_ix, in_br_ix, in_br_ix);
+
+            in_node->branches[in_br_ix] = std::move(nod->branches[br_ix]);
+            in_node->branches[in_br_ix]->br_own(in_br_ix);
+            nod->branches[br_ix].reset(in_node);
+            br_node->parent = in_node;
+
+            // Interim node shall carry item
+            if (qlen == (len << 1)) return position_t(in_node, qlen, false);
+
+            br_ix = get_qpos(key, qlen);
+            nod   = in_node;
+        }
+
+        // Set 1st & last branch indices correctly (leaf has dummy indices)
+        if (nod->is_leaf())
+            nod->br_set(br_ix, br_ix);
+        else {
+            if (nod->br_1st()  > br_ix) nod->br_1st(br_ix);
+            if (nod->br_last() < br_ix) nod->br_last(br_ix);
+        }
+
+        // Create new leaf
+        // Note that the key SHAN'T be set, here.
+        // The reason is that it may not (and probably won't) reside
+        // at the same address after the item is inserted into the item list.
+        qlen = len << 1;
+        br_node = new node(m_items.end(), NULL, qlen, nod, br_ix);
+        nod->branches[br_ix].reset(br_node);
+
+        return position_t(br_node, qlen, false);
+    }
+
+    /**
+     *  \brief  Insert new item at \c nod position
+     *
+     *  Note that the function DOES NOT check if there's already
+     *  an item set in the node.
+     *
+     *  \param  item  Item
+     *  \param  nod   TRIE node
+     */
+    void insert_item(const T & item, node * nod) {
+        m_items.push_back(item);
+        nod->key  = key(m_items.back());
+        nod->item = --m_items.end();
+
+        if (Features & TRIE_FINGERPRINTS)
+            nod->fp(impl::fingerprint(nod->key, nod->qlen >> 1));
+    }
+
+    /**
+     *  \brief  Find item by key using fingerprints
+     *
+     *  Descends by key quad-bits only; the item key is compared
+     *  only if the fingerprints match.
+     *
+     *  \param  key  Item key
+     *  \param  len  Item key length
+     *
+     *  \return Item node or \c NULL if not found
+     */
+    const node * find_fingerprint(const unsigned char * key, size_t len)
+    const {
+        const uint32_t fprint = impl::fingerprint(key, len);
+        const size_t   qlen   = len << 1;
+        const node *   nod    = &m_root;
+        const bool     counted = this->count_access();
+
+        while (nod->qlen < qlen) {
+            nod = nod->branches[get_qpos(key, nod->qlen)].get();
+            if (NULL == nod) return NULL;
+            if (counted) nod->hit();
+        }
+
+        if (nod->qlen != qlen || m_items.end() == nod->item ||
+            nod->fp() != fprint || 0 != ::memcmp(nod->key, key, len))
+        {
+            return NULL;
+        }
+
+        return nod;
+    }
+
+    /**
+     *  \brief  Report key search position
+     *
+     *  \param  key   Key
+     *  \param  len   Key length
+     *  \param  nod   Current node
+     *  \param  qlen  Quad-bit position of key (mis)match
+     *
+     *  \return Node for the key specified
+     */
+    position_t search_position(
+        const unsigned char * key,
+        size_t                len,
         node *                nod,
         size_t                qlen)
     {
@@ -545,10 +1584,94 @@ class trie {
 
         private:
 
-        /** Move to the next valid node */
-        void next() {
+        /**
+         *  \brief  Stop at item node
+         *
+         *  With \c TRIE_SCAN_PREFETCH, roots of up to
+         *  \ref scan_prefetch_subtrees upcoming sub-trees (children
+         *  of the node, then next siblings of the node and of its
+         *  ancestors) are prefetched.
+         *  For interim roots (without item), up to
+         *  \ref scan_prefetch_children of their children are prefetched,
+         *  too (the roots were likely prefetched already by the previous
+         *  calls, so reading them is cheap).
+         *
+         *  Note that compilers consider prefetching free of side effects;
+         *  the prefetches are therefore issued here, where the iterator
+         *  is updated (a function only doing prefetches could be optimised
+         *  out as a whole).
+         *
+         *  \param  nod  Item node
+         */
+        void stop_at(node_t * nod) {
+            m_node = nod;
+
+            if (0 == (Features & TRIE_SCAN_PREFETCH)) return;
+
+            const auto items_end = m_trie.m_items.end();
+
+            const node_t * ahead[
+                scan_prefetch_subtrees * (1 + scan_prefetch_children)];
+            size_t ahead_cnt = 0;
+
+            size_t br_ix = nod->br_1st();
+            for (size_t subtrees = scan_prefetch_subtrees; 0 != subtrees; ) {
+                while (br_ix <= nod->br_last() &&
+                    NULL == nod->branches[br_ix].get()) ++br_ix;
+
+                // No more branches, continue with the next siblings
+                if (br_ix > nod->br_last()) {
+                    if (NULL == nod->parent) break;
+
+                    br_ix = nod->br_own() + 1;
+                    nod   = nod->parent;
+                    continue;
+                }
+
+                const node_t * root = nod->branches[br_ix++].get();
+                ahead[ahead_cnt++] = root;
+                --subtrees;
+
+                if (root->item != items_end) continue;
+
+                size_t children = scan_prefetch_children;
+                const size_t br_last = root->br_last();
+                for (size_t ix = root->br_1st();
+                     0 != children && ix <= br_last; ++ix)
+                {
+                    const node_t * child = root->branches[ix].get();
+                    if (NULL != child) {
+                        ahead[ahead_cnt++] = child;
+                        --children;
+                    }
+                }
+            }
+
+            // Prefetch all cache lines of the nodes (they aren't aligned)
+            for (size_t i = 0; i < ahead_cnt; ++i) {
+                const uintptr_t end  = (uintptr_t)ahead[i] + sizeof(node_t);
+                uintptr_t       line = (uintptr_t)ahead[i] & ~(uintptr_t)63;
+                for (; line < end; line += 64)
+                    __builtin_prefetch((const void *)line);
+            }
+        }
+
+        /**
+         *  \brief  Move to the next valid node
+         *
+         *  The node where the traversal turned around (i.e. the deepest
+         *  common ancestor of the original and the next node, or
+         *  the original node itself if the next one is in its sub-tree)
+         *  is reported; its key path is the key prefix the two nodes share.
+         *
+         *  \param  br_ix  Branch index to continue the descent from
+         *
+         *  \return Quad-bit length of the turnaround node key path
+         *          (0 at end)
+         */
+        size_t next(size_t br_ix) {
             const auto items_end = m_trie.m_items.end();
-            size_t br_ix = m_node->br_1st();
+            node_t *   turn      = m_node;
 
             for (;;) {
                 // Descend to depth
@@ -556,11 +1679,14 @@ class trie {
                     node_t * nod = m_node->branches[br_ix].get();
 
                     if (NULL != nod) {
-                        m_node = nod;
-                        if (m_node->item != items_end) return;  // got next
+                        if (nod->item != items_end) {  // got next
+                            stop_at(nod);
+                            return turn->qlen;
+                        }
 
                         // Interim node must have a child
-                        br_ix = m_node->br_1st();
+                        m_node = nod;
+                        br_ix  = m_node->br_1st();
                         continue;
                     }
 
@@ -572,14 +1698,27 @@ class trie {
                     br_ix = m_node->br_own() + 1;
 
                     m_node = m_node->parent;
-                    if (NULL == m_node) return;  // end
+                    if (NULL == m_node) return 0;  // end
 
                 } while (br_ix > m_node->br_last());
+
+                turn = m_node;
             }
         }
 
         protected:
 
+        /**
+         *  \brief  Move to the next valid node
+         *
+         *  \return Quad-bit length of the key prefix shared by the original
+         *          and the next node (0 at end)
+         */
+        inline size_t next() { return next(m_node->br_1st()); }
+
+        /** Move past the current node's sub-tree */
+        inline void skip() { next(1 << 4); }
+
         /**
          *  \brief  Constructor
          *
@@ -720,8 +1859,121 @@ class trie {
 
     };  // end of class iterator
 
+    /**
+     *  \brief  Front-coded const forward iterator
+     *
+     *  Iterates items in key order (just like \ref const_iterator),
+     *  but the keys are front-coded: the iterator dereferences to length
+     *  of the key prefix shared with the previous item key and the rest
+     *  of the key (suffix).
+     *  The shared prefix length is that of the node where the traversal
+     *  turned from the previous item to the current one, so no key bytes
+     *  are compared (sorted keys may be written front-coded directly).
+     *  The 1st item of the iteration shares no prefix.
+     */
+    class front_coded_iterator: public iterator_base<const trie, const node> {
+        friend class trie;
+
+        public:
+
+        /**
+         *  \brief  Iterator dereference
+         *
+         *  Tuple of {<shared_size>, <suffix>, <suffix_size>, <value>}
+         */
+        typedef std::tuple<size_t, const unsigned char *, size_t, const T &>
+            deref_t;
+
+        private:
+
+        size_t m_shared;  /**< Key prefix length shared with previous item */
+
+        /** Constructor (see \c iterator_base) */
+        front_coded_iterator(const trie & _trie, const node * _node = NULL):
+            iterator_base<const trie, const node>(_trie, _node),
+            m_shared(0)
+        {}
+
+        public:
+
+        /** Dereference */
+        inline deref_t operator * () const {
+            const size_t len = this->m_node->qlen >> 1;
+            return deref_t(
+                m_shared,
+                this->m_node->key + m_shared,
+                len - m_shared,
+                *(this->m_node->item));
+        }
+
+        /** Dereference */
+        inline deref_t operator -> () const { return **this; }
+
+        /** Pre-incrementation */
+        inline front_coded_iterator & operator ++ () {
+            m_shared = this->next() >> 1;
+            return *this;
+        }
+
+        /** Post-incrementation */
+        inline front_coded_iterator operator ++ (int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        /** Const iterator conversion */
+        operator const_iterator() const {
+            return const_iterator(this->m_trie, this->m_node);
+        }
+
+    };  // end of class front_coded_iterator
+
     private:
 
+    /**
+     *  \brief  Iterator past a (sub-)tree
+     *
+     *  \param  nod  (Sub-)tree root node
+     *
+     *  \return Iterator to the 1st item following the sub-tree in key order
+     */
+    const_iterator subtree_end(const node * nod) const {
+        const_iterator iter(*this);
+        iter.m_node = nod;
+        iter.skip();
+        return iter;
+    }
+
+    /**
+     *  \brief  Find root of a key prefix sub-tree
+     *
+     *  The sub-tree root is the shallowest node on the prefix path
+     *  which quad-bit length is not less than the prefix one.
+     *
+     *  \param  key   Prefix key
+     *  \param  qlen  Prefix quad-bit length
+     *
+     *  \return Sub-tree root node (or \c NULL if there's no such prefix)
+     */
+    const node * prefix_root(const unsigned char * key, size_t qlen) const {
+        const position_t pos = trace(
+            &trie::search_position, key, (qlen + 1) >> 1);
+
+        if (pos_qlen(pos) < qlen) return NULL;  // prefix mismatch
+
+        const node * nod = pos_node(pos);
+
+        // Prefix ends amid a condensed branch
+        if (nod->qlen < qlen)
+            return nod->branches[get_qpos(key, nod->qlen)].get();
+
+        while (NULL != nod->parent && nod->parent->qlen >= qlen)
+            nod = nod->parent;
+
+        return nod;
+    }
+
     /**
      *  \brief  Serialise (sub-)tree (implementation)
      *
@@ -880,57 +2132,222 @@ class trie {
         out.copyfmt(iostate);
     }
 
-    public:
+    public:
+
+    /**
+     *  \brief  Serialise tree
+     *
+     *  \param  out     Output stream
+     *  \param  indent  Indentation string
+     */
+    inline void serialise(
+        std::ostream      & out,
+        const std::string & indent = "")
+    const {
+        serialise(out, &m_root, indent);
+    }
+
+    /**
+     *  \brief  Serialise tree paths
+     *
+     *  \param  out     Output stream
+     *  \param  indent  Indentation string
+     */
+    inline void serialise_paths(
+        std::ostream      & out,
+        const std::string & indent = "")
+    const {
+        serialise_paths(out, &m_root, 0, indent);
+    }
+
+    /** Key getter */
+    inline const unsigned char * key(const T & inst) const {
+        return m_key_fn(inst);
+    }
+
+    /** Key length getter */
+    inline size_t key_len(const T & inst) const {
+        return m_key_len_fn(inst);
+    }
+
+    /** Default slobby tracing verification threshold (quad-bits) */
+    static const size_t slob_qlen_default = 32;
+
+    /** Constructor (default key functors) */
+    trie():
+        m_root(m_items.end(), NULL, 0, NULL, 0),
+        m_slob_qlen(slob_qlen_default)
+    {}
+
+    /**
+     *  \brief  Constructor
+     *
+     *  \param  key_fn      Key functor
+     *  \param  key_len_fn  Key length functor
+     */
+    trie(KeyFn key_fn, KeyLenFn key_len_fn):
+        m_key_fn(key_fn), m_key_len_fn(key_len_fn),
+        m_root(m_items.end(), NULL, 0, NULL, 0),
+        m_slob_qlen(slob_qlen_default)
+    {}
+
+    /**
+     *  \brief  Copy constructor (snapshot)
+     *
+     *  Node version stamps are copied (if enabled), see \ref diff.
+     *  Key access sampler isn't copied.
+     *
+     *  \param  orig  Original TRIE
+     */
+    trie(const trie & orig):
+        item_hashing_t(orig),
+        m_key_fn(orig.m_key_fn), m_key_len_fn(orig.m_key_len_fn),
+        m_root(m_items.end(), NULL, 0, NULL, 0),
+        m_slob_qlen(orig.m_slob_qlen)
+    {
+        copy_subtree(&m_root, &orig.m_root, orig);
+    }
+
+    /**
+     *  \brief  Set key access sampler
+     *
+     *  Only used with \c TRIE_ACCESS_SAMPLING feature.
+     *
+     *  \param  fn      Sampler
+     *  \param  period  Sampling period (every n-th access; 0 disables)
+     */
+    void sampler(const sampler_t & fn, size_t period = 1) {
+        access_sampling_t::sampler(fn, period);
+    }
+
+    /**
+     *  \brief  Set node access counting
+     *
+     *  Only used with \c TRIE_ACCESS_COUNTS feature.
+     *
+     *  \param  period  Counting period (every n-th lookup; 0 disables)
+     */
+    void access_counting(size_t period = 1) {
+        access_count_sampling_t::count_period(period);
+    }
 
     /**
-     *  \brief  Serialise tree
+     *  \brief  Re-allocate nodes in access frequency order
      *
-     *  \param  out     Output stream
-     *  \param  indent  Indentation string
+     *  Nodes are re-allocated hottest first; a node is placed once
+     *  its parent is, so hot paths are laid out contiguously and cold
+     *  sub-trees end up elsewhere.
+     *  All new nodes are allocated before the old ones are released,
+     *  so the layout isn't interleaved with the released memory
+     *  (the TRIE nodes take twice as much memory meanwhile).
+     *  Access counts are halved (so that the next relayout adapts
+     *  to changing access pattern).
+     *
+     *  Only does anything with \c TRIE_ACCESS_COUNTS feature.
+     *  NOTE: Invalidates all iterators.
      */
-    inline void serialise(
-        std::ostream      & out,
-        const std::string & indent = "")
-    const {
-        serialise(out, &m_root, indent);
+    void relayout() {
+        if (!(Features & TRIE_ACCESS_COUNTS)) return;
+
+        typedef std::pair<uint32_t, node *> hot_node_t;
+
+        std::priority_queue<hot_node_t> frontier;
+        std::vector<std::unique_ptr<node> > released;
+
+        auto push_sons = [&frontier](node * nod) {
+            const size_t br_last = nod->br_last();
+            for (size_t ix = nod->br_1st(); ix <= br_last; ++ix) {
+                node * br_node = nod->branches[ix].get();
+                if (NULL != br_node)
+                    frontier.push(hot_node_t(br_node->hits(), br_node));
+            }
+        };
+
+        push_sons(&m_root);
+        m_root.hits(m_root.hits() >> 1);
+
+        while (!frontier.empty()) {
+            node * nod = frontier.top().second;
+            frontier.pop();
+
+            node * copy = new node(
+                nod->item, nod->key, nod->qlen, nod->parent, 0);
+
+            copy->br_attrs = nod->br_attrs;
+            copy->stamp(nod->stamp());
+            if (nod->hash_valid()) copy->hash(nod->hash());
+            copy->hits(nod->hits() >> 1);
+
+            for (size_t ix = 0; ix < (1 << 4); ++ix) {
+                copy->branches[ix] = std::move(nod->branches[ix]);
+                if (NULL != copy->branches[ix].get())
+                    copy->branches[ix]->parent = copy;
+            }
+
+            auto & branch = copy->parent->branches[copy->br_own()];
+            released.push_back(std::move(branch));
+            branch.reset(copy);
+
+            push_sons(copy);
+        }
     }
 
     /**
-     *  \brief  Serialise tree paths
+     *  \brief  Set item hash function
      *
-     *  \param  out     Output stream
-     *  \param  indent  Indentation string
+     *  Item hashes are part of sub-tree hashes (see \ref merkle_hash),
+     *  so that replicas with different item values are told apart.
+     *  By default, only item keys are hashed.
+     *  Only used with \c TRIE_MERKLE_HASHES feature (without it,
+     *  the TRIE doesn't even keep the function).
+     *
+     *  \param  fn  Item hash function
      */
-    inline void serialise_paths(
-        std::ostream      & out,
-        const std::string & indent = "")
-    const {
-        serialise_paths(out, &m_root, 0, indent);
+    void merkle_item_hash(const item_hash_t & fn) {
+        item_hashing_t::item_hash(fn);
+        invalidate_subtree(&m_root);
     }
 
-    /** Key getter */
-    inline const unsigned char * key(const T & inst) const {
-        return m_key_fn(inst);
+    /**
+     *  \brief  Hash of items with a key prefix (quad-bit granularity)
+     *
+     *  Hashes of TRIEs with the same content are equal.
+     *  Empty sub-tree has hash 0; non-empty sub-tree hash is never 0.
+     *
+     *  \param  key   Prefix key
+     *  \param  qlen  Prefix quad-bit length
+     *
+     *  \return Hash of items with keys starting with the prefix
+     */
+    uint64_t merkle_hash(const unsigned char * key, size_t qlen) const {
+        const node * nod = prefix_root(key, qlen);
+        return NULL == nod ? 0 : subtree_hash(nod);
     }
 
-    /** Key length getter */
-    inline size_t key_len(const T & inst) const {
-        return m_key_len_fn(inst);
+    /** Hash of all items (see \ref merkle_hash) */
+    inline uint64_t merkle_hash() const {
+        return empty() ? 0 : subtree_hash(&m_root);
     }
 
-    /** Constructor (default key functors) */
-    trie(): m_root(m_items.end(), NULL, 0, NULL, 0) {}
+    /** Slobby tracing verification threshold getter (quad-bits) */
+    inline size_t slob_threshold() const { return m_slob_qlen; }
 
     /**
-     *  \brief  Constructor
+     *  \brief  Slobby tracing verification threshold setter
      *
-     *  \param  key_fn      Key functor
-     *  \param  key_len_fn  Key length functor
+     *  Only used by \c TRIE_KEY_TRACING_SLOBBY_THRESHOLD key tracing mode.
+     *  Key tails are only verified if less than \c qlen quad-bits
+     *  of the key were matched when a leaf is reached.
+     *
+     *  \param  qlen  Threshold (in quad-bits)
      */
-    trie(KeyFn key_fn, KeyLenFn key_len_fn):
-        m_key_fn(key_fn), m_key_len_fn(key_len_fn),
-        m_root(m_items.end(), NULL, 0, NULL, 0)
-    {}
+    inline void slob_threshold(size_t qlen) { m_slob_qlen = qlen; }
+
+    /** Number of items */
+    inline size_t size() const { return m_items.size(); }
+
+    /** Empty check */
+    inline bool empty() const { return m_items.empty(); }
 
     /** Begin iterator */
     inline iterator begin() { return iterator(*this, &m_root); }
@@ -948,6 +2365,30 @@ class trie {
         return const_iterator(*this);
     }
 
+    /** Front-coded begin iterator */
+    inline front_coded_iterator front_coded_begin() const {
+        return front_coded_iterator(*this, &m_root);
+    }
+
+    /** Front-coded end iterator */
+    inline front_coded_iterator front_coded_end() const {
+        return front_coded_iterator(*this);
+    }
+
+    /**
+     *  \brief  Front-coded iterator starting at an item
+     *
+     *  Allows front-coded iteration of a key range (see \ref seek)
+     *  or prefix; the 1st item shares no prefix.
+     *
+     *  \param  iter  Iterator
+     *
+     *  \return Front-coded iterator at the same item
+     */
+    inline front_coded_iterator front_coded(const const_iterator & iter) const {
+        return front_coded_iterator(*this, iter.get_node());
+    }
+
     /**
      *  \brief  Insert item (unless already exists)
      *
@@ -956,11 +2397,47 @@ class trie {
      *  \return Item iterator
      */
     iterator insert(const T & item) {
+        this->sample(key(item), key_len(item));
+
         position_t pos = trace(&trie::insert_node, key(item), key_len(item));
         node *     nod = pos_node(pos);
 
         // Another item may already use the key
-        if (!pos_match(pos)) insert_item(item, nod);
+        if (!pos_match(pos)) {
+            insert_item(item, nod);
+            mark_path(nod);
+        }
+
+        return iterator(*this, nod);
+    }
+
+    /**
+     *  \brief  Insert item or merge it with existing one (upsert)
+     *
+     *  The TRIE is traced only once; the item is either inserted
+     *  at the miss position or combined with the item that has
+     *  the same key in place.
+     *  The combiner mustn't change the item key.
+     *
+     *  \param  item      Item
+     *  \param  combiner  Combiner (called with \c T \c & existing item
+     *                    and \c const \c T \c & \c item)
+     *
+     *  \return Item iterator
+     */
+    template <class Combiner>
+    iterator insert_or_merge(const T & item, Combiner combiner) {
+        this->sample(key(item), key_len(item));
+
+        position_t pos = trace(&trie::insert_node, key(item), key_len(item));
+        node *     nod = pos_node(pos);
+
+        if (pos_match(pos))
+            combiner(*nod->item, item);
+        else
+            insert_item(item, nod);
+
+        mark_path(nod);
 
         return iterator(*this, nod);
     }
@@ -976,6 +2453,15 @@ class trie {
      *  \return Item iterator
      */
     const_iterator find(const unsigned char * key, size_t len) const {
+        this->sample(key, len);
+
+        if ((Features & TRIE_FINGERPRINTS) &&
+            TRIE_KEY_TRACING_STRICT == KeyTracing)
+        {
+            const node * nod = find_fingerprint(key, len);
+            return NULL == nod ? end() : const_iterator(*this, nod);
+        }
+
         position_t pos = trace(&trie::search_position, key, len, true);
 
         // Key mismatch
@@ -997,6 +2483,319 @@ class trie {
         return find(key(item), key_len(item));
     }
 
+    /**
+     *  \brief  Find items by batch of keys
+     *
+     *  Path of the previous key is kept; each key only climbs up
+     *  to the deepest node within its common prefix with the previous
+     *  key and descends from there (comparing only the condensed paths
+     *  beyond that node).
+     *  With sorted keys, the work is therefore proportional to the distinct
+     *  prefixes in the batch (rather than to the sum of key lengths).
+     *  Unsorted keys are found correctly, too (with less sharing).
+     *
+     *  NOTE: Strict key tracing is always used.
+     *
+     *  \param  keys   Keys
+     *  \param  lens   Key lengths
+     *  \param  n      Number of keys
+     *  \param  items  Items found (\c NULL for missing keys)
+     */
+    void find_sorted(
+        const unsigned char * const keys[],
+        const size_t                lens[],
+        size_t                      n,
+        std::vector<const T *> &    items)
+    const {
+        items.clear();
+        items.reserve(n);
+
+        // Path of nodes matching the previous key
+        std::vector<const node *> path(1, &m_root);
+        const unsigned char * prev = NULL;
+        size_t prev_len = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            const unsigned char * key  = keys[i];
+            const size_t          len  = lens[i];
+            const size_t          qlen = len << 1;
+
+            this->sample(key, len);
+
+            // Climb to the deepest node in common prefix with previous key
+            const size_t lcp = common_prefix(key, len, prev, prev_len);
+            while (path.back()->qlen > lcp << 1) path.pop_back();
+
+            // Descend from there
+            const node * nod = path.back();
+            while (nod->qlen < qlen) {
+                const node * son = path_son(nod, key, qlen);
+                if (NULL == son) break;
+
+                path.push_back(nod = son);
+            }
+
+            items.push_back(qlen == nod->qlen && m_items.end() != nod->item
+                ? &*nod->item : NULL);
+
+            prev     = key;
+            prev_len = len;
+        }
+    }
+
+    /**
+     *  \brief  Find items by batch of keys
+     *
+     *  See \ref find_sorted.
+     *
+     *  \param  keys   Keys (sorted for best performance)
+     *  \param  items  Items found (\c NULL for missing keys)
+     */
+    void find_sorted(
+        const std::vector<std::string> & keys,
+        std::vector<const T *> &         items)
+    const {
+        std::vector<const unsigned char *> key_ptrs;
+        std::vector<size_t>                key_lens;
+        key_ptrs.reserve(keys.size());
+        key_lens.reserve(keys.size());
+
+        for (const auto & key: keys) {
+            key_ptrs.push_back((const unsigned char *)key.data());
+            key_lens.push_back(key.size());
+        }
+
+        find_sorted(key_ptrs.data(), key_lens.data(), keys.size(), items);
+    }
+
+    /**
+     *  \brief  Find first item with key not less than \c key
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *
+     *  \return Item iterator (end iterator if all keys are less)
+     */
+    const_iterator seek(const unsigned char * key, size_t len) const {
+        const position_t pos  = trace(&trie::search_position, key, len);
+        const node *     nod  = pos_node(pos);
+        const size_t     qlen = pos_qlen(pos);
+
+        if (pos_match(pos)) return const_iterator(*this, nod);
+
+        // Branching node reached
+        if (qlen == nod->qlen) {
+            // Key is prefix of the whole sub-tree
+            if (qlen == len << 1) return const_iterator(*this, nod);
+
+            // 1st populated branch following the missing one
+            for (size_t ix = get_qpos(key, qlen) + 1; ix <= nod->br_last(); ++ix)
+                if (NULL != nod->branches[ix].get())
+                    return const_iterator(*this, nod->branches[ix].get());
+
+            return subtree_end(nod);
+        }
+
+        // Mismatch amid a condensed branch
+        const node * br_node = nod->branches[get_qpos(key, nod->qlen)].get();
+
+        if (qlen == len << 1 ||
+            get_qpos(key, qlen) < get_qpos(br_node->key, qlen))
+        {
+            return const_iterator(*this, br_node);  // whole branch is greater
+        }
+
+        return subtree_end(br_node);  // whole branch is less
+    }
+
+    /**
+     *  \brief  Find item with key maximising XOR with \c key
+     *
+     *  Intended for fixed-width (e.g. big-endian integer) keys;
+     *  items with keys of another length are ignored.
+     *  Complexity is linear in the key width if all keys are of the
+     *  same length; otherwise, sub-trees holding only shorter keys
+     *  may be searched in vain.
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *
+     *  \return Item iterator (end iterator if there's no key of \c len)
+     */
+    const_iterator max_xor(const unsigned char * key, size_t len) const {
+        const node * nod = xor_descent(&m_root, key, len, true);
+        return NULL == nod ? end() : const_iterator(*this, nod);
+    }
+
+    /**
+     *  \brief  Find item with key minimising XOR with \c key
+     *
+     *  That's the bitwise nearest key (with the longest common prefix
+     *  and the least difference in the following bits); the key itself
+     *  if present.
+     *  Intended for fixed-width keys, see \ref max_xor.
+     *
+     *  \param  key  Key
+     *  \param  len  Key length
+     *
+     *  \return Item iterator (end iterator if there's no key of \c len)
+     */
+    const_iterator min_xor(const unsigned char * key, size_t len) const {
+        const node * nod = xor_descent(&m_root, key, len, false);
+        return NULL == nod ? end() : const_iterator(*this, nod);
+    }
+
+    /**
+     *  \brief  Export items to flat arrays (in key order)
+     *
+     *  Keys are concatenated to \c keys; key \c i occupies bytes
+     *  [\c offsets[i], \c offsets[i+1]).
+     *  \c values[i] is the value of item \c i.
+     *  The arrays are resized (\c Value must be default-constructible),
+     *  their capacity may be reused.
+     *
+     *  With more threads, the TRIE is split to sub-trees (in key order,
+     *  more than the threads, to balance the load), sizes of their exports
+     *  are counted and the sub-trees are exported in parallel.
+     *  Key functors and \c value_fn are then called concurrently.
+     *  An exception thrown by \c value_fn is propagated once all
+     *  the threads finish (the arrays content is then unspecified).
+     *
+     *  \param  keys      Key bytes
+     *  \param  offsets   Key offsets (number of items + 1)
+     *  \param  values    Values
+     *  \param  value_fn  Item to value transformation
+     *  \param  threads   Number of threads
+     */
+    template <class Value, class ValueFn>
+    void export_sorted(
+        std::vector<unsigned char> & keys,
+        std::vector<size_t> &        offsets,
+        std::vector<Value> &         values,
+        ValueFn                      value_fn,
+        size_t                       threads = 1)
+    const {
+        std::vector<export_task_t> tasks(1, export_task_t(&m_root, true));
+
+        // Split to sub-trees (node items are separate tasks)
+        for (bool split = threads > 1; split && tasks.size() < 8 * threads; ) {
+            std::vector<export_task_t> subtasks;
+            split = false;
+
+            for (const export_task_t & task: tasks) {
+                const node * nod = task.nod;
+                if (!task.whole || nod->is_leaf()) {
+                    subtasks.push_back(task);
+                    continue;
+                }
+
+                if (m_items.end() != nod->item)
+                    subtasks.push_back(export_task_t(nod, false));
+
+                const size_t br_last = nod->br_last();
+                for (size_t ix = nod->br_1st(); ix <= br_last; ++ix)
+                    if (NULL != nod->branches[ix].get())
+                        subtasks.push_back(export_task_t(
+                            nod->branches[ix].get(), true));
+
+                split = true;
+            }
+
+            tasks.swap(subtasks);
+        }
+
+        // Task sizes
+        if (tasks.size() > 1) {
+            impl::parallel(threads, tasks.size(), [this, &tasks](size_t i) {
+                export_task_t & task = tasks[i];
+                auto count = [this, &task](const T & item) {
+                    ++task.items;
+                    task.bytes += key_len(item);
+                };
+
+                visit(task.nod, task.whole, count);
+            });
+        }
+        else {
+            tasks[0].items = m_items.size();
+            for (const T & item: m_items) tasks[0].bytes += key_len(item);
+        }
+
+        // Task 1st item indices and key offsets
+        std::vector<std::pair<size_t, size_t> > starts(tasks.size());
+        size_t items = 0, bytes = 0;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            starts[i] = std::make_pair(items, bytes);
+            items += tasks[i].items;
+            bytes += tasks[i].bytes;
+        }
+
+        keys.resize(bytes);
+        offsets.resize(items + 1);
+        values.resize(items);
+        offsets[items] = bytes;
+
+        impl::parallel(threads, tasks.size(), [&](size_t i) {
+            const size_t ix  = starts[i].first;
+            const size_t off = starts[i].second;
+
+            export_task(tasks[i],
+                keys.data() + off, offsets.data() + ix, values.data() + ix,
+                off, value_fn);
+        });
+    }
+
+    /**
+     *  \brief  Export items to flat arrays (in key order)
+     *
+     *  Items are copied as values, see \ref export_sorted.
+     *
+     *  \param  keys     Key bytes
+     *  \param  offsets  Key offsets (number of items + 1)
+     *  \param  values   Items
+     */
+    inline void export_sorted(
+        std::vector<unsigned char> & keys,
+        std::vector<size_t> &        offsets,
+        std::vector<T> &             values)
+    const {
+        export_sorted(keys, offsets, values,
+            [](const T & item) -> const T & { return item; });
+    }
+
+    /**
+     *  \brief  Find items with a key prefix (quad-bit granularity)
+     *
+     *  \param  key   Prefix key
+     *  \param  qlen  Prefix quad-bit length
+     *
+     *  \return Iterator range of items with keys starting with the prefix
+     */
+    std::pair<const_iterator, const_iterator> find_qprefix(
+        const unsigned char * key,
+        size_t                qlen)
+    const {
+        const node * nod = prefix_root(key, qlen);
+        if (NULL == nod) return std::make_pair(end(), end());
+
+        return std::make_pair(const_iterator(*this, nod), subtree_end(nod));
+    }
+
+    /**
+     *  \brief  Find items with a key prefix
+     *
+     *  \param  key  Prefix key
+     *  \param  len  Prefix length
+     *
+     *  \return Iterator range of items with keys starting with the prefix
+     */
+    inline std::pair<const_iterator, const_iterator> find_prefix(
+        const unsigned char * key,
+        size_t                len)
+    const {
+        return find_qprefix(key, len << 1);
+    }
+
     /**
      *  \brief  Transform position to iterator
      *
@@ -1037,12 +2836,14 @@ class trie {
                 "libtrie++: insert to already occupied position");
 
         node * nod = pos_node(pos);
-        const size_t qlen = pos_qlen(pos);
+        const size_t len = key_len(item);
 
-        if (qlen != nod->qlen)
-            nod = pos_node(insert_node(key(item), key_len(item), nod, qlen));
+        // Unless the position is an interim node for the key, insert node
+        if (nod->qlen != len << 1)
+            nod = pos_node(insert_node(key(item), len, nod, pos_qlen(pos)));
 
         insert_item(item, nod);
+        mark_path(nod);
         return iterator(*this, nod);
     }
 
@@ -1064,58 +2865,205 @@ class trie {
 
         ++iter;  // iterator is incremented
 
+        const unsigned char * erased_key = nod->key;
+
         // Remove item from item list
         m_items.erase(nod->item);
         nod->item = items_end;
 
         // Empty leaf node shall be removed
-        if (nod->is_leaf() && nod != &m_root) {
-            const size_t br_ix  = nod->br_own();
-            node *       parent = nod->parent;
-            parent->branches[br_ix].reset(NULL);
-
-            // Just removed parent's only son
-            if (parent->has_only_son()) parent->br_set(1, 0);
-
-            // There were more than 1 child
-            else {
-                // Removed the 1st son
-                if (parent->br_1st() == br_ix) {
-                    size_t ix = br_ix + 1;
-                    for (; NULL == parent->branches[ix].get(); ++ix);
-                    parent->br_1st(ix);
-                }
+        if (nod->is_leaf() && nod != &m_root) nod = remove_leaf(nod);
 
-                // Removed the last son
-                else if (parent->br_last() == br_ix) {
-                    size_t ix = br_ix - 1;
-                    for (; NULL == parent->branches[ix].get(); --ix);
-                    parent->br_last(ix);
-                }
+        // Interim node with only son shall be removed
+        if (nod->has_only_son() && items_end == nod->item && nod != &m_root)
+            nod = remove_interim(nod);
+
+        mark_path(nod);
+
+        // Interim nodes without value use key of their descendant
+        // (any will do); those using the erased key must be updated.
+        // Note that the ancestors may do so even above a node with value.
+        for (; nod != &m_root; nod = nod->parent)
+            if (items_end == nod->item && erased_key == nod->key)
+                nod->key = nod->branches[nod->br_1st()]->key;
+    }
+
+    /**
+     *  \brief  Erase item by key
+     *
+     *  NOTE: Strict key tracing is always used (slobby tracing could
+     *  erase another item if the key isn't present).
+     *
+     *  \param  key  Item key
+     *  \param  len  Item key length
+     *
+     *  \return \c true iff the item was erased
+     */
+    bool erase(const unsigned char * key, size_t len) {
+        const position_t pos = lower_bound(key, len);
+        if (!pos_match(pos)) return false;
+
+        iterator iter(*this, pos_node(pos));
+        erase(iter);
+        return true;
+    }
+
+    /**
+     *  \brief  Erase items by batch of keys
+     *
+     *  Keys are sorted; the TRIE is then traversed once for all
+     *  of them (see \ref find_sorted), so keys with common prefix share
+     *  the descent.
+     *  Items are removed as found; structural fix-ups (removal of empty
+     *  leaves, collapsing interim nodes with only son and interim node key
+     *  rewrites) are done once per affected node, when the traversal
+     *  leaves it (i.e. after its sub-tree was fixed).
+     *  Missing (and repeated) keys are ignored.
+     *
+     *  NOTE: Strict key tracing is always used.
+     *  NOTE: Invalidates iterators of the erased items.
+     *
+     *  \param  keys  Keys
+     *  \param  lens  Key lengths
+     *  \param  n     Number of keys
+     *
+     *  \return Number of erased items
+     */
+    size_t erase_many(
+        const unsigned char * const keys[],
+        const size_t                lens[],
+        size_t                      n)
+    {
+        // Sort keys
+        std::vector<size_t> order(n);
+        for (size_t i = 0; i < n; ++i) order[i] = i;
+
+        std::sort(order.begin(), order.end(),
+        [keys, lens](size_t i1, size_t i2) -> bool {
+            const size_t len = lens[i1] < lens[i2] ? lens[i1] : lens[i2];
+            const int    cmp = ::memcmp(keys[i1], keys[i2], len);
+            return cmp < 0 || (0 == cmp && lens[i1] < lens[i2]);
+        });
+
+        // Path of nodes matching the previous key (and modification flags)
+        typedef std::pair<node *, bool> path_node_t;
+        std::vector<path_node_t> path(1, path_node_t(&m_root, false));
+
+        const uint64_t stamp = version_stamp();
+
+        // Leave modified node (fix it up and mark its parent modified)
+        auto pop = [this, &path, stamp]() {
+            const path_node_t top = path.back();
+            path.pop_back();
+            if (!top.second) return;
+
+            path.back().second = true;
+            mark_node(top.first, stamp);
+            erase_fixup(top.first);
+        };
+
+        const unsigned char * prev = NULL;
+        size_t prev_len = 0;
+        size_t erased   = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            const unsigned char * key  = keys[order[i]];
+            const size_t          len  = lens[order[i]];
+            const size_t          qlen = len << 1;
+
+            // Climb to the deepest node in common prefix with previous key
+            const size_t lcp = common_prefix(key, len, prev, prev_len);
+            while (path.back().first->qlen > lcp << 1) pop();
+
+            // Descend from there
+            node * nod = path.back().first;
+            while (nod->qlen < qlen) {
+                node * son = path_son(nod, key, qlen);
+                if (NULL == son) break;
+
+                path.push_back(path_node_t(nod = son, false));
+            }
+
+            if (qlen == nod->qlen && m_items.end() != nod->item) {
+                m_items.erase(nod->item);
+                nod->item = m_items.end();
+                path.back().second = true;
+                ++erased;
             }
 
-            nod = parent;
+            prev     = key;
+            prev_len = len;
         }
 
-        // Interim node with only son shall be removed
-        if (nod->has_only_son() && items_end == nod->item && nod != &m_root) {
-            node * parent = nod->parent;
-            size_t br_ix  = nod->br_own();
-            auto & branch = parent->branches[br_ix];
-            branch = std::move(nod->branches[nod->br_1st()]);
-            branch->parent = parent;
-            branch->br_own(br_ix);
-            nod = parent;
+        while (path.size() > 1) pop();
+
+        if (path.back().second) {
+            mark_node(&m_root, stamp);
+            if (m_items.end() == m_root.item) m_root.key = NULL;
         }
 
-        // Interim node without value uses key of its descendant (any will do)
-        if (!nod->is_leaf() && items_end == nod->item && nod != &m_root) {
-            const unsigned char * key = nod->branches[nod->br_1st()]->key;
-            while (items_end == nod->item && nod != &m_root) {
-                nod->key = key;
-                nod = nod->parent;
-            }
+        return erased;
+    }
+
+    /**
+     *  \brief  Erase items by batch of keys
+     *
+     *  See \ref erase_many.
+     *
+     *  \param  keys  Keys
+     *
+     *  \return Number of erased items
+     */
+    size_t erase_many(const std::vector<std::string> & keys) {
+        std::vector<const unsigned char *> key_ptrs;
+        std::vector<size_t>                key_lens;
+        key_ptrs.reserve(keys.size());
+        key_lens.reserve(keys.size());
+
+        for (const auto & key: keys) {
+            key_ptrs.push_back((const unsigned char *)key.data());
+            key_lens.push_back(key.size());
         }
+
+        return erase_many(key_ptrs.data(), key_lens.data(), keys.size());
+    }
+
+    /**
+     *  \brief  Mark item as modified (in place)
+     *
+     *  Only necessary with \c TRIE_VERSION_STAMPS feature (see \ref diff)
+     *  or \c TRIE_MERKLE_HASHES feature (see \ref merkle_hash).
+     *
+     *  \param  iter  Item iterator
+     */
+    inline void touch(const iterator & iter) { mark_path(iter.get_node()); }
+
+    /**
+     *  \brief  Changeset between TRIEs
+     *
+     *  Reports items that must be inserted to, erased from and updated
+     *  in TRIE \c a to get TRIE \c b (in no particular order).
+     *  Items with the same key are compared by \c ==.
+     *
+     *  Both TRIEs are walked together; with \c TRIE_VERSION_STAMPS,
+     *  sub-trees not changed since \c b was copied from \c a (or vice
+     *  versa) are skipped.
+     *
+     *  \param  a          Old TRIE
+     *  \param  b          New TRIE
+     *  \param  on_insert  Insert callback (called with new item)
+     *  \param  on_erase   Erase callback (called with old item)
+     *  \param  on_update  Update callback (called with old and new item)
+     */
+    template <class InsertFn, class EraseFn, class UpdateFn>
+    static void diff(
+        const trie & a,
+        const trie & b,
+        InsertFn     on_insert,
+        EraseFn      on_erase,
+        UpdateFn     on_update)
+    {
+        diff(a, &a.m_root, b, &b.m_root, 0, on_insert, on_erase, on_update);
     }
 
 };  // end of template class trie
@@ -1203,8 +3151,12 @@ class string_size {
  *
  *  \tparam  T           Value type
  *  \tparam  KeyTracing  Key tracing mode
+ *  \tparam  Features    Optional features
  */
-template <typename T, int KeyTracing = TRIE_KEY_TRACING_STRICT>
+template <
+    typename T,
+    int KeyTracing = TRIE_KEY_TRACING_STRICT,
+    int Features   = 0>
 class string_trie: public trie<
     std::tuple<std::string, T>,
     impl::fn_concat<
@@ -1213,7 +3165,8 @@ class string_trie: public trie<
     impl::fn_concat<
         impl::get<0, std::tuple<std::string, T> >,
         impl::string_size>,
-    KeyTracing>
+    KeyTracing,
+    Features>
 {};  // end of template class string_trie
 
 }  // end of namespace container
@@ -1221,10 +3174,11 @@ class string_trie: public trie<
 
 // TODO: This should go to io:: namespace or somewhere...
 /** Trie serialisation */
-template <typename T, class KeyFn, class KeyLenFn, int KeyTracing>
+template <
+    typename T, class KeyFn, class KeyLenFn, int KeyTracing, int Features>
 std::ostream & operator << (
     std::ostream & out,
-    const container::trie<T, KeyFn, KeyLenFn, KeyTracing> & trie)
+    const container::trie<T, KeyFn, KeyLenFn, KeyTracing, Features> & trie)
 {
     trie.serialise(out);
     return out;
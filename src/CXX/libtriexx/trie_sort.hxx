@@ -0,0 +1,283 @@
+#ifndef trie_sort_hxx
+#define trie_sort_hxx
+
+/**
+ *  \file
+ *  \brief  TRIE sort (MSD radix sort with deduplication)
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vector>
+#include <string>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+
+
+namespace container {
+
+namespace impl {
+
+/** TRIE sort entry */
+struct sort_entry {
+    const unsigned char * key;  /**< Key        */
+    size_t                len;  /**< Key length */
+    size_t                ix;   /**< Item index */
+};  // end of struct sort_entry
+
+/**
+ *  \brief  TRIE sort bucket of entry
+ *
+ *  Buckets match TRIE node branches, except for bucket 0 which
+ *  contains keys ending at the node (these go first).
+ *
+ *  \param  entry  Sort entry
+ *  \param  qpos   Quad-bit position
+ *
+ *  \return Bucket index (0 for key end, 1 + quad-bit value otherwise)
+ */
+inline size_t sort_bucket(const sort_entry & entry, size_t qpos) {
+    if (entry.len << 1 == qpos) return 0;
+
+    unsigned char byte = entry.key[qpos / 2];
+    return 1 + (qpos % 2 ? byte & 0x0f : byte >> 4);
+}
+
+/**
+ *  \brief  Sort small bucket by comparison (deduplicated)
+ *
+ *  Insertion sort is used (stable, so that the 1st occurrence
+ *  of a key is kept).
+ *
+ *  \param  a     Entries
+ *  \param  n     Number of entries
+ *  \param  qpos  Quad-bit position (entries share the key prefix)
+ *  \param  out   Sorted unique items indices
+ */
+inline void sort_small(
+    sort_entry *          a,
+    size_t                n,
+    size_t                qpos,
+    std::vector<size_t> & out)
+{
+    const size_t off = qpos / 2;
+
+    auto less = [off](const sort_entry & e1, const sort_entry & e2) -> bool {
+        const size_t len1 = e1.len - off;
+        const size_t len2 = e2.len - off;
+        const int cmp = ::memcmp(
+            e1.key + off, e2.key + off, len1 < len2 ? len1 : len2);
+        return cmp < 0 || (0 == cmp && len1 < len2);
+    };
+
+    for (size_t i = 1; i < n; ++i) {
+        sort_entry entry = a[i];
+
+        size_t j = i;
+        for (; j && less(entry, a[j - 1]); --j)
+            a[j] = a[j - 1];
+
+        a[j] = entry;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        if (0 == i || less(a[i - 1], a[i])) out.push_back(a[i].ix);
+}
+
+/**
+ *  \brief  Common key prefix length of entries
+ *
+ *  \param  a     Entries
+ *  \param  n     Number of entries
+ *  \param  qpos  Quad-bit position (entries share the key prefix)
+ *
+ *  \return Common key prefix length in quad-bits
+ */
+inline size_t common_qlen(const sort_entry * a, size_t n, size_t qpos) {
+    const unsigned char * key = a[0].key;
+    size_t qlen = a[0].len << 1;
+
+    for (size_t i = 1; i < n && qpos < qlen; ++i) {
+        const unsigned char * key_i = a[i].key;
+        const size_t len = a[i].len << 1 < qlen ? a[i].len << 1 : qlen;
+
+        // Compare whole bytes, then the high quad-bit
+        size_t j = qpos / 2;
+        while ((j + 1) << 1 <= len && key[j] == key_i[j]) ++j;
+
+        size_t q = j << 1;
+        if (q < len && !((key[j] ^ key_i[j]) & 0xf0)) ++q;
+
+        qlen = q < qpos ? qpos : q;
+    }
+
+    return qlen;
+}
+
+/**
+ *  \brief  MSD radix sort by quad-bits (deduplicated)
+ *
+ *  Entries are partitioned exactly like TRIE node branches.
+ *  Quad-bits shared by all entries are skipped without moving
+ *  the entries (like condensed TRIE paths).
+ *  Keys ending at a node are all equal, so only the 1st is kept.
+ *
+ *  \param  a          Entries
+ *  \param  b          Scratch space (of the same size)
+ *  \param  n          Number of entries
+ *  \param  qpos       Quad-bit position (entries share the key prefix)
+ *  \param  out        Sorted unique items indices
+ *  \param  small_max  Max. size of bucket sorted by comparison
+ */
+inline void radix_sort(
+    sort_entry *          a,
+    sort_entry *          b,
+    size_t                n,
+    size_t                qpos,
+    std::vector<size_t> & out,
+    size_t                small_max = 32)
+{
+    for (;;) {
+        if (n <= small_max) {
+            sort_small(a, n, qpos, out);
+            return;
+        }
+
+        size_t cnt[17] = { 0 };
+        for (size_t i = 0; i < n; ++i)
+            ++cnt[sort_bucket(a[i], qpos)];
+
+        // Shared quad-bit, skip the whole common prefix
+        const size_t bucket = sort_bucket(a[0], qpos);
+        if (0 != bucket && n == cnt[bucket]) {
+            qpos = common_qlen(a, n, qpos + 1);
+            continue;
+        }
+
+        size_t offset[17];
+        offset[0] = 0;
+        for (size_t i = 1; i < 17; ++i)
+            offset[i] = offset[i - 1] + cnt[i - 1];
+
+        for (size_t i = 0; i < n; ++i)
+            b[offset[sort_bucket(a[i], qpos)]++] = a[i];
+
+        if (cnt[0]) out.push_back(b[0].ix);
+
+        for (size_t i = 1, begin = cnt[0]; i < 17; begin += cnt[i++])
+            if (cnt[i])
+                radix_sort(b + begin, a + begin, cnt[i], qpos + 1,
+                    out, small_max);
+
+        return;
+    }
+}
+
+}  // end of namespace impl
+
+
+/**
+ *  \brief  TRIE sort
+ *
+ *  Sorts items by their keys and removes duplicates, like
+ *  \c std::sort followed by \c std::unique (except that 1st
+ *  occurrence of a key is kept).
+ *  Items are partitioned by key quad-bits the same way TRIE nodes are,
+ *  i.e. MSD radix sort is done; the structure is never materialised,
+ *  entries live in a single scratch arena that is released at once.
+ *
+ *  \param  first    Items begin
+ *  \param  last     Items end
+ *  \param  key      Item key getter
+ *  \param  key_len  Item key length getter
+ *
+ *  \return End of the sorted unique items
+ */
+template <class RandomIter, class KeyFn, class KeyLenFn>
+RandomIter trie_sort(
+    RandomIter first,
+    RandomIter last,
+    KeyFn      key,
+    KeyLenFn   key_len)
+{
+    typedef typename std::iterator_traits<RandomIter>::value_type value_t;
+
+    const size_t n = last - first;
+    std::vector<size_t> order; order.reserve(n);
+
+    {  // scratch arena scope
+        std::vector<impl::sort_entry> arena(2 * n);
+        for (size_t i = 0; i < n; ++i) {
+            impl::sort_entry & entry = arena[i];
+            entry.key = key(first[i]);
+            entry.len = key_len(first[i]);
+            entry.ix  = i;
+        }
+
+        impl::radix_sort(arena.data(), arena.data() + n, n, 0, order);
+    }
+
+    std::vector<value_t> sorted; sorted.reserve(order.size());
+    for (size_t ix: order)
+        sorted.push_back(std::move(first[ix]));
+
+    return std::move(sorted.begin(), sorted.end(), first);
+}
+
+/**
+ *  \brief  TRIE sort of strings
+ *
+ *  \param  first  Strings begin
+ *  \param  last   Strings end
+ *
+ *  \return End of the sorted unique strings
+ */
+template <class RandomIter>
+RandomIter trie_sort(RandomIter first, RandomIter last) {
+    return trie_sort(first, last,
+    [](const std::string & str) -> const unsigned char * {
+        return (const unsigned char *)str.data();
+    },
+    [](const std::string & str) -> size_t {
+        return str.size();
+    });
+}
+
+}  // end of namespace container
+
+#endif  // end of #ifndef trie_sort_hxx
@@ -0,0 +1,279 @@
+#ifndef value_pool_hxx
+#define value_pool_hxx
+
+/**
+ *  \file
+ *  \brief  Interned (deduplicated) value pool
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+
+namespace container {
+
+/**
+ *  \brief  Interned value pool
+ *
+ *  Keeps a single copy of each distinct value; values are interned
+ *  by \ref intern, which produces a \ref handle to the pooled copy.
+ *  Handles are reference counted (the pooled value is dropped when
+ *  the last handle to it is destroyed) and only take a pointer
+ *  of memory, so TRIE items (e.g. of \c string_trie<pool_t::handle>)
+ *  mapping many keys to few distinct values take memory proportional
+ *  to the number of the distinct values rather than the number of keys.
+ *  Handles of equal values are equal pointers; comparing them doesn't
+ *  touch the values at all.
+ *
+ *  Pooled values are immutable (shared by all keys referring to them);
+ *  to change value of a key, intern the new value and replace the handle.
+ *
+ *  Values are indexed by their hash; equal values must have equal
+ *  hashes.
+ *  The pool may be destroyed before the handles; the remaining values
+ *  are then detached from it and dropped with their last handles.
+ *  Note that neither the pool nor the handles are thread-safe
+ *  (reference counts aren't atomic), just like the TRIE itself.
+ *
+ *  \tparam  V      Value type
+ *  \tparam  Hash   Value hash function
+ *  \tparam  Equal  Value equality
+ */
+template <
+    typename V,
+    class    Hash  = std::hash<V>,
+    class    Equal = std::equal_to<V> >
+class value_pool {
+    public:
+
+    typedef V value_t;  /**< Value type */
+
+    private:
+
+    /** Pooled value */
+    struct entry {
+        const V      value;  /**< Value                          */
+        const size_t hash;   /**< Value hash                     */
+        size_t       refs;   /**< Handle count                   */
+        value_pool * pool;   /**< Owner pool (0 if detached)     */
+
+        /** Constructor */
+        template <typename U>
+        entry(U && _value, size_t _hash, value_pool * _pool):
+            value(std::forward<U>(_value)),
+            hash(_hash),
+            refs(0),
+            pool(_pool)
+        {}
+
+    };  // end of struct entry
+
+    /** Hash to values index */
+    typedef std::unordered_multimap<size_t, entry *> index_t;
+
+    Hash    m_hash;   /**< Hash function */
+    Equal   m_equal;  /**< Equality      */
+    index_t m_index;  /**< Value index   */
+
+    /**
+     *  \brief  Drop reference to pooled value
+     *
+     *  The value is removed from the pool and destroyed with its last
+     *  reference.
+     *
+     *  \param  ent  Pooled value (may be 0)
+     */
+    static void release(entry * ent) {
+        if (!ent || 0 != --ent->refs) return;
+
+        if (ent->pool) {
+            auto range = ent->pool->m_index.equal_range(ent->hash);
+            for (; range.first != range.second; ++range.first)
+                if (range.first->second == ent) {
+                    ent->pool->m_index.erase(range.first);
+                    break;
+                }
+        }
+
+        delete ent;
+    }
+
+    public:
+
+    /**
+     *  \brief  Interned value handle
+     *
+     *  Handles are compared by the pooled value addresses;
+     *  default handle refers to no value.
+     */
+    class handle {
+        friend class value_pool;
+
+        private:
+
+        entry * m_entry;  /**< Pooled value */
+
+        /** Constructor (of handle to pooled value) */
+        explicit handle(entry * ent): m_entry(ent) {
+            if (m_entry) ++m_entry->refs;
+        }
+
+        public:
+
+        /** Default constructor (no value) */
+        handle(): m_entry(NULL) {}
+
+        /** Copy constructor */
+        handle(const handle & orig): handle(orig.m_entry) {}
+
+        /** Move constructor */
+        handle(handle && orig): m_entry(orig.m_entry) {
+            orig.m_entry = NULL;
+        }
+
+        /** Assignment (copy-and-swap) */
+        handle & operator = (handle rval) {
+            std::swap(m_entry, rval.m_entry);
+            return *this;
+        }
+
+        /** Value getter */
+        const V & operator * () const { return m_entry->value; }
+
+        /** Value member access */
+        const V * operator -> () const { return &m_entry->value; }
+
+        /** Handle refers to a value */
+        explicit operator bool () const { return NULL != m_entry; }
+
+        /** Number of handles referring to the value */
+        size_t use_count() const { return m_entry ? m_entry->refs : 0; }
+
+        /** Handles refer to the same (i.e. equal) value */
+        bool operator == (const handle & rarg) const {
+            return m_entry == rarg.m_entry;
+        }
+
+        /** Handles refer to different values */
+        bool operator != (const handle & rarg) const {
+            return m_entry != rarg.m_entry;
+        }
+
+        /** Destructor */
+        ~handle() { release(m_entry); }
+
+    };  // end of class handle
+
+    private:
+
+    /**
+     *  \brief  Intern value (implementation)
+     *
+     *  \param  value  Value
+     *
+     *  \return Handle of the pooled value
+     */
+    template <typename U>
+    handle intern_impl(U && value) {
+        const size_t hash = m_hash(value);
+
+        auto range = m_index.equal_range(hash);
+        for (; range.first != range.second; ++range.first)
+            if (m_equal(range.first->second->value, value))
+                return handle(range.first->second);
+
+        std::unique_ptr<entry> ent(
+            new entry(std::forward<U>(value), hash, this));
+        m_index.emplace(hash, ent.get());
+        return handle(ent.release());
+    }
+
+    public:
+
+    /** Constructor */
+    value_pool(const Hash & hash = Hash(), const Equal & equal = Equal()):
+        m_hash(hash),
+        m_equal(equal)
+    {}
+
+    /** Pools aren't copyable (handles refer to them) */
+    value_pool(const value_pool & orig) = delete;
+
+    /** Pools aren't assignable (handles refer to them) */
+    value_pool & operator = (const value_pool & orig) = delete;
+
+    /**
+     *  \brief  Intern value
+     *
+     *  Equal value is looked up in the pool; if it isn't there,
+     *  a copy of \c value is added.
+     *
+     *  \param  value  Value
+     *
+     *  \return Handle of the pooled value
+     */
+    handle intern(const V & value) { return intern_impl(value); }
+
+    /**
+     *  \brief  Intern value (by move)
+     *
+     *  \param  value  Value (moved to the pool unless already there)
+     *
+     *  \return Handle of the pooled value
+     */
+    handle intern(V && value) { return intern_impl(std::move(value)); }
+
+    /** Number of distinct (pooled) values */
+    size_t size() const { return m_index.size(); }
+
+    /** Pool is empty */
+    bool empty() const { return m_index.empty(); }
+
+    /** Destructor (detaches values still referred to) */
+    ~value_pool() {
+        for (auto & ix: m_index) ix.second->pool = NULL;
+    }
+
+};  // end of template class value_pool
+
+}  // end of namespace container
+
+#endif  // end of #ifndef value_pool_hxx
@@ -0,0 +1,464 @@
+#ifndef zorder_index_hxx
+#define zorder_index_hxx
+
+/**
+ *  \file
+ *  \brief  Z-order (Morton code) spatial index
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "trie.hxx"
+
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <stdexcept>
+#include <cstdint>
+#include <cmath>
+
+
+namespace container {
+
+/**
+ *  \brief  Z-order spatial index
+ *
+ *  Points of 2D 32-bit integer grid are indexed by their Morton codes
+ *  (bit-interleaved coordinates, X bits being the more significant),
+ *  stored as 8-byte big-endian TRIE keys.
+ *  Key prefix of \c 2l bits is therefore a quadtree cell of level \c l
+ *  and quad-bit TRIE prefixes are cells of even levels.
+ *
+ *  Geographical coordinates may be mapped to the grid by \ref geo_xy;
+ *  the Morton codes then match geohash bits (longitude first), so
+ *  geohash of \c k characters is the \c 5k bits long key prefix.
+ *
+ *  Bounding box queries decompose the box into quadtree cells.
+ *  Cells that lie entirely inside the box are reported wholesale
+ *  by prefix traversal of the TRIE, without checking the points.
+ *  Cells on the box boundary are only refined while they contain
+ *  points (empty cell prefix is a TRIE miss); at the maximal
+ *  refinement level, their points are filtered.
+ *  Cells are processed in Z order, so the query results are merged
+ *  in the key order.
+ *
+ *  \tparam  T  Value type
+ */
+template <typename T>
+class zorder_index {
+    public:
+
+    /** Bounding box (inclusive) */
+    struct box {
+        uint32_t x0;  /**< Min. X */
+        uint32_t y0;  /**< Min. Y */
+        uint32_t x1;  /**< Max. X */
+        uint32_t y1;  /**< Max. Y */
+
+        box(uint32_t _x0, uint32_t _y0, uint32_t _x1, uint32_t _y1):
+            x0(_x0), y0(_y0), x1(_x1), y1(_y1)
+        {}
+
+        /** Point is inside */
+        inline bool contains(uint32_t x, uint32_t y) const {
+            return x0 <= x && x <= x1 && y0 <= y && y <= y1;
+        }
+
+    };  // end of struct box
+
+    /**
+     *  \brief  Quadtree cell (Z-order key prefix)
+     *
+     *  Entries:
+     *  @0: Cell Morton code prefix (aligned to the most significant bits)
+     *  @1: Prefix quad-bit length (cell level / 2)
+     *  @2: Cell lies entirely inside the box
+     */
+    typedef std::tuple<uint64_t, size_t, bool> cell_t;
+
+    /** Indexed point */
+    struct item_t {
+        unsigned char key[8];  /**< Morton code (big endian) */
+        T             value;   /**< Value                    */
+
+        item_t(uint64_t code, const T & _value): value(_value) {
+            code2key(code, key);
+        }
+
+        /** X coordinate getter */
+        inline uint32_t x() const { return unshuffle(key2code(key) >> 1); }
+
+        /** Y coordinate getter */
+        inline uint32_t y() const { return unshuffle(key2code(key)); }
+
+    };  // end of struct item_t
+
+    private:
+
+    /** Item key getter */
+    struct key_fn {
+        inline const unsigned char * operator () (const item_t & item) const {
+            return item.key;
+        }
+    };  // end of struct key_fn
+
+    /** Item key length getter */
+    struct key_len_fn {
+        inline size_t operator () (const item_t & item) const {
+            return sizeof(item.key);
+        }
+    };  // end of struct key_len_fn
+
+    public:
+
+    typedef container::trie<item_t, key_fn, key_len_fn> trie_t;  /**< TRIE */
+
+    private:
+
+    trie_t m_trie;  /**< Morton code TRIE */
+
+    /** Spread 32 bits to even bits of 64-bit word */
+    static uint64_t shuffle(uint32_t v) {
+        uint64_t w = v;
+        w = (w | (w << 16)) & 0x0000ffff0000ffffull;
+        w = (w | (w <<  8)) & 0x00ff00ff00ff00ffull;
+        w = (w | (w <<  4)) & 0x0f0f0f0f0f0f0f0full;
+        w = (w | (w <<  2)) & 0x3333333333333333ull;
+        w = (w | (w <<  1)) & 0x5555555555555555ull;
+        return w;
+    }
+
+    /** Gather even bits of 64-bit word */
+    static uint32_t unshuffle(uint64_t w) {
+        w &= 0x5555555555555555ull;
+        w = (w | (w >>  1)) & 0x3333333333333333ull;
+        w = (w | (w >>  2)) & 0x0f0f0f0f0f0f0f0full;
+        w = (w | (w >>  4)) & 0x00ff00ff00ff00ffull;
+        w = (w | (w >>  8)) & 0x0000ffff0000ffffull;
+        w = (w | (w >> 16)) & 0x00000000ffffffffull;
+        return (uint32_t)w;
+    }
+
+    /** Morton code to big-endian key */
+    static void code2key(uint64_t code, unsigned char key[8]) {
+        for (int i = 7; i >= 0; --i, code >>= 8)
+            key[i] = (unsigned char)code;
+    }
+
+    /** Big-endian key to Morton code */
+    static uint64_t key2code(const unsigned char key[8]) {
+        uint64_t code = 0;
+        for (int i = 0; i < 8; ++i)
+            code = (code << 8) | key[i];
+
+        return code;
+    }
+
+    /**
+     *  \brief  Cell geometry
+     *
+     *  \param  level  Cell level (0 is the whole grid, 32 is a point)
+     *  \param  cx     Cell X index
+     *  \param  cy     Cell Y index
+     *
+     *  \return Cell box
+     */
+    static box cell_box(size_t level, uint64_t cx, uint64_t cy) {
+        const size_t   shift = 32 - level;
+        const uint64_t mask  = ((uint64_t)1 << shift) - 1;
+
+        return box(
+            (uint32_t)(cx << shift), (uint32_t)(cy << shift),
+            (uint32_t)((cx << shift) | mask), (uint32_t)((cy << shift) | mask));
+    }
+
+    /**
+     *  \brief  Cell vs. box relation
+     *
+     *  \param  cell  Cell box
+     *  \param  bbox  Bounding box
+     *
+     *  \return -1 if disjoint, 1 if the cell is inside, 0 otherwise
+     */
+    static int relation(const box & cell, const box & bbox) {
+        if (cell.x1 < bbox.x0 || bbox.x1 < cell.x0 ||
+            cell.y1 < bbox.y0 || bbox.y1 < cell.y0)
+        {
+            return -1;
+        }
+
+        return bbox.x0 <= cell.x0 && cell.x1 <= bbox.x1 &&
+               bbox.y0 <= cell.y0 && cell.y1 <= bbox.y1;
+    }
+
+    /**
+     *  \brief  Sub-cell index
+     *
+     *  Next even level cells are addressed by a quad-bit
+     *  (X and Y bits interleaved).
+     *
+     *  \param  c   Cell index
+     *  \param  qb  Quad-bit (X1 Y1 X0 Y0)
+     *  \param  y   Get Y (or X) index
+     *
+     *  \return Sub-cell index
+     */
+    static uint64_t subcell(uint64_t c, size_t qb, bool y) {
+        if (!y) qb >>= 1;  // X bits are the more significant
+        return (c << 2) | ((qb >> 1) & 0x2) | (qb & 0x1);
+    }
+
+    /**
+     *  \brief  Cover box by cells (implementation)
+     *
+     *  \param  bbox       Bounding box
+     *  \param  max_level  Max. refinement level
+     *  \param  level      Current cell level
+     *  \param  cx         Current cell X index
+     *  \param  cy         Current cell Y index
+     *  \param  cells      Output cells
+     */
+    static void cover(
+        const box &           bbox,
+        size_t                max_level,
+        size_t                level,
+        uint64_t              cx,
+        uint64_t              cy,
+        std::vector<cell_t> & cells)
+    {
+        const int rel = relation(cell_box(level, cx, cy), bbox);
+        if (rel < 0) return;
+
+        if (rel > 0 || level >= max_level) {
+            cells.emplace_back(cell_code(level, cx, cy), level >> 1, rel > 0);
+            return;
+        }
+
+        for (size_t qb = 0; qb < 16; ++qb)
+            cover(bbox, max_level, level + 2,
+                subcell(cx, qb, false), subcell(cy, qb, true), cells);
+    }
+
+    /** Cell Morton code prefix */
+    static uint64_t cell_code(size_t level, uint64_t cx, uint64_t cy) {
+        const size_t shift = 32 - level;
+        return (shuffle((uint32_t)(cx << shift)) << 1) |
+                shuffle((uint32_t)(cy << shift));
+    }
+
+    /**
+     *  \brief  Box query (implementation)
+     *
+     *  \param  bbox       Bounding box
+     *  \param  max_level  Max. refinement level
+     *  \param  level      Current cell level
+     *  \param  cx         Current cell X index
+     *  \param  cy         Current cell Y index
+     *  \param  fn         Item callback
+     *
+     *  \return Number of items reported
+     */
+    template <class Fn>
+    size_t query(
+        const box & bbox,
+        size_t      max_level,
+        size_t      level,
+        uint64_t    cx,
+        uint64_t    cy,
+        Fn &        fn)
+    const {
+        const int rel = relation(cell_box(level, cx, cy), bbox);
+        if (rel < 0) return 0;
+
+        unsigned char key[8];
+        code2key(cell_code(level, cx, cy), key);
+
+        auto range = m_trie.find_qprefix(key, level >> 1);
+        if (range.first == range.second) return 0;  // empty cell
+
+        size_t cnt = 0;
+
+        // Cell inside the box, no need to check the points
+        if (rel > 0) {
+            for (; range.first != range.second; ++range.first, ++cnt)
+                fn(std::get<2>(*range.first));
+        }
+
+        // Boundary cell at max. level, check the points
+        else if (level >= max_level) {
+            for (; range.first != range.second; ++range.first) {
+                const item_t & item = std::get<2>(*range.first);
+                if (!bbox.contains(item.x(), item.y())) continue;
+
+                fn(item);
+                ++cnt;
+            }
+        }
+
+        // Refine boundary cell
+        else {
+            for (size_t qb = 0; qb < 16; ++qb)
+                cnt += query(bbox, max_level, level + 2,
+                    subcell(cx, qb, false), subcell(cy, qb, true), fn);
+        }
+
+        return cnt;
+    }
+
+    /**
+     *  \brief  Clamp scaled coordinate to [0, scale) and truncate
+     *
+     *  \param  c      Scaled coordinate (not NaN)
+     *  \param  scale  Grid scale
+     *
+     *  \return Grid coordinate
+     */
+    static uint32_t grid_coord(double c, double scale) {
+        if (!(c > 0.0))    return 0;
+        if (!(c < scale))  return (uint32_t)-1;
+        return (uint32_t)c;
+    }
+
+    public:
+
+    /** Default max. refinement level of box query boundary cells */
+    static const size_t max_level_default = 24;
+
+    /**
+     *  \brief  Map geographical coordinates to the grid
+     *
+     *  Out-of-range coordinates are clamped to the grid.
+     *
+     *  \param  lon  Longitude [-180, 180]
+     *  \param  lat  Latitude  [-90, 90]
+     *
+     *  \return Grid coordinates (X, Y)
+     */
+    static std::pair<uint32_t, uint32_t> geo_xy(double lon, double lat) {
+        if (std::isnan(lon) || std::isnan(lat))
+            throw std::logic_error(
+                "libtrie++: Z-order index: NaN coordinate");
+
+        const double scale = 4294967296.0;  // 2^32
+
+        return std::make_pair(
+            grid_coord((lon + 180.0) / 360.0 * scale, scale),
+            grid_coord((lat +  90.0) / 180.0 * scale, scale));
+    }
+
+    /**
+     *  \brief  Cover box by Z-order prefixes
+     *
+     *  Cells inside the box are of the lowest possible (even) level;
+     *  boundary cells are refined up to \c max_level.
+     *  The cells are produced in Z order.
+     *
+     *  \param  bbox       Bounding box
+     *  \param  max_level  Max. refinement level (even, up to 32)
+     *
+     *  \return Cells covering the box
+     */
+    static std::vector<cell_t> cover(
+        const box & bbox,
+        size_t      max_level = max_level_default)
+    {
+        std::vector<cell_t> cells;
+        cover(bbox, max_level, 0, 0, 0, cells);
+        return cells;
+    }
+
+    /** Number of points */
+    inline size_t size() const { return m_trie.size(); }
+
+    /** Underlying TRIE getter */
+    inline const trie_t & trie() const { return m_trie; }
+
+    /**
+     *  \brief  Insert point (unless already indexed)
+     *
+     *  \param  x      X coordinate
+     *  \param  y      Y coordinate
+     *  \param  value  Value
+     *
+     *  \return \c true iff the point was inserted
+     */
+    bool insert(uint32_t x, uint32_t y, const T & value) {
+        const size_t size = m_trie.size();
+        m_trie.insert(item_t((shuffle(x) << 1) | shuffle(y), value));
+        return m_trie.size() != size;
+    }
+
+    /**
+     *  \brief  Find point
+     *
+     *  \param  x  X coordinate
+     *  \param  y  Y coordinate
+     *
+     *  \return Point item or \c NULL if not indexed
+     */
+    const item_t * find(uint32_t x, uint32_t y) const {
+        unsigned char key[8];
+        code2key((shuffle(x) << 1) | shuffle(y), key);
+
+        auto iter = m_trie.find(key, sizeof(key));
+        return m_trie.end() == iter ? NULL : &std::get<2>(*iter);
+    }
+
+    /**
+     *  \brief  Box query
+     *
+     *  Items are reported in Z order.
+     *
+     *  \param  bbox       Bounding box
+     *  \param  fn         Item callback (called with \c const \c item_t &)
+     *  \param  max_level  Max. refinement level of boundary cells (even)
+     *
+     *  \return Number of items reported
+     */
+    template <class Fn>
+    size_t query(
+        const box & bbox,
+        Fn          fn,
+        size_t      max_level = max_level_default)
+    const {
+        return query(bbox, max_level, 0, 0, 0, fn);
+    }
+
+};  // end of template class zorder_index
+
+}  // end of namespace container
+
+#endif  // end of #ifndef zorder_index_hxx
@@ -42,20 +42,34 @@
 
 
 #include <libtriexx/trie.hxx>
+#include <libtriexx/counting_trie.hxx>
+#include <libtriexx/disk_trie.hxx>
+#include <libtriexx/heavy_hitters.hxx>
+#include <libtriexx/import.hxx>
+#include <libtriexx/trie_sort.hxx>
 
 #include <string>
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <thread>
+#include <functional>
+#include <sstream>
+#include <regex>
 #include <iostream>
 #include <exception>
 #include <stdexcept>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 
 extern "C" {
 #include <time.h>
 #include <getopt.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
 }
 
 
@@ -65,14 +79,15 @@ extern "C" {
  *  \param  out   Output stream
  *  \param  trie  TRIE
  */
-template <typename T, class KeyFn, class KeyLenFn, int KeyTracing>
+template <
+    typename T, class KeyFn, class KeyLenFn, int KeyTracing, int Features>
 static void print_trie(
     std::ostream & out,
-    const container::trie<T, KeyFn, KeyLenFn, KeyTracing> & trie)
+    const container::trie<T, KeyFn, KeyLenFn, KeyTracing, Features> & trie)
 {
     out << "TRIE dump:" << std::endl << trie << std::endl;
 
-    typedef container::trie<T, KeyFn, KeyLenFn, KeyTracing> trie_t;
+    typedef container::trie<T, KeyFn, KeyLenFn, KeyTracing, Features> trie_t;
 
     out << "Key -> value pairs in key order:" << std::endl;
     std::for_each(trie.begin(), trie.end(),
@@ -102,7 +117,7 @@ static void print_trie(
  *  \return Random integer from interval [lo, hi]
  */
 static int rand_int(int lo, int hi) {
-    double x = ::rand() / RAND_MAX;  // 0 <= x <= 1
+    double x = (double)::rand() / RAND_MAX;  // 0 <= x <= 1
     x *= hi - lo;                    // 0 <= x <= hi - lo
 
     return lo + (int)x;  // lo <= x <= hi
@@ -150,6 +165,70 @@ inline static double timestamp() {
 }
 
 
+/**
+ *  \brief  dTLB load miss counter
+ *
+ *  Counts dTLB load misses of the calling thread (user space only)
+ *  using Linux performance events.
+ *  The counter may be unavailable (e.g. no access to PMU).
+ */
+class dtlb_misses {
+    private:
+
+    int m_fd;  /**< Performance event file descriptor */
+
+    public:
+
+    /** Constructor */
+    dtlb_misses() {
+        struct perf_event_attr attr;
+        ::memset(&attr, 0, sizeof(attr));
+
+        attr.size   = sizeof(attr);
+        attr.type   = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB |
+            (PERF_COUNT_HW_CACHE_OP_READ     << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        m_fd = ::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    /** Counter is available */
+    inline bool available() const { return -1 != m_fd; }
+
+    /** Start counting (from 0) */
+    void start() {
+        if (!available()) return;
+
+        ::ioctl(m_fd, PERF_EVENT_IOC_RESET,  0);
+        ::ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    /**
+     *  \brief  Stop counting
+     *
+     *  \return Number of misses since \ref start
+     */
+    uint64_t stop() {
+        if (!available()) return 0;
+
+        ::ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+        uint64_t cnt = 0;
+        if (sizeof(cnt) != ::read(m_fd, &cnt, sizeof(cnt))) return 0;
+        return cnt;
+    }
+
+    /** Destructor */
+    ~dtlb_misses() { if (available()) ::close(m_fd); }
+
+};  // end of class dtlb_misses
+
+
 /**
  *  \brief  Benchmark result
  *
@@ -171,138 +250,1460 @@ static void result(
         << "std::map time: " << map_time << " s ("
         << map_time / loops << " s per insert avg)" << std::endl;
 
-    double time_ratio = map_time / trie_time;
-    bool trie_faster = time_ratio > 1.0;
-    if (!trie_faster) time_ratio = 1.0 / time_ratio;
-    double percent_diff = (int)(1000.0 * (time_ratio - 1.0)) / 10.0;
+    double time_ratio = map_time / trie_time;
+    bool trie_faster = time_ratio > 1.0;
+    if (!trie_faster) time_ratio = 1.0 / time_ratio;
+    double percent_diff = (int)(1000.0 * (time_ratio - 1.0)) / 10.0;
+
+    std::cerr
+        << "TRIE is " << time_ratio << " times "
+        << (trie_faster ? "FASTER" : "SLOWER")
+        << " than map (that's about " << percent_diff << "%)"
+        << std::endl;
+}
+
+
+/**
+ *  \brief  String-keyed TRIE benchmark
+ *
+ *  \tparam  KeyTracing  Key tracing mode
+ *  \tparam  Features    TRIE optional features
+ *
+ *  \param  n              Number of test keys generated
+ *  \param  prefix_cnt     Number of common key prefixes generated
+ *  \param  prefix_min     Common key prefix minimal length
+ *  \param  prefix_max     Common key prefix maximal length
+ *  \param  key_min        Key minimal length
+ *  \param  key_max        Key maximal length
+ *  \param  misses_per100  Key search miss percentage (random key used)
+ *  \param  lbi_per100     Inserts to lower bound percentage (random key used)
+ *  \param  slob_qlen      Slobby tracing verification threshold
+ *  \param  dump           Dump TRIE after benchmarking
+ *
+ *  \return Error count
+ */
+template <int KeyTracing, int Features = 0>
+static int string_trie_benchmark(
+    size_t n,
+    size_t prefix_cnt,
+    size_t prefix_min,
+    size_t prefix_max,
+    size_t key_min,
+    size_t key_max,
+    int    misses_per100,
+    int    lbi_per100,
+    size_t slob_qlen,
+    bool   dump)
+{
+    int error_cnt = 0;
+
+    std::cerr
+        << "String TRIE benchmark (key tracing mode "
+        << KeyTracing << ", features " << Features << ") BEGIN"
+        << std::endl;
+
+    // Alphabet
+    size_t alphabet_size = 64;
+    std::string alphabet; alphabet.reserve(alphabet_size);
+    for (size_t i = 0; i < alphabet_size; ++i)
+        alphabet.push_back('A' + i);
+
+    // Prefixes
+    std::vector<std::string> prefixes; prefixes.reserve(prefix_cnt);
+    for (size_t i = 0; i < prefix_cnt; ++i)
+        prefixes.push_back(
+            generate_string(alphabet, prefix_min, prefix_max));
+
+    // Key generator
+    auto generate_key =
+    [&alphabet, &prefixes](size_t min, size_t max) -> std::string {
+        static const std::string no_prefix("");
+
+        const std::string & prefix = prefixes.size() > 0
+            ? prefixes[rand_int(0, prefixes.size() - 1)]
+            : no_prefix;
+
+        return prefix + generate_string(alphabet,
+            min < prefix.size() ? 0 : min - prefix.size(),
+            max < prefix.size() ? 0 : max - prefix.size());
+    };
+
+    // Containers
+    std::vector<std::string> keys; keys.reserve(n);
+    container::string_trie<int, KeyTracing, Features> trie;
+    std::map<std::string, int> map;
+
+    trie.slob_threshold(slob_qlen);
+
+    // Hot key prefixes (sampled, if enabled)
+    container::heavy_hitters hitters(std::vector<size_t>(1, 8));
+    trie.sampler(std::ref(hitters), 64);
+
+    // Insert benchmark
+    double trie_time = 0.0;
+    double map_time  = 0.0;
+
+    for (size_t i = 0; i < n; ++i) {
+        const std::string key = generate_key(key_min, key_max);
+        keys.push_back(key);
+
+        if (rand_int(0, 99) < lbi_per100) {
+            trie_time -= timestamp();
+            auto lb = trie.lower_bound(
+                (const unsigned char *)key.data(), key.size());
+            if (!container::string_trie<int, KeyTracing, Features>::pos_match(lb))
+                trie.insert(std::make_tuple(key, (int)i), lb);
+            trie_time += timestamp();
+        }
+        else {
+            trie_time -= timestamp();
+            trie.insert(std::make_tuple(key, (int)i));
+            trie_time += timestamp();
+        }
+
+        map_time -= timestamp();
+        map.emplace(key, i);
+        map_time += timestamp();
+    }
+
+    result("Insert", n, trie_time, map_time);
+
+    // Find benchmark
+    trie_time = 0.0;
+    map_time  = 0.0;
+
+    size_t trie_hits  = 0;
+    size_t false_hits = 0;  // slobby key tracing hits of another key
+    size_t map_hits   = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        int key_ix = -1;
+        const std::string key = rand_int(0, 99) < misses_per100
+            ? generate_key(key_min, key_max)
+            : keys[key_ix = rand_int(0, keys.size() - 1)];
+
+        trie_time -= timestamp();
+        auto iter = trie.find((const unsigned char *)key.data(), key.size());
+        trie_time += timestamp();
+
+        map_time -= timestamp();
+        map_hits += map.end() != map.find(key);
+        map_time += timestamp();
+
+        if (trie.end() != iter) {
+            ++trie_hits;
+
+            if (std::get<1>(*iter) != key.size() ||
+                0 != ::memcmp(std::get<0>(*iter), key.data(), key.size()))
+            {
+                ++false_hits;
+            }
+        }
+    }
+
+    result("Search", n, trie_time, map_time);
+
+    std::cerr
+        << "Hits: " << trie_hits << " (std::map: " << map_hits << "), "
+        << "false hits: " << false_hits << " ("
+        << (100.0 * false_hits / n) << "% of lookups)" << std::endl;
+
+    if (trie_hits - false_hits != map_hits) {
+        std::cerr << "Missed keys: " << map_hits - (trie_hits - false_hits)
+            << std::endl;
+        ++error_cnt;
+    }
+
+    if (Features & container::TRIE_ACCESS_SAMPLING) {
+        std::cerr << "Hot key prefixes (of " << hitters.samples()
+            << " samples):" << std::endl;
+
+        for (const auto & hitter: hitters.top(8, 5))
+            std::cerr << hitter.prefix << ": " << hitter.count
+                << " (error " << hitter.error << ")" << std::endl;
+    }
+
+    if (dump) print_trie(std::cout, trie);
+
+    std::cerr << "String TRIE benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  TRIE sort benchmark
+ *
+ *  Sorting and deduplication of strings is compared to
+ *  \c std::sort followed by \c std::unique.
+ *
+ *  \param  n           Number of test keys generated
+ *  \param  prefix_cnt  Number of common key prefixes generated
+ *  \param  prefix_min  Common key prefix minimal length
+ *  \param  prefix_max  Common key prefix maximal length
+ *  \param  key_min     Key minimal length
+ *  \param  key_max     Key maximal length
+ *
+ *  \return Error count
+ */
+static int trie_sort_benchmark(
+    size_t n,
+    size_t prefix_cnt,
+    size_t prefix_min,
+    size_t prefix_max,
+    size_t key_min,
+    size_t key_max)
+{
+    int error_cnt = 0;
+
+    std::cerr << "TRIE sort benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    std::vector<std::string> prefixes; prefixes.reserve(prefix_cnt);
+    for (size_t i = 0; i < prefix_cnt; ++i)
+        prefixes.push_back(
+            generate_string(alphabet, prefix_min, prefix_max));
+
+    // Keys (about every 4th one is a duplicate)
+    std::vector<std::string> keys; keys.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (i && 0 == rand_int(0, 3)) {
+            keys.push_back(keys[rand_int(0, i - 1)]);
+            continue;
+        }
+
+        const std::string prefix = prefixes.empty()
+            ? std::string()
+            : prefixes[rand_int(0, prefixes.size() - 1)];
+
+        keys.push_back(prefix + generate_string(alphabet,
+            key_min < prefix.size() ? 0 : key_min - prefix.size(),
+            key_max < prefix.size() ? 0 : key_max - prefix.size()));
+    }
+
+    std::vector<std::string> trie_keys(keys);
+    std::vector<std::string> std_keys(keys);
+
+    double trie_time = -timestamp();
+    trie_keys.erase(
+        container::trie_sort(trie_keys.begin(), trie_keys.end()),
+        trie_keys.end());
+    trie_time += timestamp();
+
+    double std_time = -timestamp();
+    std::sort(std_keys.begin(), std_keys.end());
+    std_keys.erase(
+        std::unique(std_keys.begin(), std_keys.end()),
+        std_keys.end());
+    std_time += timestamp();
+
+    std::cerr
+        << "container::trie_sort time: " << trie_time << " s" << std::endl
+        << "std::sort + std::unique time: " << std_time << " s" << std::endl
+        << "TRIE sort is " << std_time / trie_time
+        << " times faster (" << std_keys.size() << " unique keys of " << n
+        << ")" << std::endl;
+
+    if (trie_keys != std_keys) {
+        std::cerr << "TRIE sort result mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "TRIE sort benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Flat sorted export benchmark
+ *
+ *  Export of items to flat arrays by \c export_sorted is compared
+ *  to item by item copying using TRIE iterator.
+ *
+ *  \param  n        Number of test keys generated
+ *  \param  key_min  Key minimal length
+ *  \param  key_max  Key maximal length
+ *
+ *  \return Error count
+ */
+static int export_benchmark(size_t n, size_t key_min, size_t key_max) {
+    int error_cnt = 0;
+
+    std::cerr << "Export benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    typedef container::string_trie<int> trie_t;
+    trie_t trie;
+
+    for (size_t i = 0; i < n; ++i)
+        trie.insert(std::make_tuple(
+            generate_string(alphabet, key_min, key_max), (int)i));
+
+    auto value = [](const std::tuple<std::string, int> & item) -> int {
+        return std::get<1>(item);
+    };
+
+    // Item by item
+    std::vector<unsigned char> iter_keys;
+    std::vector<size_t>        iter_offsets;
+    std::vector<int>           iter_values;
+
+    double iter_time = -timestamp();
+    std::for_each(trie.begin(), trie.end(),
+    [&](const trie_t::const_iterator::deref_t & d) {
+        iter_offsets.push_back(iter_keys.size());
+        iter_keys.insert(iter_keys.end(),
+            std::get<0>(d), std::get<0>(d) + std::get<1>(d));
+        iter_values.push_back(value(std::get<2>(d)));
+    });
+    iter_offsets.push_back(iter_keys.size());
+    iter_time += timestamp();
+
+    std::cerr << "Iterator copy time: " << iter_time << " s" << std::endl;
+
+    const size_t cpus = std::thread::hardware_concurrency();
+    for (size_t threads = 1; ; threads = cpus) {
+        std::vector<unsigned char> keys;
+        std::vector<size_t>        offsets;
+        std::vector<int>           values;
+
+        double time = -timestamp();
+        trie.export_sorted(keys, offsets, values, value, threads);
+        time += timestamp();
+
+        std::cerr
+            << "export_sorted time (" << threads << " threads): " << time
+            << " s (" << (keys.size() / time / 1000000.0) << " MB/s of keys, "
+            << iter_time / time << " times faster)" << std::endl;
+
+        if (keys != iter_keys || offsets != iter_offsets ||
+            values != iter_values)
+        {
+            std::cerr << "Export mismatch" << std::endl;
+            ++error_cnt;
+        }
+
+        if (threads >= cpus) break;
+    }
+
+    std::cerr << "Export benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Snapshot diff benchmark (implementation)
+ *
+ *  \param  n        Number of test keys generated
+ *  \param  key_min  Key minimal length
+ *  \param  key_max  Key maximal length
+ *
+ *  \return Error count
+ */
+template <int Features>
+static int diff_benchmark_impl(size_t n, size_t key_min, size_t key_max) {
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT, Features> trie_t;
+    trie_t trie;
+
+    for (size_t i = 0; i < n; ++i)
+        trie.insert(std::make_tuple(
+            generate_string(alphabet, key_min, key_max), (int)i));
+
+    double copy_time = -timestamp();
+    trie_t snapshot(trie);
+    copy_time += timestamp();
+
+    // Few changes (0.1 %; keys may repeat)
+    size_t changes = 0;
+    for (size_t i = 0; i < n / 1000 + 1; ++i) {
+        const std::string key = generate_string(alphabet, key_min, key_max);
+        typename trie_t::iterator iter =
+            trie.find((const unsigned char *)key.data(), key.size());
+
+        if (trie.end() == iter) {
+            trie.insert(std::make_tuple(key, -1));
+        }
+        else {
+            std::get<1>(std::get<2>(*iter)) = -1;
+            trie.touch(iter);
+        }
+
+        ++changes;
+    }
+
+    typedef std::tuple<std::string, int> item_t;
+    size_t diff_size = 0;
+
+    double diff_time = -timestamp();
+    trie_t::diff(snapshot, trie,
+        [&](const item_t &) { ++diff_size; },
+        [&](const item_t &) { ++diff_size; },
+        [&](const item_t &, const item_t &) { ++diff_size; });
+    diff_time += timestamp();
+
+    std::cerr
+        << "Features " << Features << ": snapshot time: " << copy_time
+        << " s, diff time: " << diff_time << " s ("
+        << diff_size << " changes)" << std::endl;
+
+    if (0 == diff_size || diff_size > changes) {
+        std::cerr << "Diff size mismatch, expected up to " << changes
+            << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ *  \brief  Snapshot diff benchmark
+ *
+ *  Diff of a snapshot and its slightly modified original is measured
+ *  with and without node version stamps.
+ *
+ *  \param  n        Number of test keys generated
+ *  \param  key_min  Key minimal length
+ *  \param  key_max  Key maximal length
+ *
+ *  \return Error count
+ */
+static int diff_benchmark(size_t n, size_t key_min, size_t key_max) {
+    int error_cnt = 0;
+
+    std::cerr << "Diff benchmark BEGIN" << std::endl;
+
+    error_cnt += diff_benchmark_impl<0>(n, key_min, key_max);
+    error_cnt += diff_benchmark_impl<container::TRIE_VERSION_STAMPS>(
+        n, key_min, key_max);
+
+    std::cerr << "Diff benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Concurrent counting benchmark
+ *
+ *  Skewed key stream is counted by all CPUs using shared counters
+ *  directly and using thread-local deltas.
+ *  Single-threaded counting in a TRIE is the baseline.
+ *
+ *  \param  n        Number of counted keys
+ *  \param  key_min  Key minimal length
+ *  \param  key_max  Key maximal length
+ *
+ *  \return Error count
+ */
+static int counting_benchmark(size_t n, size_t key_min, size_t key_max) {
+    int error_cnt = 0;
+
+    std::cerr << "Counting benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    std::vector<std::string> vocabulary;
+    for (size_t i = 0; i < n / 100 + 1; ++i)
+        vocabulary.push_back(generate_string(alphabet, key_min, key_max));
+
+    // Skewed stream (low vocabulary indices are hot)
+    std::vector<const std::string *> stream;
+    for (size_t i = 0; i < n; ++i) {
+        const double r = (double)::rand() / RAND_MAX;
+        stream.push_back(&vocabulary[(size_t)(r * r * r *
+            (vocabulary.size() - 1))]);
+    }
+
+    // Single-threaded baseline
+    container::string_trie<uint64_t> baseline;
+
+    double base_time = -timestamp();
+    for (auto key: stream) {
+        container::string_trie<uint64_t>::iterator iter = baseline.find(
+            (const unsigned char *)key->data(), key->size());
+
+        if (baseline.end() == iter)
+            baseline.insert(std::make_tuple(*key, (uint64_t)1));
+        else
+            ++std::get<1>(std::get<2>(*iter));
+    }
+    base_time += timestamp();
+
+    std::cerr << "Single thread time: " << base_time << " s" << std::endl;
+
+    const size_t threads = std::thread::hardware_concurrency();
+    for (size_t flush_period = 0; ; flush_period = 4096) {
+        container::counting_trie<uint64_t> counts;
+
+        double time = -timestamp();
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t)
+            workers.push_back(std::thread([&, t]() {
+                container::counting_trie<uint64_t>::local local(
+                    counts, flush_period);
+
+                for (size_t i = t; i < stream.size(); i += threads) {
+                    if (flush_period)
+                        local.increment(*stream[i]);
+                    else
+                        counts.increment(*stream[i]);
+                }
+            }));
+
+        for (auto & worker: workers) worker.join();
+
+        time += timestamp();
+
+        std::cerr
+            << (flush_period ? "Thread-local deltas" : "Shared counters")
+            << " time (" << threads << " threads): " << time
+            << " s (" << base_time / time << " times faster)" << std::endl;
+
+        if (counts.size() != baseline.size() ||
+            counts.count(*stream[0]) != std::get<1>(std::get<2>(
+                *baseline.find((const unsigned char *)stream[0]->data(),
+                    stream[0]->size()))))
+        {
+            std::cerr << "Counts mismatch" << std::endl;
+            ++error_cnt;
+        }
+
+        if (flush_period) break;
+    }
+
+    std::cerr << "Counting benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Aggregation benchmark
+ *
+ *  Sums of values per key (skewed key stream) are computed using
+ *  \c find followed by \c insert on miss and using \c insert_or_merge
+ *  (single TRIE trace).
+ *
+ *  \param  n           Number of aggregated items
+ *  \param  prefix_cnt  Number of key prefixes
+ *  \param  prefix_min  Key prefix minimal length
+ *  \param  prefix_max  Key prefix maximal length
+ *  \param  key_min     Key (suffix) minimal length
+ *  \param  key_max     Key (suffix) maximal length
+ *
+ *  \return Error count
+ */
+static int aggregation_benchmark(
+    size_t n,
+    size_t prefix_cnt, size_t prefix_min, size_t prefix_max,
+    size_t key_min,    size_t key_max)
+{
+    int error_cnt = 0;
+
+    std::cerr << "Aggregation benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    // Keys share prefixes (e.g. n-grams or paths)
+    std::vector<std::string> prefixes;
+    for (size_t i = 0; i < prefix_cnt; ++i)
+        prefixes.push_back(
+            generate_string(alphabet, prefix_min, prefix_max));
+
+    if (prefixes.empty()) prefixes.push_back(std::string());
+
+    std::vector<std::string> vocabulary;
+    for (size_t i = 0; i < n / 2 + 1; ++i)
+        vocabulary.push_back(
+            prefixes[::rand() % prefixes.size()] +
+            generate_string(alphabet, key_min, key_max));
+
+    typedef container::string_trie<uint64_t> trie_t;
+    typedef std::tuple<std::string, uint64_t> item_t;
+
+    // Skewed stream of items (low vocabulary indices are hot)
+    std::vector<item_t> stream;
+    for (size_t i = 0; i < n; ++i) {
+        const double r = (double)::rand() / RAND_MAX;
+        stream.push_back(item_t(
+            vocabulary[(size_t)(r * r * (vocabulary.size() - 1))], i));
+    }
+
+    // Find & insert
+    auto find_insert = [&stream](trie_t & trie) {
+        for (const auto & item: stream) {
+            const std::string & key = std::get<0>(item);
+            trie_t::iterator iter = trie.find(
+                (const unsigned char *)key.data(), key.size());
+
+            if (trie.end() == iter)
+                trie.insert(item);
+            else
+                std::get<1>(std::get<2>(*iter)) += std::get<1>(item);
+        }
+    };
+
+    // Upsert
+    auto upsert = [&stream](trie_t & trie) {
+        for (const auto & item: stream)
+            trie.insert_or_merge(item,
+            [](item_t & existing, const item_t & merged) {
+                std::get<1>(existing) += std::get<1>(merged);
+            });
+    };
+
+    // Best of 3 rounds (alternating)
+    double find_insert_time = 0, upsert_time = 0;
+    for (int round = 0; round < 3; ++round) {
+        trie_t trie1, trie2;
+
+        double time = -timestamp();
+        find_insert(trie1);
+        time += timestamp();
+
+        if (0 == round || time < find_insert_time) find_insert_time = time;
+
+        time = -timestamp();
+        upsert(trie2);
+        time += timestamp();
+
+        if (0 == round || time < upsert_time) upsert_time = time;
+
+        if (trie1.size() != trie2.size() ||
+            !std::equal(trie1.begin(), trie1.end(), trie2.begin(),
+            [](const trie_t::const_iterator::deref_t & d1,
+               const trie_t::const_iterator::deref_t & d2)
+            {
+                return std::get<2>(d1) == std::get<2>(d2);
+            }))
+        {
+            std::cerr << "Aggregates mismatch" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    std::cerr << "find & insert time: " << find_insert_time << " s"
+        << std::endl;
+    std::cerr << "insert_or_merge time: " << upsert_time << " s ("
+        << find_insert_time / upsert_time << " times faster)" << std::endl;
+
+    std::cerr << "Aggregation benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Huge pages benchmark (implementation)
+ *
+ *  \param  keys     Keys
+ *  \param  lookups  Looked up keys (indices)
+ *  \param  time     Lookup time
+ *  \param  misses   Lookup dTLB misses (0 if not available)
+ *
+ *  \return Error count
+ */
+template <int Features>
+static int huge_pages_benchmark_impl(
+    const std::vector<std::string> & keys,
+    const std::vector<size_t> &      lookups,
+    double &                         time,
+    uint64_t &                       misses)
+{
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT, Features> trie_t;
+    trie_t trie;
+
+    for (size_t i = 0; i < keys.size(); ++i)
+        trie.insert(std::make_tuple(keys[i], (int)i));
+
+    dtlb_misses counter;
+    size_t found = 0;
+
+    time = -timestamp();
+    counter.start();
+    for (auto i: lookups)
+        found += trie.end() != trie.find(
+            (const unsigned char *)keys[i].data(), keys[i].size());
+    misses = counter.stop();
+    time += timestamp();
+
+    std::cerr
+        << "Features " << Features << ": lookup time: " << time << " s"
+        << ", dTLB misses: ";
+    if (counter.available())
+        std::cerr << misses;
+    else
+        std::cerr << "n/a";
+    std::cerr << std::endl;
+
+    if (found != lookups.size()) {
+        std::cerr << "Lookup misses" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ *  \brief  Huge pages benchmark
+ *
+ *  Random lookups in TRIE allocated by global \c new are compared
+ *  to lookups in TRIE allocated from huge page backed arenas.
+ *
+ *  \param  n        Number of test keys generated
+ *  \param  key_min  Key minimal length
+ *  \param  key_max  Key maximal length
+ *
+ *  \return Error count
+ */
+static int huge_pages_benchmark(size_t n, size_t key_min, size_t key_max) {
+    int error_cnt = 0;
+
+    std::cerr << "Huge pages benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i)
+        keys.push_back(generate_string(alphabet, key_min, key_max));
+
+    std::vector<size_t> lookups;
+    for (size_t i = 0; i < n; ++i)
+        lookups.push_back(::rand() % n);
+
+    double   time,   arena_time;
+    uint64_t misses, arena_misses;
+
+    error_cnt += huge_pages_benchmark_impl<0>(
+        keys, lookups, time, misses);
+    error_cnt += huge_pages_benchmark_impl<container::TRIE_HUGE_PAGES>(
+        keys, lookups, arena_time, arena_misses);
+
+    const container::arena_stats_t stats = container::arena_stats();
+    std::cerr
+        << "Arena chunks: " << stats.chunks
+        << " (huge TLB: " << stats.hugetlb
+        << ", THP advised: " << stats.thp << "), "
+        << time / arena_time << " times faster";
+    if (0 != arena_misses)
+        std::cerr << ", dTLB misses reduced "
+            << (double)misses / arena_misses << " times";
+    std::cerr << std::endl;
+
+    std::cerr << "Huge pages benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Relayout benchmark
+ *
+ *  Skewed lookups (few percent of keys take most of them) are timed
+ *  before and after access-frequency-guided node relayout.
+ *
+ *  \param  n        Number of test keys generated
+ *  \param  key_min  Key minimal length
+ *  \param  key_max  Key maximal length
+ *
+ *  \return Error count
+ */
+static int relayout_benchmark(size_t n, size_t key_min, size_t key_max) {
+    int error_cnt = 0;
+
+    std::cerr << "Relayout benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_ACCESS_COUNTS> trie_t;
+    trie_t trie;
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(generate_string(alphabet, key_min, key_max));
+        trie.insert(std::make_tuple(keys.back(), (int)i));
+    }
+
+    // 90 % of lookups hit 5 % of keys
+    std::vector<size_t> lookups;
+    for (size_t i = 0; i < n; ++i)
+        lookups.push_back(::rand() % 10
+            ? (::rand() % (n / 20 + 1)) * 19 % n
+            : ::rand() % n);
+
+    auto lookup = [&]() -> double {
+        size_t found = 0;
+
+        double time = -timestamp();
+        for (auto i: lookups)
+            found += trie.end() != trie.find(
+                (const unsigned char *)keys[i].data(), keys[i].size());
+        time += timestamp();
+
+        if (found != lookups.size()) {
+            std::cerr << "Lookup misses" << std::endl;
+            ++error_cnt;
+        }
+
+        return time;
+    };
+
+    // Count accesses (sampled)
+    trie.access_counting(16);
+    const double count_time = lookup();
+    trie.access_counting(0);
+
+    const double time = lookup();
+
+    double relayout_time = -timestamp();
+    trie.relayout();
+    relayout_time += timestamp();
+
+    const double relaid_time = lookup();
+
+    std::cerr
+        << "Lookup time: " << time << " s (counting: " << count_time
+        << " s), relayout time: " << relayout_time
+        << " s, lookup time after relayout: " << relaid_time << " s ("
+        << time / relaid_time << " times faster)" << std::endl;
+
+    std::cerr << "Relayout benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Sorted batch lookup benchmark
+ *
+ *  Sorted batch of keys (sharing prefixes) is looked up key by key
+ *  using \c find and at once using \c find_sorted.
+ *
+ *  \param  n           Number of test keys generated
+ *  \param  prefix_cnt  Number of key prefixes
+ *  \param  prefix_min  Key prefix minimal length
+ *  \param  prefix_max  Key prefix maximal length
+ *  \param  key_min     Key (suffix) minimal length
+ *  \param  key_max     Key (suffix) maximal length
+ *
+ *  \return Error count
+ */
+static int find_sorted_benchmark(
+    size_t n,
+    size_t prefix_cnt, size_t prefix_min, size_t prefix_max,
+    size_t key_min,    size_t key_max)
+{
+    int error_cnt = 0;
+
+    std::cerr << "Sorted batch lookup benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    std::vector<std::string> prefixes;
+    for (size_t i = 0; i < prefix_cnt; ++i)
+        prefixes.push_back(
+            generate_string(alphabet, prefix_min, prefix_max));
+
+    if (prefixes.empty()) prefixes.push_back(std::string());
+
+    typedef container::string_trie<int> trie_t;
+    typedef std::tuple<std::string, int> item_t;
+    trie_t trie;
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(prefixes[::rand() % prefixes.size()] +
+            generate_string(alphabet, key_min, key_max));
+        trie.insert(std::make_tuple(keys.back(), (int)i));
+    }
+
+    // Sorted batch (1/4 of the keys)
+    std::vector<std::string> batch;
+    for (size_t i = 0; i < n / 4; ++i)
+        batch.push_back(keys[::rand() % n]);
+
+    std::sort(batch.begin(), batch.end());
+
+    std::vector<const unsigned char *> batch_keys;
+    std::vector<size_t>                batch_lens;
+    for (const auto & key: batch) {
+        batch_keys.push_back((const unsigned char *)key.data());
+        batch_lens.push_back(key.size());
+    }
+
+    // Key by key
+    std::vector<const item_t *> found;
+
+    double find_time = -timestamp();
+    for (const auto & key: batch) {
+        auto iter = trie.find((const unsigned char *)key.data(), key.size());
+        found.push_back(trie.end() == iter ? NULL : &std::get<2>(*iter));
+    }
+    find_time += timestamp();
+
+    std::cerr << "find time: " << find_time << " s" << std::endl;
+
+    // Batch
+    std::vector<const item_t *> batch_found;
+
+    double batch_time = -timestamp();
+    trie.find_sorted(
+        batch_keys.data(), batch_lens.data(), batch.size(), batch_found);
+    batch_time += timestamp();
+
+    std::cerr << "find_sorted time: " << batch_time << " s ("
+        << find_time / batch_time << " times faster)" << std::endl;
+
+    if (found != batch_found) {
+        std::cerr << "Batch lookup mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Sorted batch lookup benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Batch erase benchmark
+ *
+ *  Quarter of keys (sharing prefixes) is erased key by key
+ *  and at once using \c erase_many.
+ *
+ *  \param  n           Number of test keys generated
+ *  \param  prefix_cnt  Number of key prefixes
+ *  \param  prefix_min  Key prefix minimal length
+ *  \param  prefix_max  Key prefix maximal length
+ *  \param  key_min     Key (suffix) minimal length
+ *  \param  key_max     Key (suffix) maximal length
+ *
+ *  \return Error count
+ */
+static int erase_many_benchmark(
+    size_t n,
+    size_t prefix_cnt, size_t prefix_min, size_t prefix_max,
+    size_t key_min,    size_t key_max)
+{
+    int error_cnt = 0;
+
+    std::cerr << "Batch erase benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    std::vector<std::string> prefixes;
+    for (size_t i = 0; i < prefix_cnt; ++i)
+        prefixes.push_back(
+            generate_string(alphabet, prefix_min, prefix_max));
+
+    if (prefixes.empty()) prefixes.push_back(std::string());
+
+    typedef container::string_trie<int> trie_t;
+    trie_t trie1, trie2;
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(prefixes[::rand() % prefixes.size()] +
+            generate_string(alphabet, key_min, key_max));
+        trie1.insert(std::make_tuple(keys.back(), (int)i));
+        trie2.insert(std::make_tuple(keys.back(), (int)i));
+    }
+
+    std::vector<std::string> erased;
+    for (size_t i = 0; i < n / 4; ++i)
+        erased.push_back(keys[::rand() % n]);
+
+    // Key by key
+    double erase_time = -timestamp();
+    for (const auto & key: erased)
+        trie1.erase((const unsigned char *)key.data(), key.size());
+    erase_time += timestamp();
+
+    std::cerr << "erase time: " << erase_time << " s" << std::endl;
+
+    // Batch
+    double batch_time = -timestamp();
+    trie2.erase_many(erased);
+    batch_time += timestamp();
+
+    std::cerr << "erase_many time: " << batch_time << " s ("
+        << erase_time / batch_time << " times faster)" << std::endl;
+
+    if (trie1.size() != trie2.size() ||
+        !std::equal(trie1.begin(), trie1.end(), trie2.begin(),
+        [](const trie_t::const_iterator::deref_t & d1,
+           const trie_t::const_iterator::deref_t & d2)
+        {
+            return std::get<2>(d1) == std::get<2>(d2);
+        }))
+    {
+        std::cerr << "Batch erase mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Batch erase benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Bulk import benchmark
+ *
+ *  Import records parsing by regular expression (per line, as the
+ *  \c paths tool used to) and by the import scanner is compared.
+ *  Then, TRIE building by one-by-one insertion and by \c import_apply
+ *  is compared.
+ *
+ *  \param  n           Number of test keys generated
+ *  \param  prefix_cnt  Number of key prefixes
+ *  \param  prefix_min  Key prefix minimal length
+ *  \param  prefix_max  Key prefix maximal length
+ *  \param  key_min     Key (suffix) minimal length
+ *  \param  key_max     Key (suffix) maximal length
+ *
+ *  \return Error count
+ */
+static int import_benchmark(
+    size_t n,
+    size_t prefix_cnt, size_t prefix_min, size_t prefix_max,
+    size_t key_min,    size_t key_max)
+{
+    int error_cnt = 0;
+
+    std::cerr << "Bulk import benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 52; ++i)
+        alphabet.push_back(i < 26 ? 'a' + i : 'A' + i - 26);
 
-    std::cerr
-        << "TRIE is " << time_ratio << " times "
-        << (trie_faster ? "FASTER" : "SLOWER")
-        << " than map (that's about " << percent_diff << "%)"
-        << std::endl;
+    std::vector<std::string> prefixes;
+    for (size_t i = 0; i < prefix_cnt; ++i)
+        prefixes.push_back(
+            generate_string(alphabet, prefix_min, prefix_max));
+
+    if (prefixes.empty()) prefixes.push_back(std::string());
+
+    std::string input;
+    for (size_t i = 0; i < n; ++i) {
+        input += "A " + std::to_string(i) + ' ';
+        input += prefixes[::rand() % prefixes.size()];
+        input += generate_string(alphabet, key_min, key_max);
+        input += '\n';
+    }
+
+    std::cerr << "Input size: " << input.size() << " B" << std::endl;
+
+    // Regex parsing
+    double regex_time = -timestamp();
+    size_t regex_cnt  = 0;
+    {
+        static const std::regex line_regex(
+            "^[ \\t]*([AR])[ \\t]+(\\d+)[ \\t]+([^ \\t]*)");
+
+        std::stringstream input_ss(input);
+        std::vector<std::tuple<char, int, std::string> > records;
+        for (std::string line; std::getline(input_ss, line); ) {
+            std::smatch bref;
+            if (!std::regex_match(line, bref, line_regex)) break;
+
+            int val;
+            std::stringstream val_ss(bref[2]);
+            val_ss >> val;
+
+            records.emplace_back(bref[1].str()[0], val, bref[3]);
+        }
+
+        regex_cnt = records.size();
+    }
+    regex_time += timestamp();
+
+    std::cerr << "regex parse time: " << regex_time << " s" << std::endl;
+
+    // Scanner
+    std::vector<container::import_record> records;
+    for (size_t threads = 1; ; threads = 0) {
+        records.clear();
+
+        double scan_time = -timestamp();
+        container::parse_import(input.data(), input.size(), records, threads);
+        scan_time += timestamp();
+
+        std::cerr << "scanner parse time (" << (threads ? "1 thread" : "all")
+            << "): " << scan_time << " s ("
+            << regex_time / scan_time << " times faster, "
+            << input.size() / scan_time / (1 << 20) << " MiB/s)"
+            << std::endl;
+
+        if (0 == threads) break;
+    }
+
+    if (records.size() != regex_cnt || records.size() != n) {
+        std::cerr << "Parsed " << records.size() << " records by scanner, "
+            << regex_cnt << " by regex, expected " << n << std::endl;
+        ++error_cnt;
+    }
+
+    // TRIE building
+    typedef container::trie<container::import_record,
+        std::function<const unsigned char * (
+            const container::import_record & )>,
+        std::function<size_t (const container::import_record & )> > trie_t;
+
+    auto key = [](const container::import_record & rec) {
+        return rec.key;
+    };
+    auto key_len = [](const container::import_record & rec) {
+        return rec.len;
+    };
+    auto item = [](const container::import_record & rec) { return rec; };
+
+    trie_t trie1(key, key_len), trie2(key, key_len);
+
+    double insert_time = -timestamp();
+    for (const auto & rec: records) trie1.insert(rec);
+    insert_time += timestamp();
+
+    std::cerr << "insert time: " << insert_time << " s" << std::endl;
+
+    double apply_time = -timestamp();
+    container::import_apply(trie2, records, item);
+    apply_time += timestamp();
+
+    std::cerr << "import_apply time: " << apply_time << " s ("
+        << insert_time / apply_time << " times faster)" << std::endl;
+
+    if (trie1.size() != trie2.size()) {
+        std::cerr << "TRIE sizes differ" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Bulk import benchmark END" << std::endl;
+
+    return error_cnt;
 }
 
 
 /**
- *  \brief  String-keyed TRIE benchmark
+ *  \brief  Disk TRIE benchmark
  *
- *  \tparam  KeyTracing  Key tracing mode
+ *  Lookups/s of synchronous lookups and of asynchronous lookups
+ *  with different queue depths are measured (with cold page cache).
  *
- *  \param  n              Number of test keys generated
- *  \param  prefix_cnt     Number of common key prefixes generated
- *  \param  prefix_min     Common key prefix minimal length
- *  \param  prefix_max     Common key prefix maximal length
- *  \param  key_min        Key minimal length
- *  \param  key_max        Key maximal length
- *  \param  misses_per100  Key search miss percentage (random key used)
- *  \param  lbi_per100     Inserts to lower bound percentage (random key used)
- *  \param  dump           Dump TRIE after benchmarking
+ *  \param  n           Number of test keys generated
+ *  \param  prefix_cnt  Number of key prefixes
+ *  \param  prefix_min  Key prefix minimal length
+ *  \param  prefix_max  Key prefix maximal length
+ *  \param  key_min     Key (suffix) minimal length
+ *  \param  key_max     Key (suffix) maximal length
  *
  *  \return Error count
  */
-template <int KeyTracing>
-static int string_trie_benchmark(
+static int disk_trie_benchmark(
     size_t n,
-    size_t prefix_cnt,
-    size_t prefix_min,
-    size_t prefix_max,
-    size_t key_min,
-    size_t key_max,
-    int    misses_per100,
-    int    lbi_per100,
-    bool   dump)
+    size_t prefix_cnt, size_t prefix_min, size_t prefix_max,
+    size_t key_min,    size_t key_max)
 {
     int error_cnt = 0;
 
-    std::cerr
-        << "String TRIE benchmark (key tracing mode "
-        << KeyTracing << ") BEGIN" << std::endl;
+    std::cerr << "Disk TRIE benchmark BEGIN" << std::endl;
 
-    // Alphabet
-    size_t alphabet_size = 64;
-    std::string alphabet; alphabet.reserve(alphabet_size);
-    for (size_t i = 0; i < alphabet_size; ++i)
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
         alphabet.push_back('A' + i);
 
-    // Prefixes
-    std::vector<std::string> prefixes; prefixes.reserve(prefix_cnt);
+    std::vector<std::string> prefixes;
     for (size_t i = 0; i < prefix_cnt; ++i)
         prefixes.push_back(
             generate_string(alphabet, prefix_min, prefix_max));
 
-    // Key generator
-    auto generate_key =
-    [&alphabet, &prefixes](size_t min, size_t max) -> std::string {
-        static const std::string no_prefix("");
+    if (prefixes.empty()) prefixes.push_back(std::string());
 
-        const std::string & prefix = prefixes.size() > 0
-            ? prefixes[rand_int(0, prefixes.size() - 1)]
-            : no_prefix;
+    typedef std::tuple<std::string, uint64_t> item_t;
+    container::string_trie<uint64_t> trie;
 
-        return prefix + generate_string(alphabet,
-            min < prefix.size() ? 0 : min - prefix.size(),
-            max < prefix.size() ? 0 : max - prefix.size());
-    };
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back(prefixes[::rand() % prefixes.size()] +
+            generate_string(alphabet, key_min, key_max));
+        trie.insert(std::make_tuple(keys.back(), (uint64_t)i));
+    }
 
-    // Containers
-    std::vector<std::string> keys; keys.reserve(n);
-    container::string_trie<int, KeyTracing> trie;
-    std::map<std::string, int> map;
+    char path[] = "/tmp/libtrie_disk_XXXXXX";
+    const int fd = ::mkstemp(path);
+    if (-1 == fd) {
+        std::cerr << "Failed to create temporary file" << std::endl;
+        return 1;
+    }
 
-    // Insert benchmark
-    double trie_time = 0.0;
-    double map_time  = 0.0;
+    ::close(fd);
 
-    for (size_t i = 0; i < n; ++i) {
-        const std::string key = generate_key(key_min, key_max);
-        keys.push_back(key);
+    double write_time = -timestamp();
+    container::disk_trie::write(path, trie,
+        [](const item_t & item) { return std::get<1>(item); });
+    write_time += timestamp();
 
-        if (rand_int(0, 99) < lbi_per100) {
-            trie_time -= timestamp();
-            auto lb = trie.lower_bound(
-                (const unsigned char *)key.data(), key.size());
-            if (!container::string_trie<int, KeyTracing>::pos_match(lb))
-                trie.insert(std::make_tuple(key, (int)i), lb);
-            trie_time += timestamp();
+    std::cerr << "write time: " << write_time << " s" << std::endl;
+
+    std::vector<std::string> lookups;
+    for (size_t i = 0; i < n / 4; ++i)
+        lookups.push_back(keys[::rand() % n]);
+
+    // Queue depth 0 means synchronous lookups
+    for (size_t depth = 0; depth <= 256; depth = depth ? depth * 4 : 1) {
+        container::disk_trie disk(path, depth);
+        disk.drop_cache();
+
+        size_t found = 0;
+        double time = -timestamp();
+        if (0 == depth) {
+            uint64_t value;
+            for (const auto & key: lookups) found += disk.find(key, value);
         }
         else {
-            trie_time -= timestamp();
-            trie.insert(std::make_tuple(key, (int)i));
-            trie_time += timestamp();
+            for (const auto & key: lookups)
+                disk.async_find(key, [&found](bool f, uint64_t) {
+                    found += f;
+                });
+
+            disk.drain();
         }
+        time += timestamp();
 
-        map_time -= timestamp();
-        map.emplace(key, i);
-        map_time += timestamp();
+        std::cerr << (depth ? "async_find" : "find") << " (queue depth "
+            << depth << (depth && !disk.async() ? ", no io_uring" : "")
+            << "): " << lookups.size() / time << " lookups/s" << std::endl;
+
+        if (found != lookups.size()) {
+            std::cerr << "Found " << found << " keys, expected "
+                << lookups.size() << std::endl;
+            ++error_cnt;
+        }
     }
 
-    result("Insert", n, trie_time, map_time);
+    ::unlink(path);
 
-    // Find benchmark
-    trie_time = 0.0;
-    map_time  = 0.0;
+    std::cerr << "Disk TRIE benchmark END" << std::endl;
 
-    for (size_t i = 0; i < n; ++i) {
-        int key_ix = -1;
-        const std::string key = rand_int(0, 99) < misses_per100
-            ? generate_key(key_min, key_max)
-            : keys[key_ix = rand_int(0, keys.size() - 1)];
+    return error_cnt;
+}
 
-        trie_time -= timestamp();
-        trie.find((const unsigned char *)key.data(), key.size());
-        trie_time += timestamp();
 
-        map_time -= timestamp();
-        map.find(key);
-        map_time += timestamp();
+/**
+ *  \brief  Front-coded iteration benchmark
+ *
+ *  Sorted keys are written front-coded (shared prefix length, suffix
+ *  length and suffix bytes).
+ *  Plain iteration compares each key with the previous one; front-coded
+ *  iteration gets the shared prefix lengths from the traversal.
+ *
+ *  \param  n           Number of keys
+ *  \param  prefix_cnt  Number of common prefixes
+ *  \param  prefix_min  Min. prefix length
+ *  \param  prefix_max  Max. prefix length
+ *  \param  key_min     Min. key suffix length
+ *  \param  key_max     Max. key suffix length
+ */
+static int front_coded_benchmark(
+    size_t n,
+    size_t prefix_cnt, size_t prefix_min, size_t prefix_max,
+    size_t key_min,    size_t key_max)
+{
+    int error_cnt = 0;
+
+    std::cerr << "Front-coded iteration benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    std::vector<std::string> prefixes;
+    for (size_t i = 0; i < prefix_cnt; ++i)
+        prefixes.push_back(
+            generate_string(alphabet, prefix_min, prefix_max));
+
+    if (prefixes.empty()) prefixes.push_back(std::string());
+
+    typedef container::string_trie<int> trie_t;
+    trie_t trie;
+
+    for (size_t i = 0; i < n; ++i)
+        trie.insert(std::make_tuple(
+            prefixes[::rand() % prefixes.size()] +
+            generate_string(alphabet, key_min, key_max), (int)i));
+
+    typedef std::vector<unsigned char> output_t;
+    auto write_len = [](output_t & out, size_t len) {
+        for (; len >= 0x80; len >>= 7)
+            out.push_back((unsigned char)(0x80 | (len & 0x7f)));
+        out.push_back((unsigned char)len);
+    };
+
+    auto write = [&write_len](output_t & out,
+        size_t shared, const unsigned char * suffix, size_t suffix_len)
+    {
+        write_len(out, shared);
+        write_len(out, suffix_len);
+        out.insert(out.end(), suffix, suffix + suffix_len);
+    };
+
+    // Plain iteration (shared prefix by byte comparison)
+    output_t plain;
+    plain.reserve(n * (2 + prefix_max + key_max));
+
+    double plain_time = -timestamp();
+    const unsigned char * prev = NULL;
+    size_t prev_len = 0;
+    for (auto iter = trie.begin(); iter != trie.end(); ++iter) {
+        const unsigned char * key = std::get<0>(*iter);
+        const size_t          len = std::get<1>(*iter);
+
+        size_t shared = 0;
+        while (shared < prev_len && shared < len &&
+            prev[shared] == key[shared]) ++shared;
+
+        write(plain, shared, key + shared, len - shared);
+        prev     = key;
+        prev_len = len;
     }
+    plain_time += timestamp();
 
-    result("Search", n, trie_time, map_time);
+    std::cerr << "Plain iteration: " << plain_time << " s" << std::endl;
 
-    if (dump) print_trie(std::cout, trie);
+    // Front-coded iteration
+    output_t front_coded;
+    front_coded.reserve(plain.size());
 
-    std::cerr << "String TRIE benchmark END" << std::endl;
+    double fc_time = -timestamp();
+    for (auto iter = trie.front_coded_begin();
+         iter != trie.front_coded_end(); ++iter)
+    {
+        write(front_coded,
+            std::get<0>(*iter), std::get<1>(*iter), std::get<2>(*iter));
+    }
+    fc_time += timestamp();
+
+    std::cerr << "Front-coded iteration: " << fc_time << " s ("
+        << plain_time / fc_time << " times faster), "
+        << front_coded.size() << " bytes" << std::endl;
+
+    if (plain != front_coded) {
+        std::cerr << "Front-coded output mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Front-coded iteration benchmark END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/**
+ *  \brief  Ordered scan benchmark (implementation)
+ *
+ *  \param  keys      Keys (inserted in the order given)
+ *  \param  passes    Number of full scans
+ *  \param  time      Scan time
+ *  \param  checksum  Checksum of the scanned items
+ */
+template <int Features>
+static void scan_benchmark_impl(
+    const std::vector<std::string> & keys,
+    size_t                           passes,
+    double &                         time,
+    uint64_t &                       checksum)
+{
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT, Features> trie_t;
+    trie_t trie;
+
+    for (size_t i = 0; i < keys.size(); ++i)
+        trie.insert(std::make_tuple(keys[i], (int)i));
+
+    checksum = 0;
+
+    time = -timestamp();
+    for (size_t pass = 0; pass < passes; ++pass)
+        for (auto iter = trie.begin(); iter != trie.end(); ++iter)
+            checksum += std::get<1>(*iter) +
+                std::get<1>(std::get<2>(*iter));
+    time += timestamp();
+
+    std::cerr
+        << "Features " << Features << ": scan throughput: "
+        << passes * trie.size() / time << " items/s" << std::endl;
+}
+
+/**
+ *  \brief  Ordered scan benchmark
+ *
+ *  Full scans of TRIE with and without sub-tree prefetching.
+ *
+ *  \param  n        Number of keys
+ *  \param  key_min  Min. key length
+ *  \param  key_max  Max. key length
+ */
+static int scan_benchmark(size_t n, size_t key_min, size_t key_max) {
+    int error_cnt = 0;
+
+    std::cerr << "Scan benchmark BEGIN" << std::endl;
+
+    std::string alphabet;
+    for (size_t i = 0; i < 64; ++i)
+        alphabet.push_back('A' + i);
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i)
+        keys.push_back(generate_string(alphabet, key_min, key_max));
+
+    const size_t passes = 5;
+
+    double   time,     prefetch_time;
+    uint64_t checksum, prefetch_checksum;
+
+    scan_benchmark_impl<0>(keys, passes, time, checksum);
+    scan_benchmark_impl<container::TRIE_SCAN_PREFETCH>(
+        keys, passes, prefetch_time, prefetch_checksum);
+
+    std::cerr
+        << "Prefetching scan is " << time / prefetch_time
+        << " times faster" << std::endl;
+
+    if (checksum != prefetch_checksum) {
+        std::cerr << "Scan checksum mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Scan benchmark END" << std::endl;
 
     return error_cnt;
 }
@@ -323,13 +1724,14 @@ static int main_impl(int argc, char * const argv[]) {
     size_t key_max       = 256;
     int    misses_per100 = 15;
     int    lbi_per100    = 25;
+    size_t slob_qlen     = 32;
     bool   dump          = false;
 
     // Usage
     auto usage = [&argv,
         n, prefix_cnt, prefix_min, prefix_max,
         key_min, key_max,
-        misses_per100, lbi_per100,
+        misses_per100, lbi_per100, slob_qlen,
         dump]()
     { std::cerr <<
 "Usage: " << argv[0] << " [OPTIONS]\n\n"
@@ -353,6 +1755,8 @@ static int main_impl(int argc, char * const argv[]) {
 "                               default: " << misses_per100 << "\n"
 "    -l, --lbi-per100     <%>   Lower bound inserts (in %)\n"
 "                               default: " << lbi_per100 << "\n"
+"    -t, --slob-threshold <q>   Slobby tracing verification threshold\n"
+"                               (in quad-bits), default: " << slob_qlen << "\n"
 "    -d, --dump                 Dump resulting trie to stdout\n"
 "                               default: " << dump << "\n"
 "\n"; };
@@ -371,6 +1775,7 @@ static int main_impl(int argc, char * const argv[]) {
         { "key-max",        required_argument, NULL, 'K' },
         { "misses-per100",  required_argument, NULL, 'm' },
         { "lbi-per100",     required_argument, NULL, 'l' },
+        { "slob-threshold", required_argument, NULL, 't' },
         { "dump",           no_argument,       NULL, 'd' },
 
         //{ "", required|no_argument, NULL, '' },
@@ -381,7 +1786,7 @@ static int main_impl(int argc, char * const argv[]) {
     for (;;) {
         int long_opt_ix;
         int opt = getopt_long(argc, argv,
-            ":hs:n:c:p:P:k:K:m:l:d",
+            ":hs:n:c:p:P:k:K:m:l:t:d",
             long_opts, &long_opt_ix);
 
         if (-1 == opt) break;  // no more options
@@ -429,6 +1834,10 @@ static int main_impl(int argc, char * const argv[]) {
                 lbi_per100 = ::atoi(optarg);
                 break;
 
+            case 't':  // slobby tracing verification threshold
+                slob_qlen = ::atoi(optarg);
+                break;
+
             case 'd':  // dump TRIE after benchmark
                 dump = true;
                 break;
@@ -454,7 +1863,27 @@ static int main_impl(int argc, char * const argv[]) {
     exit_code = string_trie_benchmark<container::TRIE_KEY_TRACING_STRICT>(
         n, prefix_cnt, prefix_min, prefix_max,
         key_min, key_max,
-        misses_per100, lbi_per100,
+        misses_per100, lbi_per100, slob_qlen,
+        dump);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = string_trie_benchmark<
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_FINGERPRINTS>(
+        n, prefix_cnt, prefix_min, prefix_max,
+        key_min, key_max,
+        misses_per100, lbi_per100, slob_qlen,
+        dump);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = string_trie_benchmark<
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_ACCESS_SAMPLING>(
+        n, prefix_cnt, prefix_min, prefix_max,
+        key_min, key_max,
+        misses_per100, lbi_per100, slob_qlen,
         dump);
 
     if (0 != exit_code) return exit_code;
@@ -462,9 +1891,77 @@ static int main_impl(int argc, char * const argv[]) {
     exit_code = string_trie_benchmark<container::TRIE_KEY_TRACING_SLOBBY>(
         n, prefix_cnt, prefix_min, prefix_max,
         key_min, key_max,
-        misses_per100, lbi_per100,
+        misses_per100, lbi_per100, slob_qlen,
+        dump);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = string_trie_benchmark<
+        container::TRIE_KEY_TRACING_SLOBBY_THRESHOLD>(
+        n, prefix_cnt, prefix_min, prefix_max,
+        key_min, key_max,
+        misses_per100, lbi_per100, slob_qlen,
         dump);
 
+    if (0 != exit_code) return exit_code;
+
+    exit_code = trie_sort_benchmark(
+        n, prefix_cnt, prefix_min, prefix_max, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = export_benchmark(n, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = diff_benchmark(n, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = counting_benchmark(n, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = aggregation_benchmark(
+        n, prefix_cnt, prefix_min, prefix_max, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = huge_pages_benchmark(n, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = relayout_benchmark(n, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = find_sorted_benchmark(
+        n, prefix_cnt, prefix_min, prefix_max, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = erase_many_benchmark(
+        n, prefix_cnt, prefix_min, prefix_max, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = import_benchmark(
+        n, prefix_cnt, prefix_min, prefix_max, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = disk_trie_benchmark(
+        n, prefix_cnt, prefix_min, prefix_max, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = front_coded_benchmark(
+        n, prefix_cnt, prefix_min, prefix_max, key_min, key_max);
+
+    if (0 != exit_code) return exit_code;
+
+    exit_code = scan_benchmark(n, key_min, key_max);
+
     return exit_code;
 }
 
@@ -1,3 +1,3 @@
 #!/bin/sh
 
-./benchmark
+./benchmark -n 200000
@@ -0,0 +1,553 @@
+/**
+ *  \file
+ *  \brief  TRIE server load generator
+ *
+ *  Client for the TRIE server (see \c server.cxx).
+ *  Inserts generated keys and then issues mix of find, prefix and range
+ *  requests, keeping a configurable number of requests in flight.
+ *  Responses are checked against a local \c std::map and requests/s
+ *  together with latency percentiles are reported.
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "protocol.hxx"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+extern "C" {
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/socket.h>
+}
+
+
+/**
+ *  \brief  Get timestamp
+ *
+ *  Uses monotonic clock to obtain high-precision timestamp.
+ *
+ *  \return Timestamp (in seconds)
+ */
+inline static double timestamp() {
+    struct timespec tspec;
+    assert(-1 != clock_gettime(CLOCK_MONOTONIC_RAW, &tspec));
+
+    return (double)tspec.tv_sec + (double)tspec.tv_nsec / 1000000000.0;
+}
+
+/**
+ *  \brief  Random key
+ *
+ *  \param  len_min  Key min. length
+ *  \param  len_max  Key max. length
+ *
+ *  \return Random key (of lower-case letters)
+ */
+static std::string random_key(size_t len_min, size_t len_max) {
+    size_t len = len_min + ::rand() % (len_max - len_min + 1);
+
+    std::string key; key.reserve(len);
+    for (; len; --len) key.push_back('a' + ::rand() % 26);
+
+    return key;
+}
+
+
+/** Pipelining client */
+class client {
+    public:
+
+    /** Expected response */
+    struct expect {
+        uint8_t     status;   /**< Expected status                     */
+        uint32_t    count;    /**< Expected items count                */
+        std::string value;    /**< Expected value (of the 1st item)    */
+        double      sent_at;  /**< Request timestamp                   */
+
+        expect(uint8_t _status, uint32_t _count, const std::string & _value):
+            status(_status), count(_count), value(_value), sent_at(0.0)
+        {}
+
+    };  // end of struct expect
+
+    /**
+     *  \brief  Request generator
+     *
+     *  Appends request to the buffer, returns expected response.
+     */
+    typedef std::function<expect (std::string & buff, uint32_t id)>
+        generator_t;
+
+    private:
+
+    int                  m_sock;       /**< Server connection  */
+    uint32_t             m_id;         /**< Next request ID    */
+    std::vector<double>  m_latencies;  /**< Request latencies  */
+    size_t               m_errors;     /**< Response mismatches */
+
+    /**
+     *  \brief  Check response against expectation
+     *
+     *  \param  hdr      Response header
+     *  \param  payload  Response payload
+     *  \param  exp      Expected response
+     */
+    void check(
+        const protocol::response_hdr & hdr,
+        const char *                   payload,
+        const expect &                 exp)
+    {
+        bool ok = hdr.status == exp.status && hdr.count == exp.count;
+
+        if (ok && !exp.value.empty()) {
+            protocol::item_hdr ihdr;
+            ::memcpy(&ihdr, payload, sizeof(ihdr));
+
+            ok = ihdr.val_len == exp.value.size() && 0 == ::memcmp(
+                payload + sizeof(ihdr) + ihdr.key_len,
+                exp.value.data(), exp.value.size());
+        }
+
+        if (!ok) {
+            if (m_errors < 10)
+                std::cerr
+                    << "Unexpected response to request " << hdr.id
+                    << ": status " << (int)hdr.status
+                    << " (expected " << (int)exp.status << "), "
+                    << hdr.count << " items (expected " << exp.count << ")"
+                    << std::endl;
+
+            ++m_errors;
+        }
+    }
+
+    public:
+
+    /**
+     *  \brief  Constructor
+     *
+     *  \param  path  Server socket path
+     */
+    client(const std::string & path):
+        m_sock   ( protocol::connect(path) ),
+        m_id     ( 0 ),
+        m_errors ( 0 )
+    {
+        protocol::set_nonblocking(m_sock);
+    }
+
+    /** Response mismatches count getter */
+    inline size_t errors() const { return m_errors; }
+
+    /**
+     *  \brief  Run requests
+     *
+     *  \param  name   Run name (for report)
+     *  \param  cnt    Number of requests
+     *  \param  depth  Max. number of requests in flight
+     *  \param  gen    Request generator
+     */
+    void run(
+        const std::string & name,
+        size_t              cnt,
+        size_t              depth,
+        generator_t         gen)
+    {
+        std::deque<expect> inflight;
+        std::string out, in;
+        size_t out_pos = 0, sent = 0, done = 0;
+
+        m_latencies.clear();
+        m_latencies.reserve(cnt);
+
+        const double begin = timestamp();
+
+        while (done < cnt) {
+            // Fill the pipeline
+            const double now = timestamp();
+            for (; inflight.size() < depth && sent < cnt; ++sent) {
+                inflight.push_back(gen(out, m_id++));
+                inflight.back().sent_at = now;
+            }
+
+            struct pollfd pfd;
+            pfd.fd      = m_sock;
+            pfd.events  = POLLIN | (out_pos < out.size() ? POLLOUT : 0);
+            pfd.revents = 0;
+
+            if (-1 == ::poll(&pfd, 1, -1)) {
+                if (EINTR == errno) continue;
+                protocol::throw_errno("poll");
+            }
+
+            if (pfd.revents & POLLOUT) {
+                ssize_t wcnt = ::send(m_sock, out.data() + out_pos,
+                    out.size() - out_pos, MSG_NOSIGNAL);
+
+                if (-1 == wcnt) {
+                    if (EAGAIN != errno && EINTR != errno)
+                        protocol::throw_errno("send");
+                }
+                else if ((out_pos += wcnt) == out.size()) {
+                    out.clear();
+                    out_pos = 0;
+                }
+            }
+
+            if (!(pfd.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            char buff[64 * 1024];
+            ssize_t rcnt = ::read(m_sock, buff, sizeof(buff));
+            if (-1 == rcnt) {
+                if (EAGAIN == errno || EINTR == errno) continue;
+                protocol::throw_errno("read");
+            }
+
+            if (0 == rcnt)
+                throw std::runtime_error("server closed connection");
+
+            in.append(buff, rcnt);
+
+            // Process complete responses
+            const double recv_at = timestamp();
+            const size_t hdr_size = sizeof(protocol::response_hdr);
+            size_t pos = 0;
+
+            while (in.size() - pos >= hdr_size) {
+                protocol::response_hdr hdr;
+                ::memcpy(&hdr, in.data() + pos, hdr_size);
+                if (in.size() - pos - hdr_size < hdr.len) break;
+
+                if (inflight.empty())
+                    throw std::runtime_error("unsolicited response");
+
+                check(hdr, in.data() + pos + hdr_size, inflight.front());
+                m_latencies.push_back(recv_at - inflight.front().sent_at);
+                inflight.pop_front();
+
+                pos += hdr_size + hdr.len;
+                ++done;
+            }
+
+            in.erase(0, pos);
+        }
+
+        const double time = timestamp() - begin;
+
+        // Report
+        std::sort(m_latencies.begin(), m_latencies.end());
+        auto percentile = [this](double p) -> double {
+            size_t ix = (size_t)(p * (m_latencies.size() - 1));
+            return m_latencies[ix] * 1000000.0;
+        };
+
+        std::cerr
+            << name << ": " << cnt << " requests in " << time << " s, "
+            << (size_t)(cnt / time) << " requests/s (depth " << depth
+            << ")" << std::endl
+            << "Latency [us]: p50 " << percentile(0.5)
+            << ", p90 " << percentile(0.9)
+            << ", p99 " << percentile(0.99)
+            << ", p99.9 " << percentile(0.999)
+            << ", max " << percentile(1.0) << std::endl;
+    }
+
+    /** Destructor */
+    ~client() { ::close(m_sock); }
+
+};  // end of class client
+
+
+/** Main routine (implementation) */
+static int main_impl(int argc, char * const argv[]) {
+    unsigned rng_seed = 0;  // random number generator seed
+
+    // Default parameters
+    std::string path     = "trie.sock";
+    size_t n             = 100000;
+    size_t loops         = 1000000;
+    size_t depth         = 64;
+    size_t key_min       = 4;
+    size_t key_max       = 24;
+    int    misses_per100 = 15;
+    int    scans_per100  = 5;
+
+    // Usage
+    auto usage = [&argv, &path,
+        n, loops, depth, key_min, key_max, misses_per100, scans_per100]()
+    { std::cerr <<
+"Usage: " << argv[0] << " [OPTIONS]\n\n"
+"OPTIONS:\n"
+"    -h, --help                 show help and exit\n"
+"    -s, --rng-seed <seed>      RNG seed (0 means current time)\n"
+"    -S, --socket <path>        Server socket path\n"
+"                               default: " << path << "\n"
+"\n"
+"    -n, --key-count    <cnt>   Number of inserted keys\n"
+"                               default: " << n << "\n"
+"    -N, --loop-count   <cnt>   Number of lookup requests\n"
+"                               default: " << loops << "\n"
+"    -d, --depth        <cnt>   Max. number of requests in flight\n"
+"                               default: " << depth << "\n"
+"    -k, --key-min      <min>   Key min. length\n"
+"                               default: " << key_min << "\n"
+"    -K, --key-max      <max>   Key max. length\n"
+"                               default: " << key_max << "\n"
+"    -m, --misses-per100  <%>   Find key misses (in %)\n"
+"                               default: " << misses_per100 << "\n"
+"    -p, --scans-per100   <%>   Prefix and range requests (in %)\n"
+"                               default: " << scans_per100 << "\n"
+"\n"; };
+
+    // Options
+    static const struct option long_opts[] {
+        { "help",     no_argument,       NULL, 'h' },
+        { "rng-seed", required_argument, NULL, 's' },
+        { "socket",   required_argument, NULL, 'S' },
+
+        // Load parameters
+        { "key-count",      required_argument, NULL, 'n' },
+        { "loop-count",     required_argument, NULL, 'N' },
+        { "depth",          required_argument, NULL, 'd' },
+        { "key-min",        required_argument, NULL, 'k' },
+        { "key-max",        required_argument, NULL, 'K' },
+        { "misses-per100",  required_argument, NULL, 'm' },
+        { "scans-per100",   required_argument, NULL, 'p' },
+
+        { NULL, 0, NULL, '\0' }  // terminator
+    };
+
+    for (;;) {
+        int long_opt_ix;
+        int opt = getopt_long(argc, argv,
+            ":hs:S:n:N:d:k:K:m:p:",
+            long_opts, &long_opt_ix);
+
+        if (-1 == opt) break;  // no more options
+
+        switch (opt) {
+            case 'h':  // help
+                usage();
+                ::exit(0);
+                break;
+
+            case 's':  // RNG seed
+                rng_seed = ::atoi(optarg);
+                break;
+
+            case 'S':  // socket path
+                path = optarg;
+                break;
+
+            case 'n':  // key count
+                n = ::atoi(optarg);
+                break;
+
+            case 'N':  // loop count
+                loops = ::atoi(optarg);
+                break;
+
+            case 'd':  // pipeline depth
+                depth = ::atoi(optarg);
+                break;
+
+            case 'k':  // key min. length
+                key_min = ::atoi(optarg);
+                break;
+
+            case 'K':  // key max. length
+                key_max = ::atoi(optarg);
+                break;
+
+            case 'm':  // find misses [%]
+                misses_per100 = ::atoi(optarg);
+                break;
+
+            case 'p':  // prefix & range requests [%]
+                scans_per100 = ::atoi(optarg);
+                break;
+
+            case '?':  // unknown option
+            case ':':  // missing argument
+                usage();
+                ::exit(1);
+
+            default:  // internal error (forgotten option)
+                std::cerr
+                    << "INTERNAL ERROR: forgotten option " << (char)opt
+                    << std::endl;
+                ::abort();
+        }
+    }
+
+    if (0 == depth || key_min > key_max) {
+        usage();
+        return 1;
+    }
+
+    // Seed RNG
+    if (0 == rng_seed) rng_seed = (unsigned)::time(NULL);
+    ::srand(rng_seed);
+    std::cerr << "RNG seeded with " << rng_seed << std::endl;
+
+    // Generate keys (the server is expected to be empty)
+    std::map<std::string, std::string> map;
+    std::vector<std::string> keys; keys.reserve(n);
+
+    while (keys.size() < n) {
+        std::string key = random_key(key_min, key_max);
+        std::stringstream val_ss; val_ss << keys.size();
+
+        if (map.emplace(key, val_ss.str()).second) keys.push_back(key);
+    }
+
+    client cl(path);
+
+    // Insertions
+    size_t key_ix = 0;
+    cl.run("Insert", n, depth,
+    [&keys, &map, &key_ix](std::string & buff, uint32_t id) -> client::expect {
+        const std::string & key = keys[key_ix++];
+        const std::string & val = map[key];
+
+        protocol::append_request(buff, id, protocol::OP_INSERT,
+            key.data(), key.size(), val.data(), val.size());
+
+        return client::expect(protocol::ST_OK, 0, "");
+    });
+
+    // Lookups
+    cl.run("Lookup", loops, depth,
+    [&keys, &map, key_min, key_max, misses_per100, scans_per100](
+        std::string & buff, uint32_t id) -> client::expect
+    {
+        static const uint32_t limit = 16;
+
+        // Prefix or range scan
+        if (::rand() % 100 < scans_per100) {
+            const std::string & key = keys[::rand() % keys.size()];
+            const std::string prefix = key.substr(0, 1 + key.size() / 4);
+
+            auto iter = map.lower_bound(prefix);
+            uint32_t cnt = 0;
+
+            if (::rand() % 2) {  // prefix
+                for (; map.end() != iter && cnt < limit; ++iter, ++cnt)
+                    if (0 != iter->first.compare(0, prefix.size(), prefix))
+                        break;
+
+                protocol::append_request(buff, id, protocol::OP_PREFIX,
+                    prefix.data(), prefix.size(), NULL, 0, limit);
+            }
+            else {  // range [prefix, key)
+                for (; map.end() != iter && cnt < limit; ++iter, ++cnt)
+                    if (iter->first >= key) break;
+
+                protocol::append_request(buff, id, protocol::OP_RANGE,
+                    prefix.data(), prefix.size(),
+                    key.data(), key.size(), limit);
+            }
+
+            return client::expect(protocol::ST_OK, cnt, "");
+        }
+
+        // Find miss
+        if (::rand() % 100 < misses_per100) {
+            const std::string key = random_key(key_min, key_max);
+            protocol::append_request(buff, id, protocol::OP_FIND,
+                key.data(), key.size());
+
+            auto iter = map.find(key);
+            return map.end() == iter
+                ? client::expect(protocol::ST_NOT_FOUND, 0, "")
+                : client::expect(protocol::ST_OK, 1, iter->second);
+        }
+
+        // Find hit
+        const std::string & key = keys[::rand() % keys.size()];
+        protocol::append_request(buff, id, protocol::OP_FIND,
+            key.data(), key.size());
+
+        return client::expect(protocol::ST_OK, 1, map[key]);
+    });
+
+    std::cerr << "Response mismatches: " << cl.errors() << std::endl;
+
+    return cl.errors() ? 1 : 0;
+}
+
+/** Main routine (exception-safe wrapper) */
+int main(int argc, char * const argv[]) {
+    int exit_code = 128;
+
+    try {
+        exit_code = main_impl(argc, argv);
+    }
+    catch (const std::exception & x) {
+        std::cerr
+            << "Standard exception caught: "
+            << x.what()
+            << std::endl;
+    }
+    catch (...) {
+        std::cerr
+            << "Unhandled non-standard exception caught"
+            << std::endl;
+    }
+
+    std::cerr
+        << "Exit code: " << exit_code
+        << std::endl;
+
+    return exit_code;
+}
@@ -0,0 +1,433 @@
+/**
+ *  \file
+ *  \brief  Range-partitioned TRIE deployment test
+ *
+ *  Worker processes (TRIE servers) are spawned locally, each owning
+ *  a key range; requests are routed to them over Unix sockets.
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "router.hxx"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <cassert>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+extern "C" {
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+}
+
+
+/**
+ *  \brief  Get timestamp
+ *
+ *  Uses monotonic clock to obtain high-precision timestamp.
+ *
+ *  \return Timestamp (in seconds)
+ */
+inline static double timestamp() {
+    struct timespec tspec;
+    assert(-1 != clock_gettime(CLOCK_MONOTONIC_RAW, &tspec));
+
+    return (double)tspec.tv_sec + (double)tspec.tv_nsec / 1000000000.0;
+}
+
+/**
+ *  \brief  Random key
+ *
+ *  \param  len_min  Key min. length
+ *  \param  len_max  Key max. length
+ *
+ *  \return Random key (of lower-case letters)
+ */
+static std::string random_key(size_t len_min, size_t len_max) {
+    size_t len = len_min + ::rand() % (len_max - len_min + 1);
+
+    std::string key; key.reserve(len);
+    for (; len; --len) key.push_back('a' + ::rand() % 26);
+
+    return key;
+}
+
+
+/** Worker processes */
+class workers {
+    private:
+
+    std::vector<pid_t>       m_pids;   /**< Worker PIDs         */
+    std::vector<std::string> m_paths;  /**< Worker socket paths */
+
+    public:
+
+    /**
+     *  \brief  Spawn workers
+     *
+     *  \param  server  Server executable
+     *  \param  cnt     Number of workers
+     */
+    workers(const std::string & server, size_t cnt) {
+        for (size_t i = 0; i < cnt; ++i) {
+            std::stringstream path_ss;
+            path_ss << "./partition." << ::getpid() << '.' << i << ".sock";
+            const std::string path = path_ss.str();
+            ::unlink(path.c_str());
+
+            const pid_t pid = ::fork();
+            if (-1 == pid) protocol::throw_errno("fork");
+
+            if (0 == pid) {  // worker
+                ::execl(server.c_str(), server.c_str(),
+                    "-s", path.c_str(), (char *)NULL);
+                ::_exit(127);
+            }
+
+            m_pids.push_back(pid);
+            m_paths.push_back(path);
+        }
+
+        // Wait for the workers to listen
+        for (const auto & path: m_paths) {
+            struct stat st;
+            for (int i = 0; i < 100 && -1 == ::stat(path.c_str(), &st); ++i)
+                ::usleep(100000);
+        }
+    }
+
+    /** Worker socket paths */
+    inline const std::vector<std::string> & paths() const { return m_paths; }
+
+    /** Terminate workers */
+    ~workers() {
+        for (pid_t pid: m_pids) ::kill(pid, SIGTERM);
+        for (pid_t pid: m_pids) ::waitpid(pid, NULL, 0);
+    }
+
+};  // end of class workers
+
+
+/**
+ *  \brief  Check router content against map
+ *
+ *  \param  rt   Router
+ *  \param  map  Expected content
+ *
+ *  \return Error count
+ */
+static int check_content(
+    router &                                   rt,
+    const std::map<std::string, std::string> & map)
+{
+    int error_cnt = 0;
+
+    // Full scan (fanned out to all partitions)
+    router::items_t items;
+    const double scan_time = -timestamp();
+    rt.scan("", "", items);
+    std::cerr << "Full scan: " << items.size() << " items in "
+        << scan_time + timestamp() << " s" << std::endl;
+
+    if (items != router::items_t(map.begin(), map.end())) {
+        std::cerr << "Full scan mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    // Lookups
+    for (const auto & item: map) {
+        std::string val;
+        if (!rt.find(item.first, val) || val != item.second) {
+            std::cerr << "Key " << item.first << " not found" << std::endl;
+            ++error_cnt;
+            break;
+        }
+    }
+
+    // Bounded scans (crossing partitions)
+    for (int i = 0; i < 200; ++i) {
+        std::string from = random_key(0, 3), to = random_key(1, 3);
+        if (to < from) std::swap(from, to);
+
+        const uint32_t limit = ::rand() % 2 ? 0 : 1 + ::rand() % 50;
+
+        router::items_t range;
+        rt.scan(from, to, range, limit);
+
+        router::items_t expected;
+        for (auto iter = map.lower_bound(from);
+            map.end() != iter && iter->first < to &&
+            (!limit || expected.size() < limit); ++iter)
+        {
+            expected.push_back(*iter);
+        }
+
+        if (range != expected) {
+            std::cerr << "Scan [" << from << ", " << to << ") mismatch: "
+                << range.size() << " items, expected " << expected.size()
+                << std::endl;
+            ++error_cnt;
+            break;
+        }
+    }
+
+    return error_cnt;
+}
+
+
+/** Main routine (implementation) */
+static int main_impl(int argc, char * const argv[]) {
+    unsigned rng_seed = 0;  // random number generator seed
+
+    // Default parameters
+    std::string server      = "./server";
+    size_t      workers_cnt = 4;
+    size_t      n           = 20000;
+    size_t      key_min     = 4;
+    size_t      key_max     = 24;
+
+    // Usage
+    auto usage = [&argv, &server, workers_cnt, n, key_min, key_max]()
+    { std::cerr <<
+"Usage: " << argv[0] << " [OPTIONS]\n\n"
+"OPTIONS:\n"
+"    -h, --help                 show help and exit\n"
+"    -s, --rng-seed <seed>      RNG seed (0 means current time)\n"
+"    -S, --server <path>        Server (worker) executable\n"
+"                               default: " << server << "\n"
+"\n"
+"    -w, --workers      <cnt>   Number of workers (partitions)\n"
+"                               default: " << workers_cnt << "\n"
+"    -n, --key-count    <cnt>   Number of keys\n"
+"                               default: " << n << "\n"
+"    -k, --key-min      <min>   Key min. length\n"
+"                               default: " << key_min << "\n"
+"    -K, --key-max      <max>   Key max. length\n"
+"                               default: " << key_max << "\n"
+"\n"; };
+
+    // Options
+    static const struct option long_opts[] {
+        { "help",      no_argument,       NULL, 'h' },
+        { "rng-seed",  required_argument, NULL, 's' },
+        { "server",    required_argument, NULL, 'S' },
+        { "workers",   required_argument, NULL, 'w' },
+        { "key-count", required_argument, NULL, 'n' },
+        { "key-min",   required_argument, NULL, 'k' },
+        { "key-max",   required_argument, NULL, 'K' },
+
+        { NULL, 0, NULL, '\0' }  // terminator
+    };
+
+    for (;;) {
+        int long_opt_ix;
+        int opt = getopt_long(argc, argv, ":hs:S:w:n:k:K:",
+            long_opts, &long_opt_ix);
+
+        if (-1 == opt) break;  // no more options
+
+        switch (opt) {
+            case 'h':  // help
+                usage();
+                ::exit(0);
+                break;
+
+            case 's':  // RNG seed
+                rng_seed = ::atoi(optarg);
+                break;
+
+            case 'S':  // server executable
+                server = optarg;
+                break;
+
+            case 'w':  // workers
+                workers_cnt = ::atoi(optarg);
+                break;
+
+            case 'n':  // key count
+                n = ::atoi(optarg);
+                break;
+
+            case 'k':  // key min. length
+                key_min = ::atoi(optarg);
+                break;
+
+            case 'K':  // key max. length
+                key_max = ::atoi(optarg);
+                break;
+
+            case '?':  // unknown option
+            case ':':  // missing argument
+                usage();
+                ::exit(1);
+
+            default:  // internal error (forgotten option)
+                std::cerr
+                    << "INTERNAL ERROR: forgotten option " << (char)opt
+                    << std::endl;
+                ::abort();
+        }
+    }
+
+    if (0 == workers_cnt || workers_cnt > 26 || key_min > key_max) {
+        usage();
+        return 1;
+    }
+
+    // Seed RNG
+    if (0 == rng_seed) rng_seed = (unsigned)::time(NULL);
+    ::srand(rng_seed);
+    std::cerr << "RNG seeded with " << rng_seed << std::endl;
+
+    int error_cnt = 0;
+
+    workers wrk(server, workers_cnt);
+
+    // Skewed initial bounds (b, c, d...), most keys go to the last worker
+    std::vector<std::string> bounds;
+    for (size_t i = 1; i < workers_cnt; ++i)
+        bounds.push_back(std::string(1, 'a' + i));
+
+    router rt(wrk.paths(), bounds);
+
+    // Bulk load
+    std::map<std::string, std::string> map;
+    while (map.size() < n) {
+        std::stringstream val_ss; val_ss << map.size();
+        map.emplace(random_key(key_min, key_max), val_ss.str());
+    }
+
+    router::items_t items(map.begin(), map.end());
+
+    double time = -timestamp();
+    const size_t imported = rt.import(items);
+    time += timestamp();
+
+    std::cerr << "Imported " << imported << " items in " << time << " s"
+        << std::endl;
+
+    if (imported != n) ++error_cnt;
+
+    // Single key requests
+    for (int i = 0; i < 1000; ++i) {
+        const std::string key = random_key(key_min, key_max);
+        const bool exists = map.count(key);
+        const bool erase  = ::rand() % 2;
+
+        if (erase) {
+            if (rt.erase(key) != exists) ++error_cnt;
+            map.erase(key);
+        }
+        else {
+            if (rt.insert(key, "new") == exists) ++error_cnt;
+            map.emplace(key, "new");
+        }
+    }
+
+    if (error_cnt)
+        std::cerr << "Single key requests failed" << std::endl;
+
+    error_cnt += check_content(rt, map);
+
+    // Rebalance
+    std::vector<size_t> counts;
+    rt.count(counts);
+    std::cerr << "Partition sizes:";
+    for (size_t cnt: counts) std::cerr << ' ' << cnt;
+    std::cerr << std::endl;
+
+    time = -timestamp();
+    const size_t moved = rt.rebalance();
+    time += timestamp();
+
+    rt.count(counts);
+    std::cerr << "Rebalanced (moved " << moved << " items in " << time
+        << " s), partition sizes:";
+    for (size_t cnt: counts) std::cerr << ' ' << cnt;
+    std::cerr << std::endl;
+
+    for (size_t i = 0; i < counts.size(); ++i)
+        if (counts[i] > map.size() / counts.size() + 1 ||
+            counts[i] + 1 < map.size() / counts.size())
+        {
+            std::cerr << "Partitions not balanced" << std::endl;
+            ++error_cnt;
+            break;
+        }
+
+    error_cnt += check_content(rt, map);
+
+    return error_cnt ? 1 : 0;
+}
+
+/** Main routine (exception-safe wrapper) */
+int main(int argc, char * const argv[]) {
+    int exit_code = 128;
+
+    try {
+        exit_code = main_impl(argc, argv);
+    }
+    catch (const std::exception & x) {
+        std::cerr
+            << "Standard exception caught: "
+            << x.what()
+            << std::endl;
+    }
+    catch (...) {
+        std::cerr
+            << "Unhandled non-standard exception caught"
+            << std::endl;
+    }
+
+    std::cerr
+        << "Exit code: " << exit_code
+        << std::endl;
+
+    return exit_code;
+}
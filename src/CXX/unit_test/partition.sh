@@ -0,0 +1,3 @@
+#!/bin/sh
+
+./partition -n 20000
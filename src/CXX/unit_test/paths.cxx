@@ -40,106 +40,68 @@
 
 
 #include <libtriexx/trie.hxx>
+#include <libtriexx/import.hxx>
 
-#include <algorithm>
 #include <vector>
-#include <map>
+#include <memory>
 #include <string>
 #include <iostream>
 #include <exception>
 #include <stdexcept>
-#include <regex>
+#include <cstdint>
 
 
-/** Print TRIE paths */
-static int trie_paths() {
-    int error_cnt = 0;
-
-    std::cerr << "TRIE paths BEGIN" << std::endl;
-
-    // Read action/value/key input
-    std::vector<std::tuple<char, int, std::string> > input;
-
-    for (bool eof = false; !eof; ) {
-        std::string line;
-        std::getline(std::cin, line);
-        eof = std::cin.eof();
+/** TRIE item (value with key in the input buffer) */
+struct item_t {
+    uint64_t              value;  /**< Value      */
+    const unsigned char * key;    /**< Key        */
+    size_t                len;    /**< Key length */
+};  // end of struct item_t
 
-        // Also include last line of a file with missing final EoL
-        if (eof && line.empty()) break;
-
-        // Parse input line
-        static const std::regex line_regex(
-            "^[ \\t]*([AR])[ \\t]+(\\d+)[ \\t]+([^ \\t]*)");
-
-        std::smatch bref;
-        if (!std::regex_match(line, bref, line_regex)) {
-            std::cerr << "Syntax error: '" << line << '\'' << std::endl;
-            throw std::runtime_error("Syntax error");
-        }
+/** Item serialisation (value only) */
+static std::ostream & operator << (std::ostream & out, const item_t & item) {
+    return out << item.value;
+}
 
-        // Value (numeric)
-        int val;
-        std::stringstream val_ss(bref[2]);
-        val_ss >> val;
 
-        input.emplace_back(bref[1].str()[0], val, bref[3]);
-    }
+/**
+ *  \brief  Print TRIE paths
+ *
+ *  \param  input  Input file (\c - means standard input)
+ *
+ *  \return Error count
+ */
+static int trie_paths(const std::string & input) {
+    int error_cnt = 0;
 
-    std::cerr << "Creating TRIE..." << std::endl;
+    std::cerr << "TRIE paths BEGIN" << std::endl;
 
-    // Create TRIE
-    std::map<int, const std::string &> keymap;
-    std::for_each(input.begin(), input.end(),
-    [&keymap](const std::tuple<char, int, std::string> & i) {
-        keymap.emplace(std::get<1>(i), std::get<2>(i));
-    });
+    // Read action/value/key input
+    std::unique_ptr<container::import_input> in("-" == input
+        ? new container::import_input(0)
+        : new container::import_input(input));
 
-    auto _key = [&keymap](int i) -> const std::string & {
-        const auto iter = keymap.find(i);
-        if (keymap.end() == iter)
-            throw std::logic_error(
-                "INTERNAL ERROR: item key not found");
+    std::vector<container::import_record> records;
+    in->parse(records);
 
-        return iter->second;
-    };
+    std::cerr << "Building TRIE..." << std::endl;
 
-    auto key = [&_key](int i) -> const unsigned char * {
-        return (const unsigned char *)_key(i).data();
+    // Build TRIE structure
+    auto key = [](const item_t & item) -> const unsigned char * {
+        return item.key;
     };
 
-    auto key_len = [&_key](int i) -> size_t {
-        return _key(i).size();
+    auto key_len = [](const item_t & item) -> size_t {
+        return item.len;
     };
 
-    container::trie<int, decltype(key), decltype(key_len)> trie(key, key_len);
+    container::trie<item_t, decltype(key), decltype(key_len)> trie(
+        key, key_len);
 
-    std::cerr << "Building TRIE..." << std::endl;
-
-    // Build TRIE structure
-    std::for_each(input.begin(), input.end(),
-    [&trie](const std::tuple<char, int, std::string> & i) {
-        switch (std::get<0>(i)) {
-            // Add new key
-            case 'A':
-                trie.insert(std::get<1>(i));
-                break;
-
-            // Remove key
-            case 'R': {
-                decltype(trie)::iterator iter = trie.find(std::get<1>(i));
-                if (trie.end() == iter) break;  // item not inserted, yet
-
-                trie.erase(iter);
-                break;
-            }
-
-            default:  // unknown action
-                throw std::logic_error(
-                    "INTERNAL ERROR: action not implemented");
-        }
-
-        //std::cerr << trie << std::endl;
+    container::import_apply(trie, records,
+    [](const container::import_record & rec) -> item_t {
+        item_t item = { rec.value, rec.key, rec.len };
+        return item;
     });
 
     std::cerr << "TRIE paths:" << std::endl;
@@ -158,7 +120,7 @@ static int main_impl(int argc, char * const argv[]) {
     int exit_code = 64;  // pessimistic assumption
 
     do {  // pragmatic do ... while (0) loop allowing for breaks
-        exit_code = trie_paths();
+        exit_code = trie_paths(1 < argc ? argv[1] : "-");
         if (0 != exit_code) break;
 
     } while (0);  // end of pragmatic loop
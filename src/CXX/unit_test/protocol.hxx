@@ -0,0 +1,260 @@
+#ifndef protocol_hxx
+#define protocol_hxx
+
+/**
+ *  \file
+ *  \brief  TRIE server binary protocol
+ *
+ *  The protocol is designed for local (Unix domain socket) communication,
+ *  so all the integers are in host byte order.
+ *
+ *  Client sends requests, each consisting of a fixed-size header followed
+ *  by key and argument bytes.
+ *  Requests may be pipelined (client doesn't need to wait for responses).
+ *  Server responds to each request with a fixed-size header followed
+ *  by payload; responses are sent in the order of requests.
+ *  Request identifier is echoed in the response for convenience.
+ *
+ *  Payload of a response consists of items; each item is serialised
+ *  as key length, value length, key bytes and value bytes.
+ *  The same serialisation is used for argument of the import request.
+ *  Import, erase range and count responses have no payload; number
+ *  of inserted, erased or counted items is in the response header.
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+extern "C" {
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+}
+
+
+namespace protocol {
+
+/** Request operations */
+enum {
+    OP_FIND        = 1,  /**< Find key                             */
+    OP_PREFIX      = 2,  /**< List items with key prefix           */
+    OP_RANGE       = 3,  /**< List items with key in [key, arg)    */
+    OP_INSERT      = 4,  /**< Insert key with value (arg)          */
+    OP_ERASE       = 5,  /**< Erase key                            */
+    OP_IMPORT      = 6,  /**< Insert items (arg is items payload)  */
+    OP_ERASE_RANGE = 7,  /**< Erase items with key in [key, arg)   */
+    OP_COUNT       = 8,  /**< Count items with key in [key, arg)   */
+};  // end of enum
+
+/** Response status */
+enum {
+    ST_OK          = 0,  /**< Success                        */
+    ST_NOT_FOUND   = 1,  /**< Key not found                  */
+    ST_EXISTS      = 2,  /**< Key already exists (insert)    */
+    ST_BAD_REQUEST = 3,  /**< Malformed or unknown request   */
+};  // end of enum
+
+/** Max. request key + argument length */
+static const size_t max_request_len = 1 << 20;
+
+/** Request header */
+struct request_hdr {
+    uint32_t id;       /**< Request identifier                         */
+    uint8_t  op;       /**< Operation                                  */
+    uint8_t  pad[3];   /**< Padding (zero)                             */
+    uint32_t key_len;  /**< Key length                                 */
+    uint32_t arg_len;  /**< Argument (value, range upper bound) length */
+    uint32_t limit;    /**< Max. items in response (0 means no limit)  */
+};  // end of struct request_hdr
+
+/** Response header */
+struct response_hdr {
+    uint32_t id;      /**< Request identifier (echoed) */
+    uint8_t  status;  /**< Status                      */
+    uint8_t  pad[3];  /**< Padding (zero)              */
+    uint32_t count;   /**< Number of payload items     */
+    uint32_t len;     /**< Payload length              */
+};  // end of struct response_hdr
+
+/** Payload item header (followed by key and value) */
+struct item_hdr {
+    uint32_t key_len;  /**< Key length   */
+    uint32_t val_len;  /**< Value length */
+};  // end of struct item_hdr
+
+
+/**
+ *  \brief  Append raw bytes to buffer
+ *
+ *  \param  buff  Buffer
+ *  \param  data  Data
+ *  \param  size  Data size
+ */
+inline void append(std::string & buff, const void * data, size_t size) {
+    buff.append(reinterpret_cast<const char *>(data), size);
+}
+
+/**
+ *  \brief  Append request to buffer
+ *
+ *  \param  buff     Buffer
+ *  \param  id       Request identifier
+ *  \param  op       Operation
+ *  \param  key      Key
+ *  \param  key_len  Key length
+ *  \param  arg      Argument
+ *  \param  arg_len  Argument length
+ *  \param  limit    Max. items in response
+ */
+inline void append_request(
+    std::string & buff,
+    uint32_t      id,
+    uint8_t       op,
+    const void *  key,
+    size_t        key_len,
+    const void *  arg     = NULL,
+    size_t        arg_len = 0,
+    uint32_t      limit   = 0)
+{
+    request_hdr hdr;
+    ::memset(&hdr, 0, sizeof(hdr));
+    hdr.id      = id;
+    hdr.op      = op;
+    hdr.key_len = key_len;
+    hdr.arg_len = arg_len;
+    hdr.limit   = limit;
+
+    append(buff, &hdr, sizeof(hdr));
+    append(buff, key, key_len);
+    append(buff, arg, arg_len);
+}
+
+/**
+ *  \brief  Append response item to payload
+ *
+ *  \param  payload  Payload buffer
+ *  \param  key      Key
+ *  \param  key_len  Key length
+ *  \param  val      Value
+ *  \param  val_len  Value length
+ */
+inline void append_item(
+    std::string & payload,
+    const void *  key,
+    size_t        key_len,
+    const void *  val,
+    size_t        val_len)
+{
+    item_hdr hdr;
+    hdr.key_len = key_len;
+    hdr.val_len = val_len;
+
+    append(payload, &hdr, sizeof(hdr));
+    append(payload, key, key_len);
+    append(payload, val, val_len);
+}
+
+
+/**
+ *  \brief  Throw system error
+ *
+ *  \param  what  Failed action description
+ */
+inline void throw_errno(const std::string & what) {
+    throw std::system_error(errno, std::system_category(), what);
+}
+
+/**
+ *  \brief  Set descriptor non-blocking
+ *
+ *  \param  fd  File descriptor
+ */
+inline void set_nonblocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL);
+    if (-1 == flags || -1 == ::fcntl(fd, F_SETFL, flags | O_NONBLOCK))
+        throw_errno("fcntl");
+}
+
+/**
+ *  \brief  Create Unix socket address
+ *
+ *  \param  path  Socket path
+ *
+ *  \return Socket address
+ */
+inline struct sockaddr_un unix_address(const std::string & path) {
+    struct sockaddr_un addr;
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("socket path too long: " + path);
+
+    ::memcpy(addr.sun_path, path.data(), path.size());
+    return addr;
+}
+
+/**
+ *  \brief  Connect to server
+ *
+ *  \param  path  Server socket path
+ *
+ *  \return Connected socket
+ */
+inline int connect(const std::string & path) {
+    struct sockaddr_un addr = unix_address(path);
+
+    int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (-1 == sock) throw_errno("socket");
+
+    if (-1 == ::connect(sock, (const struct sockaddr *)&addr, sizeof(addr))) {
+        ::close(sock);
+        throw_errno("connect to " + path);
+    }
+
+    return sock;
+}
+
+}  // end of namespace protocol
+
+#endif  // end of #ifndef protocol_hxx
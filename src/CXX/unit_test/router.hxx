@@ -0,0 +1,635 @@
+#ifndef router_hxx
+#define router_hxx
+
+/**
+ *  \file
+ *  \brief  Range-partitioned TRIE router
+ *
+ *  Key space is split to contiguous ranges by partition bounds;
+ *  each range (partition) is stored by a TRIE server (worker process).
+ *  The router routes key requests to the owning partition, fans range
+ *  scans out to all overlapping partitions in parallel (merging them
+ *  in key order) and rebalances partitions by moving key ranges
+ *  between neighbours (range export, import and erase).
+ *
+ *  The router is a test harness of the partitioned mode (see
+ *  \c partition.cxx), it isn't part of the library.
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "protocol.hxx"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+extern "C" {
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+}
+
+
+/** Range-partitioned TRIE router */
+class router {
+    public:
+
+    typedef std::pair<std::string, std::string> item_t;   /**< Key, value */
+    typedef std::vector<item_t>                 items_t;  /**< Items      */
+
+    private:
+
+    /** Partition response */
+    struct response {
+        protocol::response_hdr hdr;      /**< Header           */
+        std::string            payload;  /**< Payload          */
+        std::string            in;       /**< Input buffer     */
+    };  // end of struct response
+
+    std::vector<int>         m_socks;   /**< Partition connections       */
+    std::vector<std::string> m_bounds;  /**< Partition lower bounds (1+) */
+    uint32_t                 m_id;      /**< Next request ID             */
+
+    /**
+     *  \brief  Byte-wise key comparison (TRIE key order)
+     *
+     *  \param  key1  1st key
+     *  \param  key2  2nd key
+     *
+     *  \return \c true iff 1st key is less than the 2nd one
+     */
+    static bool key_less(const std::string & key1, const std::string & key2) {
+        const size_t len1 = key1.size(), len2 = key2.size();
+        const int    cmp  = ::memcmp(key1.data(), key2.data(),
+            len1 < len2 ? len1 : len2);
+        return cmp < 0 || (0 == cmp && len1 < len2);
+    }
+
+    /** Partition lower bound (inclusive) */
+    const std::string & lower(size_t i) const {
+        static const std::string min;
+        return i ? m_bounds[i - 1] : min;
+    }
+
+    /**
+     *  \brief  Send request (blocking)
+     *
+     *  \param  i        Partition
+     *  \param  op       Operation
+     *  \param  key      Key
+     *  \param  arg      Argument
+     *  \param  limit    Max. items in response
+     */
+    void send(
+        size_t              i,
+        uint8_t             op,
+        const std::string & key,
+        const std::string & arg   = std::string(),
+        uint32_t            limit = 0)
+    {
+        std::string buff;
+        protocol::append_request(buff, m_id++, op,
+            key.data(), key.size(), arg.data(), arg.size(), limit);
+
+        for (size_t pos = 0; pos < buff.size(); ) {
+            const ssize_t wcnt = ::send(m_socks[i],
+                buff.data() + pos, buff.size() - pos, MSG_NOSIGNAL);
+
+            if (-1 == wcnt) {
+                if (EINTR == errno) continue;
+                protocol::throw_errno("send");
+            }
+
+            pos += wcnt;
+        }
+    }
+
+    /**
+     *  \brief  Read available response data
+     *
+     *  \param  i     Partition
+     *  \param  resp  Response
+     *
+     *  \return \c true iff the response is complete
+     */
+    bool receive(size_t i, response & resp) {
+        char buff[64 * 1024];
+        ssize_t rcnt;
+        do rcnt = ::read(m_socks[i], buff, sizeof(buff));
+        while (-1 == rcnt && EINTR == errno);
+
+        if (-1 == rcnt) protocol::throw_errno("read");
+        if (0 == rcnt)
+            throw std::runtime_error("partition server closed connection");
+
+        resp.in.append(buff, rcnt);
+
+        const size_t hdr_size = sizeof(resp.hdr);
+        if (resp.in.size() < hdr_size) return false;
+
+        ::memcpy(&resp.hdr, resp.in.data(), hdr_size);
+        if (resp.in.size() - hdr_size < resp.hdr.len) return false;
+
+        resp.payload = resp.in.substr(hdr_size, resp.hdr.len);
+        resp.in.clear();
+        return true;
+    }
+
+    /**
+     *  \brief  Gather responses of partitions (in parallel)
+     *
+     *  \param  parts  Partitions (1 request sent to each)
+     *  \param  resps  Responses (per partition in \c parts)
+     */
+    void gather(
+        const std::vector<size_t> & parts,
+        std::vector<response> &     resps)
+    {
+        resps.assign(parts.size(), response());
+
+        std::vector<struct pollfd> pfds(parts.size());
+        for (size_t j = 0; j < parts.size(); ++j) {
+            pfds[j].fd     = m_socks[parts[j]];
+            pfds[j].events = POLLIN;
+        }
+
+        for (size_t pending = parts.size(); pending; ) {
+            if (-1 == ::poll(pfds.data(), pfds.size(), -1)) {
+                if (EINTR == errno) continue;
+                protocol::throw_errno("poll");
+            }
+
+            for (size_t j = 0; j < pfds.size(); ++j) {
+                if (!(pfds[j].revents & (POLLIN | POLLHUP | POLLERR)))
+                    continue;
+
+                if (receive(parts[j], resps[j])) {
+                    pfds[j].fd = -1;  // done, ignored by poll
+                    --pending;
+                }
+            }
+        }
+    }
+
+    /**
+     *  \brief  Request partition
+     *
+     *  \param  i      Partition
+     *  \param  op     Operation
+     *  \param  key    Key
+     *  \param  arg    Argument
+     *  \param  limit  Max. items in response
+     *
+     *  \return Response
+     */
+    response request(
+        size_t              i,
+        uint8_t             op,
+        const std::string & key,
+        const std::string & arg   = std::string(),
+        uint32_t            limit = 0)
+    {
+        send(i, op, key, arg, limit);
+
+        std::vector<response> resps;
+        gather(std::vector<size_t>(1, i), resps);
+        return resps[0];
+    }
+
+    /**
+     *  \brief  Parse response payload items
+     *
+     *  \param  payload  Payload
+     *  \param  items    Items (appended)
+     */
+    static void parse_items(const std::string & payload, items_t & items) {
+        const size_t ihdr_size = sizeof(protocol::item_hdr);
+        for (size_t pos = 0; pos + ihdr_size <= payload.size(); ) {
+            protocol::item_hdr ihdr;
+            ::memcpy(&ihdr, payload.data() + pos, ihdr_size);
+            pos += ihdr_size;
+
+            items.push_back(item_t(
+                payload.substr(pos, ihdr.key_len),
+                payload.substr(pos + ihdr.key_len, ihdr.val_len)));
+
+            pos += ihdr.key_len + ihdr.val_len;
+        }
+    }
+
+    /**
+     *  \brief  Import items to partition (in request size limited batches)
+     *
+     *  \param  i      Partition
+     *  \param  first  Items begin
+     *  \param  last   Items end
+     *
+     *  \return Number of inserted items
+     */
+    size_t import(
+        size_t                  i,
+        items_t::const_iterator first,
+        items_t::const_iterator last)
+    {
+        size_t inserted = 0;
+        while (first != last) {
+            std::string arg;
+            for (; first != last; ++first) {
+                const size_t size = sizeof(protocol::item_hdr) +
+                    first->first.size() + first->second.size();
+
+                if (!arg.empty() &&
+                    arg.size() + size > protocol::max_request_len)
+                {
+                    break;
+                }
+
+                protocol::append_item(arg,
+                    first->first.data(),  first->first.size(),
+                    first->second.data(), first->second.size());
+            }
+
+            inserted += request(i, protocol::OP_IMPORT, "", arg).hdr.count;
+        }
+
+        return inserted;
+    }
+
+    public:
+
+    /**
+     *  \brief  Constructor
+     *
+     *  \param  paths   Partition server socket paths
+     *  \param  bounds  Partition lower bounds (sorted, 1 less than paths;
+     *                  the 1st partition starts with empty key)
+     */
+    router(
+        const std::vector<std::string> & paths,
+        const std::vector<std::string> & bounds):
+        m_bounds(bounds),
+        m_id(0)
+    {
+        if (paths.empty() || bounds.size() + 1 != paths.size())
+            throw std::logic_error("router: partitions and bounds mismatch");
+
+        for (size_t i = 1; i < bounds.size(); ++i)
+            if (key_less(bounds[i], bounds[i - 1]))
+                throw std::logic_error("router: bounds not sorted");
+
+        try {
+            for (const auto & path: paths)
+                m_socks.push_back(protocol::connect(path));
+        }
+        catch (...) {
+            for (int sock: m_socks) ::close(sock);
+            throw;
+        }
+    }
+
+    router(const router & ) = delete;
+    router & operator = (const router & ) = delete;
+
+    /** Number of partitions */
+    inline size_t partitions() const { return m_socks.size(); }
+
+    /** Partition bounds */
+    inline const std::vector<std::string> & bounds() const { return m_bounds; }
+
+    /**
+     *  \brief  Key partition
+     *
+     *  \param  key  Key
+     *
+     *  \return Partition owning the key
+     */
+    size_t partition(const std::string & key) const {
+        return std::upper_bound(m_bounds.begin(), m_bounds.end(), key,
+            &router::key_less) - m_bounds.begin();
+    }
+
+    /**
+     *  \brief  Find key
+     *
+     *  \param  key  Key
+     *  \param  val  Value (if found)
+     *
+     *  \return \c true iff found
+     */
+    bool find(const std::string & key, std::string & val) {
+        const response resp = request(partition(key), protocol::OP_FIND, key);
+        if (protocol::ST_OK != resp.hdr.status) return false;
+
+        items_t items;
+        parse_items(resp.payload, items);
+        val = items.at(0).second;
+        return true;
+    }
+
+    /**
+     *  \brief  Insert item (unless the key exists)
+     *
+     *  \param  key  Key
+     *  \param  val  Value
+     *
+     *  \return \c true iff inserted
+     */
+    bool insert(const std::string & key, const std::string & val) {
+        return protocol::ST_OK ==
+            request(partition(key), protocol::OP_INSERT, key, val).hdr.status;
+    }
+
+    /**
+     *  \brief  Insert items (in parallel; all partitions are sent their
+     *          items before responses are awaited)
+     *
+     *  \param  items  Items (sorted by key)
+     *
+     *  \return Number of inserted items
+     */
+    size_t import(const items_t & items) {
+        std::vector<size_t> parts;
+        std::vector<std::string> args;
+        size_t inserted = 0;
+
+        for (auto first = items.begin(); first != items.end(); ) {
+            const size_t i = partition(first->first);
+            auto last = i + 1 < partitions()
+                ? std::lower_bound(first, items.end(),
+                    item_t(m_bounds[i], std::string()),
+                    [](const item_t & i1, const item_t & i2) {
+                        return key_less(i1.first, i2.first);
+                    })
+                : items.end();
+
+            // Large imports are batched synchronously
+            size_t size = 0;
+            for (auto it = first; it != last; ++it)
+                size += sizeof(protocol::item_hdr) +
+                    it->first.size() + it->second.size();
+
+            if (size > protocol::max_request_len)
+                inserted += import(i, first, last);
+
+            else {
+                std::string arg;
+                for (auto it = first; it != last; ++it)
+                    protocol::append_item(arg,
+                        it->first.data(),  it->first.size(),
+                        it->second.data(), it->second.size());
+
+                send(i, protocol::OP_IMPORT, "", arg);
+                parts.push_back(i);
+            }
+
+            first = last;
+        }
+
+        std::vector<response> resps;
+        gather(parts, resps);
+        for (const auto & resp: resps) inserted += resp.hdr.count;
+
+        return inserted;
+    }
+
+    /**
+     *  \brief  Erase key
+     *
+     *  \param  key  Key
+     *
+     *  \return \c true iff erased
+     */
+    bool erase(const std::string & key) {
+        return protocol::ST_OK ==
+            request(partition(key), protocol::OP_ERASE, key).hdr.status;
+    }
+
+    /**
+     *  \brief  Scan items with key in [from, to)
+     *
+     *  Requests are sent to all overlapping partitions at once; responses
+     *  are gathered as they come and merged in key (i.e. partition) order.
+     *
+     *  \param  from   Range begin
+     *  \param  to     Range end (empty means unbounded)
+     *  \param  items  Items (appended)
+     *  \param  limit  Max. number of items (0 means no limit)
+     */
+    void scan(
+        const std::string & from,
+        const std::string & to,
+        items_t &           items,
+        uint32_t            limit = 0)
+    {
+        std::vector<size_t> parts;
+        for (size_t i = partition(from); i < partitions(); ++i) {
+            if (!to.empty() && !parts.empty() && !key_less(lower(i), to))
+                break;
+
+            send(i, protocol::OP_RANGE, from, to, limit);
+            parts.push_back(i);
+        }
+
+        std::vector<response> resps;
+        gather(parts, resps);
+
+        for (const auto & resp: resps) {
+            parse_items(resp.payload, items);
+            if (limit && items.size() >= limit) {
+                items.resize(limit);
+                break;
+            }
+        }
+    }
+
+    /**
+     *  \brief  Count items of partitions (in parallel)
+     *
+     *  \param  counts  Item counts (per partition)
+     */
+    void count(std::vector<size_t> & counts) {
+        std::vector<size_t> parts;
+        for (size_t i = 0; i < partitions(); ++i) {
+            send(i, protocol::OP_COUNT, "");
+            parts.push_back(i);
+        }
+
+        std::vector<response> resps;
+        gather(parts, resps);
+
+        counts.clear();
+        for (const auto & resp: resps) counts.push_back(resp.hdr.count);
+    }
+
+    /**
+     *  \brief  Move bound between partitions \c b and \c b+1
+     *
+     *  Items in between the old and new bound are exported from one
+     *  partition, imported to the other one and erased from the former.
+     *  The bound is only moved once the items are moved; if the import
+     *  fails, the items are erased from the target partition again.
+     *  The new bound must lie within the two partitions.
+     *
+     *  \param  b    Bound index
+     *  \param  key  New bound
+     *
+     *  \return Number of moved items
+     */
+    size_t move_bound(size_t b, const std::string & key) {
+        const std::string old = m_bounds.at(b);
+        if (key == old) return 0;
+
+        if (key_less(key, lower(b)) ||
+            (b + 1 < m_bounds.size() && key_less(m_bounds[b + 1], key)))
+        {
+            throw std::logic_error("router: bound out of partitions");
+        }
+
+        const bool   down = key_less(key, old);
+        const size_t src  = down ? b : b + 1;
+        const size_t dst  = down ? b + 1 : b;
+        const std::string & from = down ? key : old;
+        const std::string & to   = down ? old : key;
+
+        // Export, import (the target has no items in the range)
+        items_t items;
+        parse_items(request(src, protocol::OP_RANGE, from, to).payload, items);
+
+        try {
+            if (import(dst, items.begin(), items.end()) != items.size())
+                throw std::runtime_error("router: range import failed");
+        }
+        catch (...) {
+            try { request(dst, protocol::OP_ERASE_RANGE, from, to); }
+            catch (...) {}
+
+            throw;
+        }
+
+        // Erase, switch routing
+        if (request(src, protocol::OP_ERASE_RANGE, from, to).hdr.count !=
+            items.size())
+        {
+            throw std::runtime_error("router: range erase failed");
+        }
+
+        m_bounds[b] = key;
+        return items.size();
+    }
+
+    /**
+     *  \brief  Rebalance partitions
+     *
+     *  Bounds are moved (left to right) so that partitions hold (nearly)
+     *  the same number of items.
+     *  A partition can only take items of its neighbours, so it may take
+     *  more passes for items to get to partitions further away.
+     *
+     *  \return Number of moved items
+     */
+    size_t rebalance() {
+        std::vector<size_t> counts;
+        count(counts);
+
+        size_t total = 0;
+        for (size_t cnt: counts) total += cnt;
+
+        size_t moved = 0;
+        for (size_t pass = 0; pass < partitions(); ++pass) {
+            size_t pass_moved = 0, cumul = 0;
+
+            for (size_t b = 0; b < m_bounds.size(); ++b) {
+                cumul += counts[b];
+                const size_t target = total * (b + 1) / partitions();
+
+                std::string key;
+                if (cumul < target) {  // take 1st items of the right one
+                    const size_t cnt = std::min(target - cumul, counts[b + 1]);
+                    if (0 == cnt) continue;
+
+                    items_t items;
+                    parse_items(request(b + 1, protocol::OP_RANGE,
+                        lower(b + 1), "", cnt).payload, items);
+
+                    key = items.back().first + '\0';  // successor of last
+                }
+                else if (cumul > target) {  // give last items of the left one
+                    const size_t keep = counts[b] - std::min(
+                        cumul - target, counts[b]);
+
+                    items_t items;
+                    parse_items(request(b, protocol::OP_RANGE,
+                        lower(b), "", keep + 1).payload, items);
+
+                    key = items.back().first;
+                }
+                else continue;
+
+                const size_t cnt = move_bound(b, key);
+                if (cumul < target) {
+                    counts[b]     += cnt;
+                    counts[b + 1] -= cnt;
+                    cumul         += cnt;
+                }
+                else {
+                    counts[b]     -= cnt;
+                    counts[b + 1] += cnt;
+                    cumul         -= cnt;
+                }
+
+                pass_moved += cnt;
+            }
+
+            if (0 == pass_moved) break;
+            moved += pass_moved;
+        }
+
+        return moved;
+    }
+
+    /** Destructor */
+    ~router() {
+        for (int sock: m_socks) ::close(sock);
+    }
+
+};  // end of class router
+
+#endif  // end of #ifndef router_hxx
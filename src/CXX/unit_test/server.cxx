@@ -0,0 +1,721 @@
+/**
+ *  \file
+ *  \brief  TRIE lookup server
+ *
+ *  The server owns a string-keyed TRIE and serves find, prefix, range
+ *  and insert requests over a Unix domain socket (see \c protocol.hxx).
+ *  Requests are pipelined; all complete requests read from a connection
+ *  are processed in one go and their responses are sent as a batch.
+ *  Once a connection output backlog exceeds a cap, its requests are
+ *  held back until the client reads the responses.
+ *  Connections are multiplexed by an epoll loop.
+ *
+ *  \date   2026/10/18
+ *  \author Vaclav Krpec  <vencik@razdva.cz>
+ *
+ *
+ *  LEGAL NOTICE
+ *
+ *  Copyright (c) 2016, Vaclav Krpec
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of the copyright holder nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER
+ *  OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "protocol.hxx"
+
+#include <libtriexx/trie.hxx>
+#include <libtriexx/trie_sort.hxx>
+
+#include <map>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+extern "C" {
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+}
+
+
+/** Termination request flag */
+static volatile sig_atomic_t terminated = 0;
+
+/** Termination signal handler */
+static void on_signal(int) { terminated = 1; }
+
+
+/**
+ *  \brief  Byte-wise key comparison (TRIE key order)
+ *
+ *  \param  key1  1st key
+ *  \param  len1  1st key length
+ *  \param  key2  2nd key
+ *  \param  len2  2nd key length
+ *
+ *  \return \c true iff 1st key is less than the 2nd one
+ */
+static bool key_less(
+    const unsigned char * key1, size_t len1,
+    const unsigned char * key2, size_t len2)
+{
+    int cmp = ::memcmp(key1, key2, len1 < len2 ? len1 : len2);
+    return cmp < 0 || (0 == cmp && len1 < len2);
+}
+
+
+/** TRIE server */
+class server {
+    public:
+
+    typedef container::string_trie<std::string> trie_t;  /**< TRIE type */
+
+    private:
+
+    /** Client connection */
+    struct connection {
+        int         fd;       /**< Socket                         */
+        std::string in;       /**< Input buffer                   */
+        std::string out;      /**< Output buffer                  */
+        size_t      out_pos;  /**< Output buffer written position */
+        bool        held;     /**< Input held back (backpressure) */
+        uint32_t    events;   /**< Watched epoll events           */
+
+        connection(int _fd): fd(_fd), out_pos(0), held(false), events(0) {}
+
+        /** Unsent output size */
+        inline size_t backlog() const { return out.size() - out_pos; }
+
+    };  // end of struct connection
+
+    typedef std::map<int, connection> connections_t;  /**< Connections */
+
+    /** Imported item (in request argument) */
+    struct import_item {
+        const char * key;      /**< Key          */
+        size_t       key_len;  /**< Key length   */
+        const char * val;      /**< Value        */
+        size_t       val_len;  /**< Value length */
+    };  // end of struct import_item
+
+    /** Connection output backlog cap (requests are held back above it) */
+    static const size_t out_max = 4 << 20;
+
+    trie_t        m_trie;         /**< TRIE                   */
+    int           m_listen;       /**< Listening socket       */
+    int           m_epoll;        /**< epoll descriptor       */
+    std::string   m_path;         /**< Socket path            */
+    connections_t m_connections;  /**< Client connections     */
+    size_t        m_requests;     /**< Served requests count  */
+
+    /**
+     *  \brief  (Re)register connection with epoll
+     *
+     *  Connection only waits for writability while there's something
+     *  to write and for readability unless its input is held back.
+     *  It is only re-registered if the events change.
+     *
+     *  \param  conn  Connection
+     *  \param  op    \c EPOLL_CTL_ADD or \c EPOLL_CTL_MOD
+     */
+    void watch(connection & conn, int op) {
+        struct epoll_event ev;
+        ::memset(&ev, 0, sizeof(ev));
+        ev.events  =
+            (conn.held ? 0 : EPOLLIN) | (conn.backlog() ? EPOLLOUT : 0);
+        ev.data.fd = conn.fd;
+
+        if (EPOLL_CTL_MOD == op && ev.events == conn.events) return;
+
+        if (-1 == ::epoll_ctl(m_epoll, op, conn.fd, &ev))
+            protocol::throw_errno("epoll_ctl");
+
+        conn.events = ev.events;
+    }
+
+    /**
+     *  \brief  Parse imported items
+     *
+     *  \param  arg    Request argument (items payload)
+     *  \param  len    Request argument length
+     *  \param  items  Items (appended)
+     *
+     *  \return \c false if the payload is malformed
+     */
+    static bool parse_import(
+        const unsigned char *       arg,
+        size_t                      len,
+        std::vector<import_item> &  items)
+    {
+        const size_t ihdr_size = sizeof(protocol::item_hdr);
+        for (size_t pos = 0; pos < len; ) {
+            protocol::item_hdr ihdr;
+            if (len - pos < ihdr_size) return false;
+
+            ::memcpy(&ihdr, arg + pos, ihdr_size);
+            pos += ihdr_size;
+
+            if (len - pos < (size_t)ihdr.key_len + ihdr.val_len) return false;
+
+            import_item item;
+            item.key     = (const char *)arg + pos;
+            item.key_len = ihdr.key_len;
+            item.val     = item.key + ihdr.key_len;
+            item.val_len = ihdr.val_len;
+            items.push_back(item);
+
+            pos += ihdr.key_len + ihdr.val_len;
+        }
+
+        return true;
+    }
+
+    /**
+     *  \brief  Append response for a request to output buffer
+     *
+     *  \param  out  Output buffer
+     *  \param  hdr  Request header
+     *  \param  key  Request key
+     *  \param  arg  Request argument
+     */
+    void respond(
+        std::string &                   out,
+        const protocol::request_hdr &   hdr,
+        const unsigned char *           key,
+        const unsigned char *           arg)
+    {
+        protocol::response_hdr rhdr;
+        ::memset(&rhdr, 0, sizeof(rhdr));
+        rhdr.id     = hdr.id;
+        rhdr.status = protocol::ST_OK;
+
+        // Header is completed when the payload is known
+        const size_t hdr_pos = out.size();
+        protocol::append(out, &rhdr, sizeof(rhdr));
+
+        const size_t limit = hdr.limit ? hdr.limit : (size_t)-1;
+
+        auto add_item = [&out, &rhdr](const trie_t::const_iterator & iter) {
+            const auto & val = std::get<1>(std::get<2>(*iter));
+            protocol::append_item(out,
+                std::get<0>(*iter), std::get<1>(*iter),
+                val.data(), val.size());
+            ++rhdr.count;
+        };
+
+        switch (hdr.op) {
+            case protocol::OP_FIND: {
+                auto iter = m_trie.find(key, hdr.key_len);
+                if (m_trie.end() == iter)
+                    rhdr.status = protocol::ST_NOT_FOUND;
+                else
+                    add_item(iter);
+
+                break;
+            }
+
+            case protocol::OP_PREFIX: {
+                auto range = m_trie.find_prefix(key, hdr.key_len);
+                for (; range.first != range.second && rhdr.count < limit;
+                    ++range.first)
+                {
+                    add_item(range.first);
+                }
+
+                break;
+            }
+
+            case protocol::OP_RANGE: {
+                auto iter = m_trie.seek(key, hdr.key_len);
+                for (; m_trie.end() != iter && rhdr.count < limit; ++iter) {
+                    if (hdr.arg_len && !key_less(
+                        std::get<0>(*iter), std::get<1>(*iter),
+                        arg, hdr.arg_len))
+                    {
+                        break;  // upper bound reached
+                    }
+
+                    add_item(iter);
+                }
+
+                break;
+            }
+
+            case protocol::OP_INSERT: {
+                const size_t size = m_trie.size();
+                m_trie.insert(std::make_tuple(
+                    std::string((const char *)key, hdr.key_len),
+                    std::string((const char *)arg, hdr.arg_len)));
+
+                if (m_trie.size() == size) rhdr.status = protocol::ST_EXISTS;
+                break;
+            }
+
+            case protocol::OP_ERASE:
+                if (!m_trie.erase(key, hdr.key_len))
+                    rhdr.status = protocol::ST_NOT_FOUND;
+
+                break;
+
+            case protocol::OP_IMPORT: {
+                std::vector<import_item> items;
+                if (!parse_import(arg, hdr.arg_len, items)) {
+                    rhdr.status = protocol::ST_BAD_REQUEST;
+                    break;
+                }
+
+                // Bulk load: unique items are inserted in key order,
+                // so that consecutive insertions walk warm paths
+                items.erase(container::trie_sort(items.begin(), items.end(),
+                [](const import_item & item) -> const unsigned char * {
+                    return (const unsigned char *)item.key;
+                },
+                [](const import_item & item) -> size_t {
+                    return item.key_len;
+                }), items.end());
+
+                const size_t size = m_trie.size();
+                for (const auto & item: items)
+                    m_trie.insert(std::make_tuple(
+                        std::string(item.key, item.key_len),
+                        std::string(item.val, item.val_len)));
+
+                rhdr.count = m_trie.size() - size;
+                break;
+            }
+
+            case protocol::OP_ERASE_RANGE:
+            case protocol::OP_COUNT: {
+                std::vector<std::string> keys;
+                auto iter = m_trie.seek(key, hdr.key_len);
+                for (; m_trie.end() != iter; ++iter) {
+                    if (hdr.arg_len && !key_less(
+                        std::get<0>(*iter), std::get<1>(*iter),
+                        arg, hdr.arg_len))
+                    {
+                        break;  // upper bound reached
+                    }
+
+                    if (protocol::OP_COUNT == hdr.op)
+                        ++rhdr.count;
+                    else
+                        keys.push_back(std::get<0>(std::get<2>(*iter)));
+                }
+
+                if (protocol::OP_ERASE_RANGE == hdr.op)
+                    rhdr.count = m_trie.erase_many(keys);
+
+                break;
+            }
+
+            default:
+                rhdr.status = protocol::ST_BAD_REQUEST;
+        }
+
+        rhdr.len = out.size() - hdr_pos - sizeof(rhdr);
+        out.replace(hdr_pos, sizeof(rhdr), (const char *)&rhdr, sizeof(rhdr));
+
+        ++m_requests;
+    }
+
+    /**
+     *  \brief  Process complete requests in connection input buffer
+     *
+     *  Requests are held back once the output backlog exceeds
+     *  \ref out_max (processing is resumed by \ref flush).
+     *
+     *  \param  conn  Connection
+     *
+     *  \return \c false if the connection shall be closed
+     */
+    bool process(connection & conn) {
+        size_t pos = 0;
+        const size_t hdr_size = sizeof(protocol::request_hdr);
+
+        conn.held = false;
+        while (conn.in.size() - pos >= hdr_size) {
+            if (conn.backlog() > out_max) {
+                conn.held = true;
+                break;
+            }
+
+            protocol::request_hdr hdr;
+            ::memcpy(&hdr, conn.in.data() + pos, hdr_size);
+
+            const size_t len = (size_t)hdr.key_len + hdr.arg_len;
+            if (len > protocol::max_request_len) return false;
+            if (conn.in.size() - pos - hdr_size < len) break;  // incomplete
+
+            const unsigned char * key =
+                (const unsigned char *)conn.in.data() + pos + hdr_size;
+
+            respond(conn.out, hdr, key, key + hdr.key_len);
+            pos += hdr_size + len;
+        }
+
+        conn.in.erase(0, pos);
+        return true;
+    }
+
+    /**
+     *  \brief  Write connection output buffer (as much as possible)
+     *
+     *  \param  conn  Connection
+     *
+     *  \return \c false if the connection shall be closed
+     */
+    bool write(connection & conn) {
+        while (conn.out_pos < conn.out.size()) {
+            ssize_t wcnt = ::send(conn.fd,
+                conn.out.data() + conn.out_pos,
+                conn.out.size() - conn.out_pos, MSG_NOSIGNAL);
+
+            if (-1 == wcnt) {
+                if (EINTR == errno) continue;
+                if (EAGAIN == errno || EWOULDBLOCK == errno) break;
+                return false;
+            }
+
+            conn.out_pos += wcnt;
+        }
+
+        if (conn.out_pos == conn.out.size()) {
+            conn.out.clear();
+            conn.out_pos = 0;
+        }
+
+        // Responses are appended while output is pending, drop sent ones
+        else if (conn.out_pos > out_max) {
+            conn.out.erase(0, conn.out_pos);
+            conn.out_pos = 0;
+        }
+
+        return true;
+    }
+
+    /**
+     *  \brief  Flush connection output buffer
+     *
+     *  Requests held back by \ref process are resumed as soon as
+     *  the output backlog drops to \ref out_max.
+     *
+     *  \param  conn  Connection
+     *
+     *  \return \c false if the connection shall be closed
+     */
+    bool flush(connection & conn) {
+        for (;;) {
+            if (!write(conn)) return false;
+
+            if (!conn.held || conn.backlog() > out_max) break;
+            if (!process(conn)) return false;
+        }
+
+        watch(conn, EPOLL_CTL_MOD);
+        return true;
+    }
+
+    /**
+     *  \brief  Read from connection and respond
+     *
+     *  \param  conn  Connection
+     *
+     *  \return \c false if the connection shall be closed
+     */
+    bool receive(connection & conn) {
+        char buff[64 * 1024];
+
+        for (;;) {
+            ssize_t rcnt = ::read(conn.fd, buff, sizeof(buff));
+
+            if (-1 == rcnt) {
+                if (EINTR == errno) continue;
+                if (EAGAIN == errno || EWOULDBLOCK == errno) break;
+                return false;
+            }
+
+            if (0 == rcnt) return false;  // peer closed connection
+
+            conn.in.append(buff, rcnt);
+            if ((size_t)rcnt < sizeof(buff)) break;  // drained
+        }
+
+        return process(conn) && flush(conn);
+    }
+
+    /** Accept new connections */
+    void accept() {
+        for (;;) {
+            int fd = ::accept(m_listen, NULL, NULL);
+            if (-1 == fd) {
+                if (EINTR == errno) continue;
+                if (EAGAIN == errno || EWOULDBLOCK == errno) return;
+                protocol::throw_errno("accept");
+            }
+
+            protocol::set_nonblocking(fd);
+
+            auto ins = m_connections.emplace(fd, connection(fd));
+            watch(ins.first->second, EPOLL_CTL_ADD);
+        }
+    }
+
+    /**
+     *  \brief  Close connection
+     *
+     *  \param  fd  Connection socket
+     */
+    void close(int fd) {
+        ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, NULL);
+        ::close(fd);
+        m_connections.erase(fd);
+    }
+
+    public:
+
+    /**
+     *  \brief  Constructor
+     *
+     *  \param  path  Listening socket path (existing file is removed)
+     */
+    server(const std::string & path):
+        m_listen   ( -1   ),
+        m_epoll    ( -1   ),
+        m_path     ( path ),
+        m_requests ( 0    )
+    {
+        struct sockaddr_un addr = protocol::unix_address(path);
+        ::unlink(path.c_str());
+
+        m_listen = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (-1 == m_listen) protocol::throw_errno("socket");
+
+        if (-1 == ::bind(m_listen, (const struct sockaddr *)&addr,
+            sizeof(addr)))
+        {
+            ::close(m_listen);
+            protocol::throw_errno("bind to " + path);
+        }
+
+        if (-1 == ::listen(m_listen, 128)) {
+            ::close(m_listen);
+            protocol::throw_errno("listen");
+        }
+
+        protocol::set_nonblocking(m_listen);
+
+        m_epoll = ::epoll_create1(0);
+        if (-1 == m_epoll) {
+            ::close(m_listen);
+            protocol::throw_errno("epoll_create1");
+        }
+
+        struct epoll_event ev;
+        ::memset(&ev, 0, sizeof(ev));
+        ev.events  = EPOLLIN;
+        ev.data.fd = m_listen;
+        if (-1 == ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listen, &ev)) {
+            ::close(m_epoll);
+            ::close(m_listen);
+            protocol::throw_errno("epoll_ctl");
+        }
+    }
+
+    /** TRIE getter */
+    inline trie_t & trie() { return m_trie; }
+
+    /** Served requests count getter */
+    inline size_t requests() const { return m_requests; }
+
+    /**
+     *  \brief  Serve requests until terminated by a signal
+     *
+     *  The termination signals shall be blocked and only unblocked
+     *  by \c sigmask while waiting for events; a signal delivered
+     *  between the termination check and the wait would be missed
+     *  otherwise.
+     *
+     *  \param  sigmask  Signal mask while waiting for events
+     */
+    void run(const sigset_t & sigmask) {
+        struct epoll_event events[64];
+
+        while (!terminated) {
+            int ev_cnt = ::epoll_pwait(m_epoll, events, 64, -1, &sigmask);
+            if (-1 == ev_cnt) {
+                if (EINTR == errno) continue;
+                protocol::throw_errno("epoll_pwait");
+            }
+
+            for (int i = 0; i < ev_cnt; ++i) {
+                const int fd = events[i].data.fd;
+
+                if (m_listen == fd) {
+                    accept();
+                    continue;
+                }
+
+                auto conn = m_connections.find(fd);
+                if (m_connections.end() == conn) continue;
+
+                bool ok = true;
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    ok = receive(conn->second);
+
+                if (ok && (events[i].events & EPOLLOUT))
+                    ok = flush(conn->second);
+
+                if (!ok) close(fd);
+            }
+        }
+    }
+
+    /** Destructor */
+    ~server() {
+        while (!m_connections.empty())
+            close(m_connections.begin()->first);
+
+        ::close(m_epoll);
+        ::close(m_listen);
+        ::unlink(m_path.c_str());
+    }
+
+};  // end of class server
+
+
+/** Main routine (implementation) */
+static int main_impl(int argc, char * const argv[]) {
+    std::string path = "trie.sock";
+
+    // Usage
+    auto usage = [&argv, &path]() { std::cerr <<
+"Usage: " << argv[0] << " [OPTIONS]\n\n"
+"OPTIONS:\n"
+"    -h, --help                 show help and exit\n"
+"    -s, --socket <path>        Listening socket path\n"
+"                               default: " << path << "\n"
+"\n"; };
+
+    // Options
+    static const struct option long_opts[] {
+        { "help",   no_argument,       NULL, 'h' },
+        { "socket", required_argument, NULL, 's' },
+
+        { NULL, 0, NULL, '\0' }  // terminator
+    };
+
+    for (;;) {
+        int long_opt_ix;
+        int opt = getopt_long(argc, argv, ":hs:", long_opts, &long_opt_ix);
+
+        if (-1 == opt) break;  // no more options
+
+        switch (opt) {
+            case 'h':  // help
+                usage();
+                ::exit(0);
+                break;
+
+            case 's':  // socket path
+                path = optarg;
+                break;
+
+            case '?':  // unknown option
+            case ':':  // missing argument
+                usage();
+                ::exit(1);
+
+            default:  // internal error (forgotten option)
+                std::cerr
+                    << "INTERNAL ERROR: forgotten option " << (char)opt
+                    << std::endl;
+                ::abort();
+        }
+    }
+
+    // Terminate gracefully on signal (no SA_RESTART, epoll_pwait shall
+    // fail); the signals are only unblocked while waiting for events
+    struct sigaction sa;
+    ::memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = &on_signal;
+    ::sigaction(SIGINT,  &sa, NULL);
+    ::sigaction(SIGTERM, &sa, NULL);
+
+    sigset_t term_sigs, sigmask;
+    ::sigemptyset(&term_sigs);
+    ::sigaddset(&term_sigs, SIGINT);
+    ::sigaddset(&term_sigs, SIGTERM);
+    ::sigprocmask(SIG_BLOCK, &term_sigs, &sigmask);
+    ::sigdelset(&sigmask, SIGINT);
+    ::sigdelset(&sigmask, SIGTERM);
+
+    server srv(path);
+    std::cerr << "Serving on " << path << std::endl;
+
+    srv.run(sigmask);
+
+    std::cerr
+        << "Served " << srv.requests() << " requests, "
+        << srv.trie().size() << " items stored" << std::endl;
+
+    return 0;
+}
+
+/** Main routine (exception-safe wrapper) */
+int main(int argc, char * const argv[]) {
+    int exit_code = 128;
+
+    try {
+        exit_code = main_impl(argc, argv);
+    }
+    catch (const std::exception & x) {
+        std::cerr
+            << "Standard exception caught: "
+            << x.what()
+            << std::endl;
+    }
+    catch (...) {
+        std::cerr
+            << "Unhandled non-standard exception caught"
+            << std::endl;
+    }
+
+    std::cerr
+        << "Exit code: " << exit_code
+        << std::endl;
+
+    return exit_code;
+}
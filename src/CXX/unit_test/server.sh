@@ -0,0 +1,20 @@
+#!/bin/sh
+
+sock=./server.sock
+
+./server -s $sock &
+server_pid=$!
+
+# Wait for the server to listen
+for i in 1 2 3 4 5 6 7 8 9 10; do
+    test -S $sock && break
+    sleep 1
+done
+
+./client -S $sock -n 20000 -N 200000
+exit_code=$?
+
+kill $server_pid
+wait $server_pid
+
+exit $exit_code
@@ -40,12 +40,32 @@
 
 
 #include <libtriexx/trie.hxx>
+#include <libtriexx/counting_trie.hxx>
+#include <libtriexx/disk_trie.hxx>
+#include <libtriexx/heavy_hitters.hxx>
+#include <libtriexx/import.hxx>
+#include <libtriexx/int_set.hxx>
+#include <libtriexx/string_dictionary.hxx>
+#include <libtriexx/suffix_index.hxx>
+#include <libtriexx/trie_sort.hxx>
+#include <libtriexx/value_pool.hxx>
+#include <libtriexx/zorder_index.hxx>
 
 #include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <memory>
 #include <algorithm>
 #include <iostream>
 #include <exception>
 #include <stdexcept>
+#include <functional>
+#include <thread>
+#include <cstdlib>
+#include <cmath>
+
+#include <unistd.h>
 
 
 /**
@@ -144,15 +164,2266 @@ static int string_trie_test() {
 }
 
 
-/** Unit test */
-static int main_impl(int argc, char * const argv[]) {
-    int exit_code = 64;  // pessimistic assumption
+/** Ordered search (lower bound, prefix) unit test */
+static int ordered_search_test() {
+    int error_cnt = 0;
 
-    do {  // pragmatic do ... while (0) loop allowing for breaks
-        exit_code = trie_test();
-        if (0 != exit_code) break;
+    std::cerr << "Ordered search test BEGIN" << std::endl;
 
-        exit_code = string_trie_test();
+    typedef container::string_trie<int> trie_t;
+
+    trie_t trie;
+    std::map<std::string, int> map;
+
+    // Short keys over a small alphabet produce plenty of shared prefixes
+    ::srand(1);
+    for (int i = 0; i < 2000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 7; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        trie.insert(std::make_tuple(key, i));
+        map.emplace(key, i);
+    }
+
+    if (trie.size() != map.size()) {
+        std::cerr
+            << "Size mismatch: " << trie.size() << " != " << map.size()
+            << std::endl;
+        ++error_cnt;
+    }
+
+    for (int i = 0; i < 2000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 8; len; --len)
+            key.push_back("ab\x11\xf1\x12"[::rand() % 5]);
+
+        const unsigned char * k = (const unsigned char *)key.data();
+
+        // Lower bound
+        auto iter     = trie.seek(k, key.size());
+        auto map_iter = map.lower_bound(key);
+
+        if ((trie.end() == iter) != (map.end() == map_iter) ||
+            (trie.end() != iter && std::get<1>(std::get<2>(*iter)) !=
+                                   map_iter->second))
+        {
+            std::cerr << "Seek mismatch for key of length " << key.size()
+                << std::endl;
+            ++error_cnt;
+        }
+
+        // Prefix
+        auto range = trie.find_prefix(k, key.size());
+        for (; map.end() != map_iter; ++map_iter) {
+            if (0 != map_iter->first.compare(0, key.size(), key)) break;
+
+            if (range.first == range.second ||
+                std::get<1>(std::get<2>(*range.first)) != map_iter->second)
+            {
+                std::cerr << "Prefix range mismatch for key of length "
+                    << key.size() << std::endl;
+                ++error_cnt;
+                break;
+            }
+
+            ++range.first;
+        }
+
+        if (range.first != range.second) {
+            std::cerr << "Prefix range too long for key of length "
+                << key.size() << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    std::cerr << "Ordered search test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Insert at lower bound position in a branching node unit test */
+static int lower_bound_insert_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Lower bound insert test BEGIN" << std::endl;
+
+    typedef container::string_trie<int> trie_t;
+
+    trie_t trie;
+
+    // "ab" and "ac" branch in the low quad-bit of their 2nd byte
+    trie.insert(std::make_tuple<std::string, int>("ab", 1));
+    trie.insert(std::make_tuple<std::string, int>("ac", 2));
+
+    // "ad" position is the branching node (its branch is missing)
+    const std::vector<std::string> keys = { "ad", "a", "b", "" };
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const unsigned char * k = (const unsigned char *)keys[i].data();
+
+        auto pos = trie.lower_bound(k, keys[i].size());
+        if (trie_t::pos_match(pos)) {
+            std::cerr << "Key \"" << keys[i] << "\" found before insertion"
+                << std::endl;
+            ++error_cnt;
+            continue;
+        }
+
+        trie.insert(std::make_tuple(keys[i], (int)i + 3), pos);
+    }
+
+    std::map<std::string, int> map = {
+        { "ab", 1 }, { "ac", 2 },
+        { "ad", 3 }, { "a",  4 }, { "b", 5 }, { "", 6 } };
+
+    for (const auto & kv: map) {
+        auto iter = trie.find(
+            (const unsigned char *)kv.first.data(), kv.first.size());
+
+        if (trie.end() == iter ||
+            std::get<1>(std::get<2>(*iter)) != kv.second)
+        {
+            std::cerr << "Key \"" << kv.first << "\" not found" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    // Items are iterated in key order
+    auto map_iter = map.begin();
+    for (const auto & d: trie) {
+        if (map.end() == map_iter ||
+            std::get<2>(d) != std::make_tuple(map_iter->first,
+                                              map_iter->second))
+        {
+            std::cerr << "Iteration mismatch" << std::endl;
+            ++error_cnt;
+            break;
+        }
+
+        ++map_iter;
+    }
+
+    std::cerr << "Lower bound insert test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Slobby key tracing with verification threshold unit test */
+static int slob_threshold_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Slobby threshold test BEGIN" << std::endl;
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_SLOBBY_THRESHOLD> trie_t;
+
+    trie_t trie;
+
+    if (trie_t::slob_qlen_default != trie.slob_threshold()) {
+        std::cerr << "Default threshold mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    // The keys branch in the low quad-bit of their 2nd byte, so leaves
+    // are reached having matched 4 quad-bits of a key
+    trie.insert(std::make_tuple<std::string, int>("aaaa", 1));
+    trie.insert(std::make_tuple<std::string, int>("abaa", 2));
+
+    const std::string hit  = "aaaa";   // the key itself
+    const std::string miss = "aaxy";   // shares 4 quad-bits with "aaaa"
+    const std::string lmis = "aaxyz";  // the same but leaf length differs
+
+    auto find = [&trie](const std::string & key) -> int {
+        auto iter = trie.find((const unsigned char *)key.data(), key.size());
+        return trie.end() == iter ? 0 : std::get<1>(std::get<2>(*iter));
+    };
+
+    for (size_t qlen = 0; qlen <= 8; ++qlen) {
+        trie.slob_threshold(qlen);
+
+        if (1 != find(hit)) {
+            std::cerr << "Threshold " << qlen << ": key not found"
+                << std::endl;
+            ++error_cnt;
+        }
+
+        // Below threshold, the key tail is compared by memcmp
+        const int expected = qlen <= 4 ? 1 : 0;
+        if (expected != find(miss)) {
+            std::cerr << "Threshold " << qlen << ": "
+                << (expected ? "false hit expected" : "false hit")
+                << std::endl;
+            ++error_cnt;
+        }
+
+        if (0 != find(lmis)) {
+            std::cerr << "Threshold " << qlen << ": key length not checked"
+                << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    std::cerr << "Slobby threshold test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Key fingerprints unit test */
+static int fingerprints_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Fingerprints test BEGIN" << std::endl;
+
+    container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_FINGERPRINTS> trie;
+    std::map<std::string, int> map;
+
+    ::srand(2);
+    for (int i = 0; i < 4000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 9; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        // Every other key is inserted, the rest are (mostly) misses
+        if (i % 2) {
+            trie.insert(std::make_tuple(key, i));
+            map.emplace(key, i);
+        }
+
+        auto iter = trie.find(
+            (const unsigned char *)key.data(), key.size());
+        auto map_iter = map.find(key);
+
+        if ((trie.end() == iter) != (map.end() == map_iter) ||
+            (trie.end() != iter && std::get<1>(std::get<2>(*iter)) !=
+                                   map_iter->second))
+        {
+            std::cerr << "Find mismatch for key of length " << key.size()
+                << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    std::cerr << "Fingerprints test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** String dictionary unit test */
+static int string_dictionary_test() {
+    int error_cnt = 0;
+
+    std::cerr << "String dictionary test BEGIN" << std::endl;
+
+    typedef container::string_dictionary<uint32_t> dictionary_t;
+
+    dictionary_t dict;
+    std::vector<std::string> keys;  // by original ID
+
+    ::srand(3);
+    for (int i = 0; i < 3000; ++i) {
+        std::string key;
+        for (size_t len = 1 + ::rand() % 6; len; --len)
+            key.push_back('a' + ::rand() % 4);
+
+        const uint32_t id = dict.insert(key);
+        if (id == keys.size())
+            keys.push_back(key);
+        else if (id > keys.size() || keys[id] != key) {
+            std::cerr << "Unexpected ID " << id << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    for (size_t id = 0; id < keys.size(); ++id)
+        if (dict.id_of(keys[id]) != id || dict.key_of(id) != keys[id]) {
+            std::cerr << "ID " << id << " mismatch" << std::endl;
+            ++error_cnt;
+        }
+
+    if (dictionary_t::npos != dict.id_of("e")) {
+        std::cerr << "Unexpected ID of unknown key" << std::endl;
+        ++error_cnt;
+    }
+
+    // Renumber IDs in key order
+    const std::vector<uint32_t> old2new = dict.renumber();
+
+    std::vector<std::string> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+
+    for (size_t id = 0; id < keys.size(); ++id)
+        if (dict.key_of(old2new[id]) != keys[id] ||
+            dict.key_of(id) != sorted[id])
+        {
+            std::cerr << "Renumbered ID " << id << " mismatch" << std::endl;
+            ++error_cnt;
+        }
+
+    // ID ranges
+    const auto range = dict.id_range(
+        (const unsigned char *)"ab", 2, (const unsigned char *)"c", 1);
+    const auto prefix = dict.prefix_id_range((const unsigned char *)"b", 1);
+
+    auto lower_bound = [&sorted](const char * key) -> size_t {
+        return std::lower_bound(sorted.begin(), sorted.end(), key)
+            - sorted.begin();
+    };
+
+    if (range.first  != lower_bound("ab") ||
+        range.second != lower_bound("c")  ||
+        prefix.first  != lower_bound("b") ||
+        prefix.second != lower_bound("c"))
+    {
+        std::cerr << "ID range mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "String dictionary test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** TRIE sort unit test */
+static int trie_sort_test() {
+    int error_cnt = 0;
+
+    std::cerr << "TRIE sort test BEGIN" << std::endl;
+
+    // Short keys (incl. empty ones and prefixes of others)
+    ::srand(5);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 6; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        keys.push_back(key);
+    }
+
+    std::vector<std::string> expected(keys);
+    std::sort(expected.begin(), expected.end());
+    expected.erase(
+        std::unique(expected.begin(), expected.end()), expected.end());
+
+    keys.erase(container::trie_sort(keys.begin(), keys.end()), keys.end());
+
+    if (keys != expected) {
+        std::cerr << "String sort mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    // Items with key getters (1st occurrence of a key is kept)
+    std::vector<std::pair<std::string, int> > items;
+    std::map<std::string, int> first;  // 1st occurrences
+    for (int i = 0; i < 3000; ++i) {
+        items.emplace_back(expected[::rand() % expected.size()], i);
+        first.emplace(items.back());
+    }
+
+    auto end = container::trie_sort(items.begin(), items.end(),
+    [](const std::pair<std::string, int> & item) -> const unsigned char * {
+        return (const unsigned char *)item.first.data();
+    },
+    [](const std::pair<std::string, int> & item) -> size_t {
+        return item.first.size();
+    });
+
+    items.erase(end, items.end());
+
+    if (items != std::vector<std::pair<std::string, int> >(
+        first.begin(), first.end()))
+    {
+        std::cerr << "Item sort mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "TRIE sort test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Suffix index unit test */
+static int suffix_index_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Suffix index test BEGIN" << std::endl;
+
+    container::suffix_index index;
+    std::vector<std::string> keys;
+
+    ::srand(6);
+    for (int i = 0; i < 500; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 12; len; --len)
+            key.push_back("abc\x11"[::rand() % 4]);
+
+        if (index.add(key) != keys.size()) {
+            std::cerr << "Unexpected source key ID" << std::endl;
+            ++error_cnt;
+        }
+
+        keys.push_back(key);
+    }
+
+    for (int i = 0; i < 500; ++i) {
+        std::string str;
+        for (size_t len = ::rand() % 5; len; --len)
+            str.push_back("abc\x11"[::rand() % 4]);
+
+        std::vector<size_t> expected;
+        for (size_t id = 0; id < keys.size(); ++id)
+            if (std::string::npos != keys[id].find(str))
+                expected.push_back(id);
+
+        std::vector<size_t> ids = index.find_substring(str);
+        std::sort(ids.begin(), ids.end());
+
+        if (ids != expected) {
+            std::cerr
+                << "Substring search mismatch: " << ids.size() << " != "
+                << expected.size() << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    std::cerr << "Suffix index test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Maximum/minimum XOR unit test */
+static int xor_test() {
+    int error_cnt = 0;
+
+    std::cerr << "XOR search test BEGIN" << std::endl;
+
+    // Big-endian 32-bit integer keys
+    auto be32 = [](uint32_t v) -> std::string {
+        std::string key(4, '\0');
+        for (int i = 3; i >= 0; --i, v >>= 8) key[i] = (char)v;
+        return key;
+    };
+
+    container::string_trie<uint32_t> trie;
+    std::vector<uint32_t> values;
+
+    const unsigned char * k = (const unsigned char *)"\0\0\0\0";
+    if (trie.end() != trie.max_xor(k, 4)) {
+        std::cerr << "Empty TRIE XOR search hit" << std::endl;
+        ++error_cnt;
+    }
+
+    ::srand(7);
+    for (int i = 0; i < 3000; ++i) {
+        // Skewed values produce long common prefixes
+        const uint32_t v = (uint32_t)::rand() >> (::rand() % 24);
+        trie.insert(std::make_tuple(be32(v), v));
+        values.push_back(v);
+    }
+
+    // 2nd round with keys of other lengths (to be ignored), too
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; round && i < 1000; ++i) {
+            const std::string key = be32(values[i]);
+            trie.insert(std::make_tuple(key.substr(0, 1 + i % 3), 0u));
+            trie.insert(std::make_tuple(key + "\x01", 0u));
+        }
+
+        // Branches with no key of the length
+        if (round) {
+            trie.insert(std::make_tuple(std::string("\xff"), 0u));
+            trie.insert(std::make_tuple(std::string("\xf0\x01"), 0u));
+            trie.insert(std::make_tuple(std::string("\x80\0\0\0\0", 5), 0u));
+        }
+
+        for (int i = 0; i < 3000; ++i) {
+            const uint32_t x = i % 2 ? (uint32_t)::rand() : values[i];
+            const std::string key = be32(x);
+
+            uint32_t max_x = 0, min_x = ~(uint32_t)0;
+            for (uint32_t v: values) {
+                if ((v ^ x) > max_x) max_x = v ^ x;
+                if ((v ^ x) < min_x) min_x = v ^ x;
+            }
+
+            auto max_iter = trie.max_xor(
+                (const unsigned char *)key.data(), key.size());
+            auto min_iter = trie.min_xor(
+                (const unsigned char *)key.data(), key.size());
+
+            if (trie.end() == max_iter || trie.end() == min_iter ||
+                4 != std::get<1>(*max_iter) || 4 != std::get<1>(*min_iter) ||
+                (std::get<1>(std::get<2>(*max_iter)) ^ x) != max_x ||
+                (std::get<1>(std::get<2>(*min_iter)) ^ x) != min_x)
+            {
+                std::cerr << "XOR search mismatch for " << x << std::endl;
+                ++error_cnt;
+            }
+        }
+    }
+
+    std::cerr << "XOR search test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Integer set unit test */
+static int int_set_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Integer set test BEGIN" << std::endl;
+
+    typedef container::int_set<uint64_t> int_set_t;
+
+    int_set_t sets[2];
+    std::set<uint64_t> std_sets[2];
+
+    // Dense ranges (bitmap chunks) and sparse integers (array chunks)
+    ::srand(8);
+    for (size_t s = 0; s < 2; ++s) {
+        for (uint64_t v = 0x4000 * s; v < 0x4000 * s + 30000; ++v) {
+            if (::rand() % 4) continue;
+
+            sets[s].insert(v);
+            std_sets[s].insert(v);
+        }
+
+        for (int i = 0; i < 5000; ++i) {
+            const uint64_t v = ((uint64_t)::rand() << 20) ^ ::rand() % 70000;
+            if (sets[s].insert(v) != std_sets[s].insert(v).second) {
+                std::cerr << "Unexpected insert result" << std::endl;
+                ++error_cnt;
+            }
+        }
+    }
+
+    std::vector<uint64_t> expected;
+    std::set_union(
+        std_sets[0].begin(), std_sets[0].end(),
+        std_sets[1].begin(), std_sets[1].end(),
+        std::back_inserter(expected));
+
+    auto check = [&error_cnt](
+        const int_set_t & set, const std::vector<uint64_t> & expected,
+        const char * what)
+    {
+        std::vector<uint64_t> values;
+        set.for_each([&values](uint64_t v) { values.push_back(v); });
+
+        if (set.size() != expected.size() || values != expected) {
+            std::cerr
+                << what << " mismatch: " << set.size() << " != "
+                << expected.size() << std::endl;
+            ++error_cnt;
+        }
+    };
+
+    int_set_t set_union;
+    int_set_t::set_union(sets[0], sets[1], set_union);
+    check(set_union, expected, "Union");
+
+    expected.clear();
+    std::set_intersection(
+        std_sets[0].begin(), std_sets[0].end(),
+        std_sets[1].begin(), std_sets[1].end(),
+        std::back_inserter(expected));
+
+    int_set_t set_intersection;
+    int_set_t::set_intersection(sets[0], sets[1], set_intersection);
+    check(set_intersection, expected, "Intersection");
+
+    // Membership
+    for (int i = 0; i < 10000; ++i) {
+        const uint64_t v = i % 2 ? ::rand() % 100000 : ::rand();
+        if (sets[0].contains(v) != (std_sets[0].count(v) > 0)) {
+            std::cerr << "Membership mismatch for " << v << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    // In-place union
+    sets[0] |= sets[1];
+    std_sets[0].insert(std_sets[1].begin(), std_sets[1].end());
+    check(sets[0], std::vector<uint64_t>(
+        std_sets[0].begin(), std_sets[0].end()), "In-place union");
+
+    std::cerr << "Integer set test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Heavy hitters (key access sampling) unit test */
+static int heavy_hitters_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Heavy hitters test BEGIN" << std::endl;
+
+    container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_ACCESS_SAMPLING> trie;
+
+    container::heavy_hitters hitters(std::vector<size_t>{ 1, 3 }, 8);
+    trie.sampler(std::ref(hitters), 4);
+
+    // Every 3rd access is to a "hot" key
+    ::srand(9);
+    for (int i = 0; i < 12000; ++i) {
+        std::string key = i % 3 ? "" : "hot";
+        for (size_t len = 1 + ::rand() % 6; len; --len)
+            key.push_back('a' + ::rand() % 26);
+
+        if (i % 2)
+            trie.insert(std::make_tuple(key, i));
+        else
+            trie.find((const unsigned char *)key.data(), key.size());
+    }
+
+    if (hitters.samples() != 12000 / 4) {
+        std::cerr << "Unexpected number of samples: " << hitters.samples()
+            << std::endl;
+        ++error_cnt;
+    }
+
+    const auto top1 = hitters.top(1, 3);
+    const auto top3 = hitters.top(3, 3);
+
+    if (top1.empty() || "h" != top1[0].prefix ||
+        top3.empty() || "hot" != top3[0].prefix ||
+        top3[0].count - top3[0].error < 12000 / 4 / 3)
+    {
+        std::cerr << "Hot prefix not reported" << std::endl;
+        ++error_cnt;
+    }
+
+    // Sampling off
+    trie.sampler(container::string_trie<int>::sampler_t());
+    trie.find((const unsigned char *)"hot", 3);
+
+    if (hitters.samples() != 12000 / 4) {
+        std::cerr << "Sampling not disabled" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Heavy hitters test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Flat sorted export unit test */
+static int export_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Export test BEGIN" << std::endl;
+
+    typedef container::string_trie<int> trie_t;
+    trie_t trie;
+
+    ::srand(10);
+    for (int i = 0; i < 3000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 7; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        trie.insert(std::make_tuple(key, i));
+    }
+
+    // Reference (iteration)
+    std::vector<unsigned char> ref_keys;
+    std::vector<size_t>        ref_offsets;
+    std::vector<int>           ref_values;
+
+    for (auto iter = trie.begin(); trie.end() != iter; ++iter) {
+        ref_offsets.push_back(ref_keys.size());
+        ref_keys.insert(ref_keys.end(),
+            std::get<0>(*iter), std::get<0>(*iter) + std::get<1>(*iter));
+        ref_values.push_back(std::get<1>(std::get<2>(*iter)));
+    }
+
+    ref_offsets.push_back(ref_keys.size());
+
+    for (size_t threads = 1; threads <= 4; threads += 3) {
+        std::vector<unsigned char> keys;
+        std::vector<size_t>        offsets;
+        std::vector<int>           values;
+
+        trie.export_sorted(keys, offsets, values,
+        [](const std::tuple<std::string, int> & item) -> int {
+            return std::get<1>(item);
+        },
+        threads);
+
+        if (keys != ref_keys || offsets != ref_offsets ||
+            values != ref_values)
+        {
+            std::cerr << "Export mismatch (" << threads << " threads)"
+                << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    // Exception thrown by value_fn in any thread is propagated
+    const int bad_value = ref_values[ref_values.size() / 2];
+    for (size_t threads = 1; threads <= 4; threads += 3) {
+        std::vector<unsigned char> keys;
+        std::vector<size_t>        offsets;
+        std::vector<int>           values;
+
+        try {
+            trie.export_sorted(keys, offsets, values,
+            [bad_value](const std::tuple<std::string, int> & item) -> int {
+                if (bad_value == std::get<1>(item))
+                    throw std::runtime_error("value_fn failure");
+
+                return std::get<1>(item);
+            },
+            threads);
+
+            std::cerr << "Export exception lost (" << threads << " threads)"
+                << std::endl;
+            ++error_cnt;
+        }
+        catch (const std::runtime_error &) {}
+    }
+
+    // Items export
+    std::vector<unsigned char>                 keys;
+    std::vector<size_t>                        offsets;
+    std::vector<std::tuple<std::string, int> > items;
+
+    trie.export_sorted(keys, offsets, items);
+
+    if (keys != ref_keys || items.size() != trie.size() ||
+        std::get<1>(items.back()) != ref_values.back())
+    {
+        std::cerr << "Items export mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Export test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Apply TRIE diff to map */
+template <class Trie>
+static void apply_diff(
+    const Trie & a, const Trie & b, std::map<std::string, int> & map,
+    size_t & changes)
+{
+    typedef std::tuple<std::string, int> item_t;
+
+    changes = 0;
+    Trie::diff(a, b,
+    [&](const item_t & item) {
+        map[std::get<0>(item)] = std::get<1>(item);
+        ++changes;
+    },
+    [&](const item_t & item) {
+        map.erase(std::get<0>(item));
+        ++changes;
+    },
+    [&](const item_t & old_item, const item_t & new_item) {
+        if (std::get<0>(old_item) != std::get<0>(new_item)) return;
+        map[std::get<0>(new_item)] = std::get<1>(new_item);
+        ++changes;
+    });
+}
+
+/** TRIE to map */
+template <class Trie>
+static std::map<std::string, int> trie2map(const Trie & trie) {
+    std::map<std::string, int> map;
+    for (auto iter = trie.begin(); trie.end() != iter; ++iter) {
+        const auto & item = std::get<2>(*iter);
+        map[std::get<0>(item)] = std::get<1>(item);
+    }
+
+    return map;
+}
+
+/** TRIE diff unit test */
+template <int Features>
+static int diff_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Diff test (features " << Features << ") BEGIN"
+        << std::endl;
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT, Features> trie_t;
+
+    trie_t a;
+
+    ::srand(11);
+    for (int i = 0; i < 2000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 7; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        a.insert(std::make_tuple(key, i));
+    }
+
+    // Snapshot
+    trie_t b(a);
+    size_t changes;
+
+    auto map = trie2map(a);
+    apply_diff(a, b, map, changes);
+    if (0 != changes || map != trie2map(b)) {
+        std::cerr << "Snapshot diff isn't empty" << std::endl;
+        ++error_cnt;
+    }
+
+    // Modify snapshot
+    for (int i = 0; i < 100; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 9; len; --len)
+            key.push_back("abc\x11\xf1"[::rand() % 5]);
+
+        typename trie_t::iterator iter =
+            b.find((const unsigned char *)key.data(), key.size());
+        if (b.end() == iter) {
+            b.insert(std::make_tuple(key, -i));
+        }
+        else if (i % 2) {
+            b.erase(iter);
+        }
+        else {
+            std::get<1>(std::get<2>(*iter)) = -i;
+            b.touch(iter);
+        }
+    }
+
+    map = trie2map(a);
+    apply_diff(a, b, map, changes);
+    if (0 == changes || map != trie2map(b)) {
+        std::cerr << "Diff mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    // Reverse diff
+    map = trie2map(b);
+    apply_diff(b, a, map, changes);
+    if (map != trie2map(a)) {
+        std::cerr << "Reverse diff mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    // Erasure collapsing interim node (stamp shared with moved son)
+    trie_t c;
+    c.insert(std::make_tuple(std::string("ac"), 1));
+    c.insert(std::make_tuple(std::string("ab"), 2));
+
+    trie_t d(c);
+    typename trie_t::iterator ac = d.find((const unsigned char *)"ac", 2);
+    d.erase(ac);
+
+    map = trie2map(c);
+    apply_diff(c, d, map, changes);
+    if (1 != changes || map != trie2map(d)) {
+        std::cerr << "Collapsed erase diff mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Diff test (features " << Features << ") END"
+        << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Compare TRIE replicas by Merkle hashes top-down */
+template <class Trie>
+static void merkle_compare(
+    const Trie &            a,
+    const Trie &            b,
+    std::string &           prefix,
+    size_t                  qlen,
+    size_t                  qlen_max,
+    std::set<std::string> & diffs,
+    size_t &                calls)
+{
+    const unsigned char * key = (const unsigned char *)prefix.data();
+
+    calls += 2;
+    if (a.merkle_hash(key, qlen) == b.merkle_hash(key, qlen)) return;
+
+    // Item with the prefix key
+    if (!(qlen & 1)) {
+        const std::string ikey(prefix, 0, qlen >> 1);
+        auto a_iter = a.find((const unsigned char *)ikey.data(), ikey.size());
+        auto b_iter = b.find((const unsigned char *)ikey.data(), ikey.size());
+
+        if ((a.end() == a_iter) != (b.end() == b_iter) ||
+            (a.end() != a_iter &&
+             std::get<2>(*a_iter) != std::get<2>(*b_iter)))
+        {
+            diffs.insert(ikey);
+        }
+    }
+
+    if (qlen == qlen_max) return;
+
+    // Sub-trees
+    if (!(qlen & 1)) prefix.push_back(0);
+    for (unsigned q = 0; q < 16; ++q) {
+        char & last = prefix[qlen >> 1];
+        last = qlen & 1 ? (last & 0xf0) | q : q << 4;
+
+        merkle_compare(a, b, prefix, qlen + 1, qlen_max, diffs, calls);
+    }
+    if (!(qlen & 1)) prefix.pop_back();
+}
+
+/** Merkle hashes unit test */
+template <int Features>
+static int merkle_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Merkle hashes test (features " << Features << ") BEGIN"
+        << std::endl;
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT, Features> trie_t;
+
+    std::vector<std::string> keys;
+
+    ::srand(12);
+    for (int i = 0; i < 2000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 7; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        keys.push_back(key);
+    }
+
+    auto value_hash = [](const std::tuple<std::string, int> & item)
+        -> uint64_t
+    {
+        return std::get<1>(item);
+    };
+
+    // Same content, different insertion order
+    trie_t a, b;
+    a.merkle_item_hash(value_hash);
+    b.merkle_item_hash(value_hash);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        a.insert(std::make_tuple(keys[i], (int)keys[i].size()));
+        b.insert(std::make_tuple(keys[keys.size() - i - 1],
+            (int)keys[keys.size() - i - 1].size()));
+    }
+
+    if (0 == a.merkle_hash() || a.merkle_hash() != b.merkle_hash()) {
+        std::cerr << "Equal replicas hashes mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    // Modify replica
+    std::set<std::string> modified;
+    for (int i = 0; i < 20; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 7; len; --len)
+            key.push_back("abc\x11\xf1"[::rand() % 5]);
+
+        typename trie_t::iterator iter =
+            b.find((const unsigned char *)key.data(), key.size());
+
+        // Note that item hashes are only used with TRIE_MERKLE_HASHES
+        if (b.end() == iter) {
+            b.insert(std::make_tuple(key, -i));
+        }
+        else if (i % 2 || !(Features & container::TRIE_MERKLE_HASHES)) {
+            b.erase(iter);
+        }
+        else {
+            std::get<1>(std::get<2>(*iter)) = -i;
+            b.touch(iter);
+        }
+
+        modified.insert(key);
+    }
+
+    // Differences (ignoring restored items)
+    std::set<std::string> expected;
+    for (const auto & key: modified) {
+        const unsigned char * k = (const unsigned char *)key.data();
+        auto a_iter = a.find(k, key.size());
+        auto b_iter = b.find(k, key.size());
+
+        if ((a.end() == a_iter) != (b.end() == b_iter) ||
+            (a.end() != a_iter &&
+             std::get<2>(*a_iter) != std::get<2>(*b_iter)))
+        {
+            expected.insert(key);
+        }
+    }
+
+    std::string prefix;
+    std::set<std::string> diffs;
+    size_t calls = 0;
+    merkle_compare(a, b, prefix, 0, 12, diffs, calls);
+
+    if (diffs != expected) {
+        std::cerr << "Merkle compare found " << diffs.size()
+            << " differences, expected " << expected.size() << std::endl;
+        ++error_cnt;
+    }
+
+    if (calls > 2 + expected.size() * 12 * 16 * 2) {
+        std::cerr << "Merkle compare too expensive: " << calls
+            << " hash calls" << std::endl;
+        ++error_cnt;
+    }
+
+    // Revert the modifications
+    for (const auto & key: modified) {
+        const unsigned char * k = (const unsigned char *)key.data();
+        typename trie_t::iterator b_iter = b.find(k, key.size());
+        if (b.end() != b_iter) b.erase(b_iter);
+
+        auto a_iter = a.find(k, key.size());
+        if (a.end() != a_iter) b.insert(std::get<2>(*a_iter));
+    }
+
+    if (a.merkle_hash() != b.merkle_hash()) {
+        std::cerr << "Reverted replica hash mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Merkle hashes test (features " << Features << ") END"
+        << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Concurrent counting TRIE unit test */
+static int counting_trie_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Counting TRIE test BEGIN" << std::endl;
+
+    typedef container::counting_trie<uint64_t> counting_t;
+
+    // Skewed key distribution (few hot keys)
+    std::vector<std::string> keys;
+
+    ::srand(13);
+    for (int i = 0; i < 20000; ++i) {
+        std::string key;
+        for (size_t len = 1 + ::rand() % (i % 4 ? 6 : 1); len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        keys.push_back(key);
+    }
+
+    std::map<std::string, uint64_t> expected;
+    for (size_t i = 0; i < keys.size(); ++i)
+        expected[keys[i]] += 4 * (1 + i % 3);
+
+    counting_t counts(8);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t)
+        threads.push_back(std::thread([&keys, &counts, t]() {
+            counting_t::local local(counts, 100);
+
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (t % 2)
+                    local.increment(keys[i], 1 + i % 3);
+                else
+                    counts.increment(keys[i], 1 + i % 3);
+            }
+        }));
+
+    for (auto & thread: threads) thread.join();
+
+    if (counts.size() != expected.size()) {
+        std::cerr << "Counting TRIE size " << counts.size()
+            << ", expected " << expected.size() << std::endl;
+        ++error_cnt;
+    }
+
+    // Ordered counts
+    counting_t::counts_t ordered;
+    counts.collect(ordered);
+
+    auto exp_iter = expected.begin();
+    for (auto iter = ordered.begin(); ordered.end() != iter; ++iter) {
+        const auto & item = std::get<2>(*iter);
+
+        if (expected.end() == exp_iter ||
+            std::get<0>(item) != exp_iter->first ||
+            std::get<1>(item) != exp_iter->second ||
+            counts.count(std::get<0>(item)) != exp_iter->second)
+        {
+            std::cerr << "Count mismatch" << std::endl;
+            ++error_cnt;
+            break;
+        }
+
+        ++exp_iter;
+    }
+
+    if (0 != counts.count("no such key")) {
+        std::cerr << "Non-zero count of missing key" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Counting TRIE test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Insert or merge (upsert) unit test */
+static int insert_or_merge_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Insert or merge test BEGIN" << std::endl;
+
+    typedef container::string_trie<int> trie_t;
+    typedef std::tuple<std::string, int> item_t;
+
+    trie_t trie;
+    std::map<std::string, int> expected;
+
+    ::srand(14);
+    for (int i = 0; i < 5000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 5; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        auto iter = trie.insert_or_merge(std::make_tuple(key, i),
+        [](item_t & item, const item_t & merged) {
+            std::get<1>(item) += std::get<1>(merged);
+        });
+
+        expected[key] += i;
+
+        if (std::get<1>(std::get<2>(*iter)) != expected[key]) {
+            std::cerr << "Merged value mismatch" << std::endl;
+            ++error_cnt;
+            break;
+        }
+    }
+
+    if (trie.size() != expected.size()) {
+        std::cerr << "Size " << trie.size() << ", expected "
+            << expected.size() << std::endl;
+        ++error_cnt;
+    }
+
+    for (const auto & kv: expected) {
+        auto iter = trie.find(
+            (const unsigned char *)kv.first.data(), kv.first.size());
+
+        if (trie.end() == iter || std::get<1>(std::get<2>(*iter)) != kv.second)
+        {
+            std::cerr << "Aggregate mismatch" << std::endl;
+            ++error_cnt;
+            break;
+        }
+    }
+
+    std::cerr << "Insert or merge test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Erase of a key referenced by interim ancestors unit test */
+static int erase_interim_key_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Erase interim key test BEGIN" << std::endl;
+
+    typedef container::string_trie<int> trie_t;
+
+    trie_t trie;
+
+    // The interim node of "abcx" and "abd" uses the "abcx" key;
+    // "abc" item node is inserted between it and the "abcx" leaf
+    trie.insert(std::make_tuple<std::string, int>("abcx", 1));
+    trie.insert(std::make_tuple<std::string, int>("abd",  2));
+    trie.insert(std::make_tuple<std::string, int>("abc",  3));
+
+    trie_t::iterator erased = trie.find((const unsigned char *)"abcx", 4);
+    trie.erase(erased);
+
+    // The freed item is likely reused by another key
+    trie.insert(std::make_tuple<std::string, int>("zzzz", 4));
+
+    std::map<std::string, int> map = {
+        { "abd", 2 }, { "abc", 3 }, { "zzzz", 4 } };
+
+    for (const auto & kv: map) {
+        auto iter = trie.find(
+            (const unsigned char *)kv.first.data(), kv.first.size());
+
+        if (trie.end() == iter ||
+            std::get<1>(std::get<2>(*iter)) != kv.second)
+        {
+            std::cerr << "Key \"" << kv.first << "\" not found" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    if (trie.end() != trie.find((const unsigned char *)"abcx", 4)) {
+        std::cerr << "Erased key found" << std::endl;
+        ++error_cnt;
+    }
+
+    // "ab" prefix range ends before "zzzz" (the last key)
+    auto range = trie.find_prefix((const unsigned char *)"ab", 2);
+    auto map_iter = map.begin();
+    for (; range.first != range.second; ++range.first, ++map_iter) {
+        if ("zzzz" == map_iter->first ||
+            std::get<2>(*range.first) != std::make_tuple(map_iter->first,
+                                                         map_iter->second))
+        {
+            std::cerr << "Prefix range mismatch" << std::endl;
+            ++error_cnt;
+            break;
+        }
+    }
+
+    if ("zzzz" != map_iter->first) {
+        std::cerr << "Prefix range length mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    map_iter = map.begin();
+    for (const auto & d: trie) {
+        if (map.end() == map_iter ||
+            std::get<2>(d) != std::make_tuple(map_iter->first,
+                                              map_iter->second))
+        {
+            std::cerr << "Iteration mismatch" << std::endl;
+            ++error_cnt;
+            break;
+        }
+
+        ++map_iter;
+    }
+
+    std::cerr << "Erase interim key test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Huge page arena unit test */
+static int huge_pages_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Huge pages test BEGIN" << std::endl;
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_HUGE_PAGES> trie_t;
+
+    std::map<std::string, int> map;
+
+    {
+        trie_t trie;
+
+        ::srand(15);
+        for (int i = 0; i < 20000; ++i) {
+            std::string key;
+            for (size_t len = ::rand() % 8; len; --len)
+                key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+            typename trie_t::iterator iter =
+                trie.find((const unsigned char *)key.data(), key.size());
+
+            // Erase every 3rd existing key (reusing arena slots)
+            if (trie.end() != iter && 0 == i % 3) {
+                trie.erase(iter);
+                map.erase(key);
+            }
+            else if (trie.end() == iter) {
+                trie.insert(std::make_tuple(key, i));
+                map[key] = i;
+            }
+        }
+
+        if (trie.size() != map.size() ||
+            !std::equal(map.begin(), map.end(), trie.begin(),
+            [](const std::pair<const std::string, int> & kv,
+               const trie_t::const_iterator::deref_t & d)
+            {
+                return std::get<2>(d) == std::make_tuple(kv.first, kv.second);
+            }))
+        {
+            std::cerr << "Arena TRIE content mismatch" << std::endl;
+            ++error_cnt;
+        }
+
+        // Snapshot in arena
+        trie_t copy(trie);
+        if (copy.size() != trie.size()) {
+            std::cerr << "Arena TRIE copy size mismatch" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    const container::arena_stats_t stats = container::arena_stats();
+    std::cerr << "Arena chunks: " << stats.chunks
+        << " (huge TLB: " << stats.hugetlb
+        << ", THP advised: " << stats.thp << ")" << std::endl;
+
+    if (0 == stats.chunks) {
+        std::cerr << "No arena chunks allocated" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Huge pages test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Access-frequency-guided relayout unit test */
+static int relayout_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Relayout test BEGIN" << std::endl;
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_ACCESS_COUNTS> trie_t;
+
+    trie_t trie;
+    std::map<std::string, int> map;
+
+    ::srand(16);
+    for (int i = 0; i < 5000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 8; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        trie.insert(std::make_tuple(key, i));
+        map.insert(std::make_pair(key, i));
+    }
+
+    std::vector<std::string> keys;
+    for (const auto & kv: map) keys.push_back(kv.first);
+
+    // Skewed lookups
+    trie.access_counting(2);
+    for (int i = 0; i < 20000; ++i) {
+        const double r = (double)::rand() / RAND_MAX;
+        const std::string & key = keys[(size_t)(r * r * (keys.size() - 1))];
+
+        trie.find((const unsigned char *)key.data(), key.size());
+    }
+
+    for (int round = 0; round < 2; ++round) {
+        trie.relayout();
+
+        auto map_iter = map.begin();
+        for (auto iter = trie.begin(); trie.end() != iter; ++iter, ++map_iter)
+        {
+            if (map.end() == map_iter ||
+                std::get<2>(*iter) !=
+                    std::make_tuple(map_iter->first, map_iter->second))
+            {
+                std::cerr << "Relayout content mismatch" << std::endl;
+                ++error_cnt;
+                break;
+            }
+        }
+
+        // Modify relaid TRIE
+        for (size_t i = round; i < keys.size(); i += 7) {
+            const unsigned char * key = (const unsigned char *)keys[i].data();
+            trie_t::iterator iter = trie.find(key, keys[i].size());
+
+            if (trie.end() == iter) {
+                std::cerr << "Key not found after relayout" << std::endl;
+                ++error_cnt;
+                break;
+            }
+
+            trie.erase(iter);
+            map.erase(keys[i]);
+        }
+
+        if (trie.size() != map.size()) {
+            std::cerr << "Relayout size mismatch" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    std::cerr << "Relayout test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Sorted batch lookup unit test */
+static int find_sorted_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Sorted batch lookup test BEGIN" << std::endl;
+
+    typedef container::string_trie<int> trie_t;
+    trie_t trie;
+
+    ::srand(17);
+    for (int i = 0; i < 3000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 7; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        trie.insert(std::make_tuple(key, i));
+    }
+
+    // Batch of present and missing keys
+    std::vector<std::string> keys;
+    for (int i = 0; i < 2000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 8; len; --len)
+            key.push_back("abc\x11\xf1"[::rand() % 5]);
+
+        keys.push_back(key);
+    }
+
+    for (int sorted = 0; sorted < 2; ++sorted) {
+        if (sorted) std::sort(keys.begin(), keys.end());
+
+        std::vector<const std::tuple<std::string, int> *> items;
+        trie.find_sorted(keys, items);
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            auto iter = trie.find(
+                (const unsigned char *)keys[i].data(), keys[i].size());
+
+            if ((trie.end() == iter) != (NULL == items[i]) ||
+                (NULL != items[i] && &std::get<2>(*iter) != items[i]))
+            {
+                std::cerr << "Batch lookup mismatch ("
+                    << (sorted ? "sorted" : "unsorted") << ")" << std::endl;
+                ++error_cnt;
+                break;
+            }
+        }
+    }
+
+    std::cerr << "Sorted batch lookup test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Batch erase unit test */
+static int erase_many_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Batch erase test BEGIN" << std::endl;
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_VERSION_STAMPS | container::TRIE_MERKLE_HASHES>
+        trie_t;
+    typedef std::tuple<std::string, int> item_t;
+
+    trie_t trie;
+    std::map<std::string, int> map;
+
+    ::srand(18);
+    for (int i = 0; i < 5000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 8; len; --len)
+            key.push_back("ab\x11\xf1"[::rand() % 4]);
+
+        trie.insert(std::make_tuple(key, i));
+        map.insert(std::make_pair(key, i));
+    }
+
+    trie.merkle_hash();  // cache hashes
+    trie_t snapshot(trie);
+
+    for (int round = 0; round < 3; ++round) {
+        // Present, missing and repeated keys (unsorted)
+        std::vector<std::string> keys;
+        for (int i = 0; i < 1500; ++i) {
+            std::string key;
+            for (size_t len = ::rand() % 8; len; --len)
+                key.push_back("abc\x11\xf1"[::rand() % 5]);
+
+            keys.push_back(key);
+        }
+
+        size_t expected = 0;
+        for (const auto & key: keys) expected += map.erase(key);
+
+        const size_t erased = trie.erase_many(keys);
+
+        if (erased != expected || trie.size() != map.size()) {
+            std::cerr << "Batch erased " << erased << " items, expected "
+                << expected << std::endl;
+            ++error_cnt;
+        }
+
+        // Content
+        auto map_iter = map.begin();
+        for (auto iter = trie.begin(); trie.end() != iter; ++iter, ++map_iter)
+        {
+            if (map.end() == map_iter ||
+                std::get<2>(*iter) !=
+                    std::make_tuple(map_iter->first, map_iter->second))
+            {
+                std::cerr << "Batch erase content mismatch" << std::endl;
+                ++error_cnt;
+                break;
+            }
+        }
+
+        for (const auto & kv: map)
+            if (trie.end() == trie.find(
+                (const unsigned char *)kv.first.data(), kv.first.size()))
+            {
+                std::cerr << "Key lost by batch erase" << std::endl;
+                ++error_cnt;
+                break;
+            }
+
+        // Single key erase
+        if (!map.empty()) {
+            const std::string key = map.begin()->first;
+            map.erase(map.begin());
+
+            if (!trie.erase((const unsigned char *)key.data(), key.size()) ||
+                trie.erase((const unsigned char *)key.data(), key.size()))
+            {
+                std::cerr << "Erase by key failed" << std::endl;
+                ++error_cnt;
+            }
+        }
+    }
+
+    // Stamps and hashes
+    size_t erased = 0, other = 0;
+    trie_t::diff(snapshot, trie,
+        [&](const item_t &) { ++other; },
+        [&](const item_t &) { ++erased; },
+        [&](const item_t &, const item_t &) { ++other; });
+
+    if (erased != snapshot.size() - map.size() || 0 != other) {
+        std::cerr << "Batch erase diff mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    trie_t fresh;
+    for (const auto & kv: map) fresh.insert(item_t(kv.first, kv.second));
+
+    if (fresh.merkle_hash() != trie.merkle_hash()) {
+        std::cerr << "Batch erase Merkle hash mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    // Erase by key never erases another item (even if slobby)
+    container::string_trie<int, container::TRIE_KEY_TRACING_SLOBBY> slobby;
+    slobby.insert(item_t("abc", 1));
+    slobby.insert(item_t("xyz", 2));
+
+    if (slobby.erase((const unsigned char *)"abd", 3) ||
+        slobby.erase((const unsigned char *)"xyzzy", 5) ||
+        2 != slobby.size())
+    {
+        std::cerr << "Erase by missing key erased an item" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Batch erase test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Z-order spatial index unit test */
+static int zorder_index_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Z-order index test BEGIN" << std::endl;
+
+    typedef container::zorder_index<int> index_t;
+
+    index_t index;
+    std::vector<std::tuple<uint32_t, uint32_t, int> > points;
+
+    // Points clustered in a small area (plus some far away)
+    ::srand(4);
+    for (int i = 0; i < 5000; ++i) {
+        uint32_t x = 0x80000000 + ::rand() % 4096;
+        uint32_t y = 0x40000000 + ::rand() % 4096;
+        if (0 == i % 100) x ^= ::rand();
+
+        if (index.insert(x, y, i)) points.emplace_back(x, y, i);
+    }
+
+    if (index.size() != points.size()) {
+        std::cerr
+            << "Size mismatch: " << index.size() << " != " << points.size()
+            << std::endl;
+        ++error_cnt;
+    }
+
+    for (size_t i = 0; i < points.size(); i += 7) {
+        const index_t::item_t * item = index.find(
+            std::get<0>(points[i]), std::get<1>(points[i]));
+
+        if (NULL == item || item->value != std::get<2>(points[i]) ||
+            item->x() != std::get<0>(points[i]) ||
+            item->y() != std::get<1>(points[i]))
+        {
+            std::cerr << "Point " << i << " lookup failed" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        const uint32_t x0 = 0x80000000 + ::rand() % 4096;
+        const uint32_t y0 = 0x40000000 + ::rand() % 4096;
+        const index_t::box bbox(
+            x0, y0, x0 + ::rand() % 2048, y0 + ::rand() % 2048);
+
+        std::vector<int> expected;
+        for (const auto & point : points)
+            if (bbox.contains(std::get<0>(point), std::get<1>(point)))
+                expected.push_back(std::get<2>(point));
+
+        std::vector<int> result;
+        uint64_t last_code = 0;
+        const size_t cnt = index.query(bbox,
+        [&](const index_t::item_t & item) {
+            uint64_t code = 0;
+            for (size_t j = 0; j < sizeof(item.key); ++j)
+                code = (code << 8) | item.key[j];
+
+            if (!result.empty() && code <= last_code) {
+                std::cerr << "Query result not in Z order" << std::endl;
+                ++error_cnt;
+            }
+
+            last_code = code;
+            result.push_back(item.value);
+        });
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(result.begin(), result.end());
+
+        if (cnt != result.size() || result != expected) {
+            std::cerr
+                << "Box query mismatch: " << result.size() << " != "
+                << expected.size() << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    // Box cover cells are disjoint and in Z order
+    const auto cells = index_t::cover(index_t::box(1, 2, 1000, 3000), 12);
+    for (size_t i = 1; i < cells.size(); ++i)
+        if (std::get<0>(cells[i]) <= std::get<0>(cells[i - 1])) {
+            std::cerr << "Cover cells not in Z order" << std::endl;
+            ++error_cnt;
+        }
+
+    // Geographical coordinates are clamped to the grid
+    if (index_t::geo_xy(-200.0, -100.0) != std::make_pair(0u, 0u) ||
+        index_t::geo_xy(200.0, 100.0) !=
+            std::make_pair((uint32_t)-1, (uint32_t)-1))
+    {
+        std::cerr << "Geo. coordinates not clamped" << std::endl;
+        ++error_cnt;
+    }
+
+    try {
+        index_t::geo_xy(std::nan(""), 0.0);
+
+        std::cerr << "NaN geo. coordinate accepted" << std::endl;
+        ++error_cnt;
+    }
+    catch (const std::logic_error &) {}
+
+    std::cerr << "Z-order index test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Bulk import test */
+static int import_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Bulk import test BEGIN" << std::endl;
+
+    typedef std::tuple<char, uint64_t, std::string> record_t;
+
+    // Generate input (text & binary keys, tabs, CR LF and empty lines)
+    std::vector<record_t> expected;
+    std::string input;
+
+    ::srand(20);
+    for (uint64_t i = 0; i < 3000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 7; len; --len)
+            key.push_back("ab# \n\r\t"[::rand() % 7]);
+
+        const char action = ::rand() % 5 ? 'A' : 'R';
+        expected.push_back(record_t(action, i, key));
+
+        input += action;
+        input += ::rand() % 2 ? " " : "\t ";
+        input += std::to_string(i) + ' ';
+
+        if (key.find_first_of("# \n\r\t") == std::string::npos)
+            input += key;
+        else
+            input += '#' + std::to_string(key.size()) + ':' + key;
+
+        input += ::rand() % 2 ? "\n" : "\r\n";
+        if (0 == ::rand() % 10) input += "\n";
+    }
+
+    // Parse (single chunk and many tiny chunks)
+    for (size_t threads = 1; threads < 10; threads += 8) {
+        std::vector<container::import_record> records;
+        container::parse_import(input.data(), input.size(), records,
+            threads, threads > 1 ? 1 : 1 << 20);
+
+        bool match = records.size() == expected.size();
+        for (size_t i = 0; match && i < records.size(); ++i)
+            match = expected[i] == record_t(records[i].action,
+                records[i].value,
+                std::string((const char *)records[i].key, records[i].len));
+
+        if (!match) {
+            std::cerr << "Import records mismatch (" << threads
+                << " threads)" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    // Apply (and compare with sequential application)
+    std::vector<container::import_record> records;
+    container::parse_import(input.data(), input.size(), records, 4, 1);
+
+    container::string_trie<uint64_t> trie;
+    container::import_apply(trie, records,
+    [](const container::import_record & rec) {
+        return std::make_tuple(
+            std::string((const char *)rec.key, rec.len), rec.value);
+    });
+
+    std::map<std::string, uint64_t> map;
+    for (const auto & rec: expected)
+        if ('A' == std::get<0>(rec))
+            map.insert(std::make_pair(std::get<2>(rec), std::get<1>(rec)));
+        else
+            map.erase(std::get<2>(rec));
+
+    bool match = trie.size() == map.size();
+    auto map_iter = map.begin();
+    for (auto iter = trie.begin(); match && trie.end() != iter;
+        ++iter, ++map_iter)
+    {
+        match = std::get<2>(*iter) ==
+            std::make_tuple(map_iter->first, map_iter->second);
+    }
+
+    if (!match) {
+        std::cerr << "Import application mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    // Syntax errors
+    const char * bad[] = {
+        "X 1 key\n", "A key\n", "A 1 key junk\n", "A 1 #5:abc\n",
+        "A 1 #x:abc\n", "A 99999999999999999999 key\n",
+    };
+
+    for (const char * line: bad) {
+        const std::string bad_input = input + line + input;
+
+        std::vector<container::import_record> records;
+        try {
+            container::parse_import(
+                bad_input.data(), bad_input.size(), records, 3, 1);
+
+            std::cerr << "Syntax error not detected: " << line;
+            ++error_cnt;
+        }
+        catch (const std::runtime_error & x) {}
+    }
+
+    std::cerr << "Bulk import test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Disk TRIE test */
+static int disk_trie_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Disk TRIE test BEGIN" << std::endl;
+
+    typedef std::tuple<std::string, uint64_t> item_t;
+
+    container::string_trie<uint64_t> trie;
+    std::map<std::string, uint64_t> map;
+
+    ::srand(21);
+    for (uint64_t i = 0; i < 5000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 24; len; --len)
+            key.push_back("ab\x11\xf1\n"[::rand() % 5]);
+
+        trie.insert(std::make_tuple(key, i));
+        map.insert(std::make_pair(key, i));
+    }
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 2000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 24; len; --len)
+            key.push_back("abc\x11\xf1\n"[::rand() % 6]);
+
+        keys.push_back(key);
+    }
+
+    char path[] = "/tmp/libtrie_disk_XXXXXX";
+    const int fd = ::mkstemp(path);
+    if (-1 == fd) {
+        std::cerr << "Failed to create temporary file" << std::endl;
+        return 1;
+    }
+
+    ::close(fd);
+
+    // Tiny pages (records crossing pages) and default pages
+    for (size_t page_size = 64; page_size <= 4096; page_size *= 64) {
+        container::disk_trie::write(path, trie,
+            [](const item_t & item) { return std::get<1>(item); },
+            page_size, 1);
+
+        // Synchronous (pread) and asynchronous lookups
+        for (size_t depth = 0; depth <= 16; depth += 16) {
+            container::disk_trie disk(path, depth);
+
+            if (disk.size() != map.size()) {
+                std::cerr << "Disk TRIE size " << disk.size()
+                    << ", expected " << map.size() << std::endl;
+                ++error_cnt;
+            }
+
+            size_t done = 0, errors = 0;
+            for (const auto & key: keys) {
+                const auto iter = map.find(key);
+                const bool expected = map.end() != iter;
+
+                uint64_t value = 0;
+                if (disk.find(key, value) != expected ||
+                    (expected && value != iter->second))
+                {
+                    ++errors;
+                }
+
+                disk.async_find(key,
+                [&done, &errors, expected, iter](bool found, uint64_t value) {
+                    ++done;
+                    if (found != expected ||
+                        (expected && value != iter->second))
+                    {
+                        ++errors;
+                    }
+                });
+            }
+
+            for (const auto & item: map)
+                disk.async_find(item.first,
+                [&done, &errors, &item](bool found, uint64_t value) {
+                    ++done;
+                    if (!found || value != item.second) ++errors;
+                });
+
+            disk.drain();
+
+            if (errors || done != keys.size() + map.size()) {
+                std::cerr << "Disk TRIE lookups failed (page size "
+                    << page_size << ", queue depth " << depth << "): "
+                    << errors << " errors, " << done << " done" << std::endl;
+                ++error_cnt;
+            }
+
+            // Throwing completions don't leave lookups stuck
+            size_t thrown = 0;
+            for (const auto & item: map)
+                disk.async_find(item.first, [](bool, uint64_t) {
+                    throw std::runtime_error("completion failed");
+                });
+
+            while (disk.in_flight()) {
+                try { disk.poll(); }
+                catch (const std::runtime_error & ) { ++thrown; }
+            }
+
+            if (0 == thrown) {
+                std::cerr << "Disk TRIE completion exception lost"
+                    << std::endl;
+                ++error_cnt;
+            }
+        }
+    }
+
+    ::unlink(path);
+
+    std::cerr << "Disk TRIE test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Value pool (interned TRIE values) unit test */
+static int value_pool_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Value pool test BEGIN" << std::endl;
+
+    typedef container::value_pool<std::string> pool_t;
+    typedef container::string_trie<pool_t::handle> trie_t;
+    typedef std::tuple<std::string, pool_t::handle> item_t;
+
+    std::unique_ptr<pool_t> pool(new pool_t());
+    trie_t trie;
+    std::map<std::string, std::string> map;
+
+    auto value = [](int n) -> std::string {
+        return "configuration blob #" + std::to_string(n);
+    };
+
+    // Many keys, few distinct values (some keys re-assigned)
+    ::srand(22);
+    for (int i = 0; i < 5000; ++i) {
+        std::string key;
+        for (size_t len = 1 + ::rand() % 8; len; --len)
+            key.push_back('a' + ::rand() % 6);
+
+        const std::string val = value(::rand() % 40);
+        trie.insert_or_merge(std::make_tuple(key, pool->intern(val)),
+            [](item_t & item, const item_t & update) {
+                std::get<1>(item) = std::get<1>(update);
+            });
+
+        map[key] = val;
+    }
+
+    std::set<std::string> distinct;
+    for (const auto & kv: map) distinct.insert(kv.second);
+
+    if (trie.size() != map.size() || pool->size() != distinct.size()) {
+        std::cerr
+            << "Unexpected sizes: " << trie.size() << " items, "
+            << pool->size() << " pooled values" << std::endl;
+        ++error_cnt;
+    }
+
+    // Values are shared: compare handles by pointer
+    for (const auto & kv: map) {
+        auto iter = trie.find(
+            (const unsigned char *)kv.first.data(), kv.first.size());
+        if (trie.end() == iter) {
+            std::cerr << "Key " << kv.first << " not found" << std::endl;
+            ++error_cnt;
+            continue;
+        }
+
+        const pool_t::handle & val = std::get<1>(std::get<2>(*iter));
+        if (val != pool->intern(kv.second) || *val != kv.second) {
+            std::cerr << "Key " << kv.first << " value mismatch" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    // Values no longer referred to are dropped
+    for (auto kv = map.begin(); kv != map.end(); ) {
+        if (kv->second == value(7) || kv->second == value(13)) {
+            trie.erase(
+                (const unsigned char *)kv->first.data(), kv->first.size());
+            kv = map.erase(kv);
+        }
+        else ++kv;
+    }
+
+    distinct.erase(value(7));
+    distinct.erase(value(13));
+    if (pool->size() != distinct.size()) {
+        std::cerr
+            << "Erased values still pooled (" << pool->size()
+            << " values)" << std::endl;
+        ++error_cnt;
+    }
+
+    // Snapshot shares the values, too
+    {
+        trie_t snapshot(trie);
+        if (pool->size() != distinct.size()) {
+            std::cerr << "Snapshot values not shared" << std::endl;
+            ++error_cnt;
+        }
+    }
+
+    // Pool may go first; values are dropped with the TRIE then
+    pool.reset();
+    for (auto & kv: map) {
+        auto iter = trie.find(
+            (const unsigned char *)kv.first.data(), kv.first.size());
+        if (*std::get<1>(std::get<2>(*iter)) != kv.second) {
+            std::cerr
+                << "Detached value of " << kv.first << " mismatch"
+                << std::endl;
+            ++error_cnt;
+            break;
+        }
+    }
+
+    std::cerr << "Value pool test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Front-coded iteration unit test */
+static int front_coded_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Front-coded iteration test BEGIN" << std::endl;
+
+    typedef container::string_trie<int> trie_t;
+
+    trie_t trie;
+    std::set<std::string> keys;
+
+    ::srand(23);
+    for (int i = 0; i < 5000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 9; len; --len)
+            key.push_back("ab\x00\xff"[::rand() % 4]);
+
+        trie.insert(std::make_tuple(key, i));
+        keys.insert(key);
+    }
+
+    // Decode front-coded keys, check the shared prefixes are maximal
+    std::string prev, key;
+    auto key_iter = keys.begin();
+    size_t cnt = 0;
+    for (auto iter = trie.front_coded_begin();
+         iter != trie.front_coded_end(); ++iter, ++key_iter, ++cnt)
+    {
+        const size_t shared = std::get<0>(*iter);
+
+        key.assign(prev, 0, shared);
+        key.append((const char *)std::get<1>(*iter), std::get<2>(*iter));
+
+        size_t lcp = 0;
+        while (lcp < prev.size() && lcp < key.size() &&
+            prev[lcp] == key[lcp]) ++lcp;
+
+        if (keys.end() == key_iter || key != *key_iter || shared != lcp) {
+            std::cerr
+                << "Front-coded key #" << cnt << " mismatch (shared "
+                << shared << ", expected " << lcp << ")" << std::endl;
+            ++error_cnt;
+            break;
+        }
+
+        prev.swap(key);
+    }
+
+    if (cnt != keys.size()) {
+        std::cerr
+            << "Front-coded iteration yielded " << cnt << " keys instead of "
+            << keys.size() << std::endl;
+        ++error_cnt;
+    }
+
+    // Iteration started at a key range shares no prefix initially
+    auto iter = trie.front_coded(trie.seek((const unsigned char *)"ab", 2));
+    if (trie.front_coded_end() == iter || 0 != std::get<0>(*iter) ||
+        std::string((const char *)std::get<1>(*iter), std::get<2>(*iter))
+            != *keys.lower_bound("ab"))
+    {
+        std::cerr << "Front-coded range iteration mismatch" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Front-coded iteration test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Scan prefetching unit test */
+static int scan_prefetch_test() {
+    int error_cnt = 0;
+
+    std::cerr << "Scan prefetching test BEGIN" << std::endl;
+
+    typedef container::string_trie<int,
+        container::TRIE_KEY_TRACING_STRICT,
+        container::TRIE_SCAN_PREFETCH> trie_t;
+
+    trie_t trie;
+    std::map<std::string, int> map;
+
+    // Short keys over small alphabet (many keys are prefixes of others)
+    ::srand(24);
+    for (int i = 0; i < 5000; ++i) {
+        std::string key;
+        for (size_t len = ::rand() % 7; len; --len)
+            key.push_back('a' + ::rand() % 3);
+
+        trie.insert(std::make_tuple(key, i));
+        map.insert(std::make_pair(key, i));
+    }
+
+    // Prefetching mustn't change the iteration
+    auto map_iter = map.begin();
+    for (auto iter = trie.begin(); iter != trie.end(); ++iter, ++map_iter) {
+        const std::string key(
+            (const char *)std::get<0>(*iter), std::get<1>(*iter));
+
+        if (map.end() == map_iter || key != map_iter->first ||
+            std::get<1>(std::get<2>(*iter)) != map_iter->second)
+        {
+            std::cerr << "Scan mismatch at key " << key << std::endl;
+            ++error_cnt;
+            break;
+        }
+    }
+
+    if (map.end() != map_iter) {
+        std::cerr << "Scan ended prematurely" << std::endl;
+        ++error_cnt;
+    }
+
+    std::cerr << "Scan prefetching test END" << std::endl;
+
+    return error_cnt;
+}
+
+
+/** Unit test */
+static int main_impl(int argc, char * const argv[]) {
+    int exit_code = 64;  // pessimistic assumption
+
+    do {  // pragmatic do ... while (0) loop allowing for breaks
+        exit_code = trie_test();
+        if (0 != exit_code) break;
+
+        exit_code = string_trie_test();
+        if (0 != exit_code) break;
+
+        exit_code = ordered_search_test();
+        if (0 != exit_code) break;
+
+        exit_code = lower_bound_insert_test();
+        if (0 != exit_code) break;
+
+        exit_code = slob_threshold_test();
+        if (0 != exit_code) break;
+
+        exit_code = fingerprints_test();
+        if (0 != exit_code) break;
+
+        exit_code = string_dictionary_test();
+        if (0 != exit_code) break;
+
+        exit_code = zorder_index_test();
+        if (0 != exit_code) break;
+
+        exit_code = trie_sort_test();
+        if (0 != exit_code) break;
+
+        exit_code = suffix_index_test();
+        if (0 != exit_code) break;
+
+        exit_code = xor_test();
+        if (0 != exit_code) break;
+
+        exit_code = int_set_test();
+        if (0 != exit_code) break;
+
+        exit_code = heavy_hitters_test();
+        if (0 != exit_code) break;
+
+        exit_code = export_test();
+        if (0 != exit_code) break;
+
+        exit_code = diff_test<0>();
+        if (0 != exit_code) break;
+
+        exit_code = diff_test<container::TRIE_VERSION_STAMPS>();
+        if (0 != exit_code) break;
+
+        exit_code = merkle_test<0>();
+        if (0 != exit_code) break;
+
+        exit_code = merkle_test<container::TRIE_MERKLE_HASHES>();
+        if (0 != exit_code) break;
+
+        exit_code = counting_trie_test();
+        if (0 != exit_code) break;
+
+        exit_code = insert_or_merge_test();
+        if (0 != exit_code) break;
+
+        exit_code = erase_interim_key_test();
+        if (0 != exit_code) break;
+
+        exit_code = huge_pages_test();
+        if (0 != exit_code) break;
+
+        exit_code = relayout_test();
+        if (0 != exit_code) break;
+
+        exit_code = find_sorted_test();
+        if (0 != exit_code) break;
+
+        exit_code = erase_many_test();
+        if (0 != exit_code) break;
+
+        exit_code = import_test();
+        if (0 != exit_code) break;
+
+        exit_code = disk_trie_test();
+        if (0 != exit_code) break;
+
+        exit_code = value_pool_test();
+        if (0 != exit_code) break;
+
+        exit_code = front_coded_test();
+        if (0 != exit_code) break;
+
+        exit_code = scan_prefetch_test();
         if (0 != exit_code) break;
 
     } while (0);  // end of pragmatic loop